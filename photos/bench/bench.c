@@ -0,0 +1,860 @@
+// Замеры производительности ImageCraft
+// Использование: image_craft_bench [группа...]   (без аргументов - все группы)
+//                image_craft_bench suite [параметры]   (см. suite.c)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../src/image.h"
+#include "../src/filters.h"
+#include "../src/bmp.h"
+#include "../src/buffer_pool.h"
+#include "../src/simd.h"
+#include "../src/fft.h"
+#include "../src/resample.h"
+#include "../src/log.h"
+#include "bench.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+double bench_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+Image* bench_image(int width, int height, unsigned seed) {
+    Image* image = image_create(width, height);
+    if (!image) {
+        return NULL;
+    }
+
+    unsigned state = seed * 2654435761u + 1;
+    for (int i = 0; i < width * height; i++) {
+        state = state * 1664525u + 1013904223u;
+        int x = i % width;
+        int y = i / width;
+        image->data[i] = color_create(((x + (state >> 27)) & 255) / 255.0f,
+                                      ((y * 3 + (state >> 26)) & 255) / 255.0f,
+                                      (((x ^ y) + (state >> 28)) & 255) / 255.0f);
+    }
+    return image;
+}
+
+// Время одного применения фильтра к копии изображения (лучшее из repeats)
+static double bench_time(const Image* source, void (*apply)(Image*, int), int arg, int repeats) {
+    double best = -1.0;
+
+    for (int r = 0; r < repeats; r++) {
+        Image* work = image_copy(source);
+        if (!work) {
+            return -1.0;
+        }
+
+        double start = bench_now();
+        apply(work, arg);
+        double elapsed = bench_now() - start;
+        image_destroy(work);
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Медиана: сети сортировки против скользящих гистограмм по размеру окна.
+// Точка пересечения определяет MEDIAN_NETWORK_MAX_WINDOW.
+static void bench_median(void) {
+    const int width = 1024;
+    const int height = 768;
+    const int windows[] = {3, 5, 7, 9, 11, 15, 21, 31};
+    const double pixels = (double)width * height;
+
+    Image* source = bench_image(width, height, 1);
+    if (!source) {
+        return;
+    }
+
+    printf("median (%dx%d), ns/pixel\n", width, height);
+    printf("  %-8s %12s %12s\n", "window", "network", "histogram");
+
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        int window = windows[i];
+        double network = window <= 9 ? bench_time(source, apply_median_network, window, 3) : -1.0;
+        double histogram = bench_time(source, apply_median_histogram, window, 3);
+
+        printf("  %-8d ", window);
+        if (network >= 0) printf("%12.1f ", network * 1e9 / pixels);
+        else printf("%12s ", "-");
+        printf("%12.1f\n", histogram * 1e9 / pixels);
+    }
+    printf("  auto: network up to window %d\n\n", MEDIAN_NETWORK_MAX_WINDOW);
+
+    image_destroy(source);
+}
+
+// Лучшее время прохода src -> dst из repeats
+static double bench_pass(const Image* source, Image* dst, float sigma, int repeats,
+                         bool (*pass)(const Image*, Image*, int, int, float)) {
+    double best = -1.0;
+
+    for (int r = 0; r < repeats; r++) {
+        double start = bench_now();
+        pass(source, dst, 0, source->height, sigma);
+        double elapsed = bench_now() - start;
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Гауссово размытие: точное ядро против трех расширенных боксов по σ, и
+// расхождение результатов в уровнях 8-битного BMP. Определяет GAUSSIAN_BOX_MIN_SIGMA.
+static void bench_blur(void) {
+    const int width = 1024;
+    const int height = 768;
+    const float sigmas[] = {1.0f, 1.5f, 2.0f, 3.0f, 4.0f, 6.0f, 10.0f, 20.0f, 40.0f};
+    const double pixels = (double)width * height;
+
+    Image* source = bench_image(width, height, 4);
+    Image* exact = image_create_scratch(width, height);
+    Image* box = image_create_scratch(width, height);
+    if (!source || !exact || !box) {
+        image_destroy(source);
+        image_destroy(exact);
+        image_destroy(box);
+        return;
+    }
+
+    printf("gaussian blur (%dx%d), ns/pixel; error of box vs exact in 8-bit levels\n", width, height);
+    printf("  %-8s %10s %10s %10s %10s\n", "sigma", "exact", "box", "max err", "mean err");
+
+    for (size_t i = 0; i < sizeof(sigmas) / sizeof(sigmas[0]); i++) {
+        float sigma = sigmas[i];
+        double exact_time = bench_pass(source, exact, sigma, 3, gaussian_blur_rows);
+        double box_time = bench_pass(source, box, sigma, 3, gaussian_box_rows);
+
+        int max_error = 0;
+        double total_error = 0.0;
+        const float* a = (const float*)exact->data;
+        const float* b = (const float*)box->data;
+        for (size_t k = 0; k < (size_t)width * height * 3; k++) {
+            int error = abs((int)(uint8_t)(a[k] * 255) - (int)(uint8_t)(b[k] * 255));
+            if (error > max_error) max_error = error;
+            total_error += error;
+        }
+
+        printf("  %-8.1f %10.1f %10.1f %10d %10.3f\n", sigma,
+               exact_time * 1e9 / pixels, box_time * 1e9 / pixels,
+               max_error, total_error / (pixels * 3));
+    }
+    printf("  auto: box from sigma %.1f\n\n", GAUSSIAN_BOX_MIN_SIGMA);
+
+    image_destroy(box);
+    image_destroy(exact);
+    image_destroy(source);
+}
+
+// Бокс со скользящими суммами: время на пиксель не должно расти с радиусом
+static void bench_box(void) {
+    const int width = 1024;
+    const int height = 768;
+    const int radii[] = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+    const double pixels = (double)width * height;
+
+    Image* source = bench_image(width, height, 5);
+    Image* dst = image_create_scratch(width, height);
+    if (!source || !dst) {
+        image_destroy(source);
+        image_destroy(dst);
+        return;
+    }
+
+    printf("box blur (%dx%d), ns/pixel\n", width, height);
+    printf("  %-8s %10s\n", "radius", "box");
+
+    for (size_t i = 0; i < sizeof(radii) / sizeof(radii[0]); i++) {
+        double best = -1.0;
+        for (int r = 0; r < 3; r++) {
+            double start = bench_now();
+            box_blur_rows(source, dst, 0, height, radii[i]);
+            double elapsed = bench_now() - start;
+            if (best < 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        printf("  %-8d %10.1f\n", radii[i], best * 1e9 / pixels);
+    }
+    printf("\n");
+
+    image_destroy(dst);
+    image_destroy(source);
+}
+
+// Прежний вертикальный проход: каждая строка окна добавляется ко всей строке
+// приемника, и при большой ширине приемник вытесняется из кэша между строками
+static void legacy_convolve_rows(const float* const* rows, const float* weights, int taps,
+                                 float* out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = 0.0f;
+    }
+    for (int k = 0; k < taps; k++) {
+        for (int i = 0; i < count; i++) {
+            out[i] += rows[k][i] * weights[k];
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        out[i] = out[i] < 0.0f ? 0.0f : (out[i] > 1.0f ? 1.0f : out[i]);
+    }
+}
+
+// Лучшее время вертикального прохода по всему изображению (окно taps строк с
+// повтором краев) из трех: построчно прежним способом или блоками по 32 строки
+static double bench_vertical_pass(const Image* source, Image* dst, const float* weights, int taps,
+                                  bool blocked) {
+    enum { BLOCK = 32 };
+    const float* window[BLOCK + 64];
+    float* out[BLOCK];
+    double best = -1.0;
+
+    for (int r = 0; r < 3; r++) {
+        double start = bench_now();
+        for (int yb = 0; yb < source->height; yb += BLOCK) {
+            int rows = source->height - yb < BLOCK ? source->height - yb : BLOCK;
+            for (int k = 0; k < rows + taps - 1; k++) {
+                int ny = yb + k - taps / 2;
+                if (ny < 0) ny = 0;
+                if (ny >= source->height) ny = source->height - 1;
+                window[k] = (const float*)(source->data + (size_t)ny * source->width);
+            }
+            for (int y = 0; y < rows; y++) {
+                out[y] = (float*)(dst->data + (size_t)(yb + y) * dst->width);
+            }
+
+            if (blocked) {
+                convolve_vertical(window, weights, taps, out, rows, source->width * 3);
+            } else {
+                for (int y = 0; y < rows; y++) {
+                    legacy_convolve_rows(window + y, weights, taps, out[y], source->width * 3);
+                }
+            }
+        }
+        double elapsed = bench_now() - start;
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Вертикальная свертка (13 строк, как у Гаусса с σ = 2) при одинаковом числе
+// пикселей и растущей ширине: полосы столбцов держат цену на пиксель ровной
+static void bench_vertical(void) {
+    const int widths[] = {512, 1024, 2048, 4096, 8192, 16384};
+    const int pixels = 1 << 22;
+    const int taps = 13;
+    float weights[13];
+
+    float sum = 0.0f;
+    for (int k = 0; k < taps; k++) {
+        weights[k] = expf(-(float)((k - 6) * (k - 6)) / 8.0f);
+        sum += weights[k];
+    }
+    for (int k = 0; k < taps; k++) {
+        weights[k] /= sum;
+    }
+
+    printf("vertical convolution (%d taps, %d pixels, %s), ns/pixel\n",
+           taps, pixels, simd_level_name(simd_kernels()->level));
+    printf("  %-8s %10s %10s\n", "width", "legacy", "blocked");
+
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        int width = widths[i];
+        int height = pixels / width;
+        Image* source = bench_image(width, height, 6);
+        Image* dst = image_create_scratch(width, height);
+        if (!source || !dst) {
+            image_destroy(source);
+            image_destroy(dst);
+            return;
+        }
+
+        double legacy_time = bench_vertical_pass(source, dst, weights, taps, false);
+        double blocked_time = bench_vertical_pass(source, dst, weights, taps, true);
+        printf("  %-8d %10.2f %10.2f\n", width, legacy_time * 1e9 / pixels, blocked_time * 1e9 / pixels);
+
+        image_destroy(dst);
+        image_destroy(source);
+    }
+    printf("\n");
+}
+
+// Прежний матричный фильтр: полное ядро с проверкой границ на каждое слагаемое
+static void legacy_matrix_filter(const Image* src, Image* dst, float kernel[3][3]) {
+    for (int y = 0; y < src->height; y++) {
+        for (int x = 0; x < src->width; x++) {
+            Color sum = color_create(0, 0, 0);
+            for (int ky = -1; ky <= 1; ky++) {
+                for (int kx = -1; kx <= 1; kx++) {
+                    int nx = x + kx;
+                    int ny = y + ky;
+                    if (nx < 0) nx = 0;
+                    if (nx >= src->width) nx = src->width - 1;
+                    if (ny < 0) ny = 0;
+                    if (ny >= src->height) ny = src->height - 1;
+                    sum = color_add(sum, color_mul(image_get_pixel(src, nx, ny), kernel[ky + 1][kx + 1]));
+                }
+            }
+            dst->data[(size_t)y * dst->width + x] = color_clamp(sum);
+        }
+    }
+}
+
+// Свертка 3x3: прежний фильтр, общий путь по ненулевым весам и ядра,
+// специализированные при компиляции. Результаты должны совпадать побитово.
+static void bench_conv3x3(void) {
+    const int width = 2048;
+    const int height = 1536;
+    const double pixels = (double)width * height;
+    const char* names[] = {"sharpen", "laplacian", "emboss"};
+    float kernels[3][3][3] = {
+        { { 0, -1,  0}, {-1,  5, -1}, { 0, -1,  0} },
+        { { 0, -1,  0}, {-1,  4, -1}, { 0, -1,  0} },
+        { {-2, -1,  0}, {-1,  1,  1}, { 0,  1,  2} },
+    };
+
+    Image* source = bench_image(width, height, 7);
+    Image* outputs[3] = {
+        image_create_scratch(width, height),
+        image_create_scratch(width, height),
+        image_create_scratch(width, height)
+    };
+    if (!source || !outputs[0] || !outputs[1] || !outputs[2]) {
+        image_destroy(source);
+        for (int i = 0; i < 3; i++) image_destroy(outputs[i]);
+        return;
+    }
+
+    printf("3x3 convolution (%dx%d), ns/pixel\n", width, height);
+    printf("  %-10s %10s %10s %10s %10s %8s\n", "kernel", "legacy", "generic", "special", "speedup", "equal");
+
+    size_t bytes = sizeof(Color) * (size_t)width * height;
+    for (int k = 0; k < 3; k++) {
+        double times[3] = {-1.0, -1.0, -1.0};
+        for (int r = 0; r < 3; r++) {
+            for (int v = 0; v < 3; v++) {
+                double start = bench_now();
+                if (v == 0) legacy_matrix_filter(source, outputs[0], kernels[k]);
+                else if (v == 1) matrix_filter_rows(source, outputs[1], 0, height, kernels[k], 1.0f);
+                else kernel3x3_rows(source, outputs[2], 0, height, (Kernel3x3)k);
+                double elapsed = bench_now() - start;
+                if (times[v] < 0 || elapsed < times[v]) times[v] = elapsed;
+            }
+        }
+
+        bool equal = memcmp(outputs[0]->data, outputs[1]->data, bytes) == 0 &&
+                     memcmp(outputs[0]->data, outputs[2]->data, bytes) == 0;
+        printf("  %-10s %10.2f %10.2f %10.2f %9.1fx %8s\n", names[k],
+               times[0] * 1e9 / pixels, times[1] * 1e9 / pixels, times[2] * 1e9 / pixels,
+               times[2] > 0 ? times[0] / times[2] : 0.0, equal ? "yes" : "NO");
+    }
+    printf("\n");
+
+    for (int i = 0; i < 3; i++) image_destroy(outputs[i]);
+    image_destroy(source);
+}
+
+// Свертка -conv по размеру ядра: ядро ранга 1 (биномиальное) раскладывается на
+// два одномерных прохода, ядро с возмущенным центром считается напрямую
+static void bench_conv(void) {
+    const int width = 1024;
+    const int height = 768;
+    const int sizes[] = {3, 5, 7, 9, 15, 25};
+    const double pixels = (double)width * height;
+
+    Image* source = bench_image(width, height, 8);
+    Image* dst = image_create_scratch(width, height);
+    ConvParams* kernel = (ConvParams*)malloc(sizeof(ConvParams) + sizeof(float) * 25 * 25);
+    if (!source || !dst || !kernel) {
+        image_destroy(source);
+        image_destroy(dst);
+        free(kernel);
+        return;
+    }
+
+    printf("convolution (%dx%d), ns/pixel\n", width, height);
+    printf("  %-8s %12s %12s\n", "size", "separable", "direct");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int size = sizes[i];
+        float binomial[25];
+        binomial[0] = 1.0f;
+        for (int k = 1; k < size; k++) {
+            binomial[k] = binomial[k - 1] * (size - k) / k;
+        }
+
+        kernel->width = size;
+        kernel->height = size;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                kernel->weights[y * size + x] = binomial[y] * binomial[x];
+            }
+        }
+
+        double times[2] = {-1.0, -1.0};
+        for (int v = 0; v < 2; v++) {
+            if (v == 1) {
+                kernel->weights[size * size / 2] *= 1.5f;
+            }
+            for (int r = 0; r < 3; r++) {
+                double start = bench_now();
+                convolution_rows_method(source, dst, 0, height, kernel,
+                                        v == 0 ? CONV_METHOD_SEPARABLE : CONV_METHOD_DIRECT);
+                double elapsed = bench_now() - start;
+                if (times[v] < 0 || elapsed < times[v]) times[v] = elapsed;
+            }
+        }
+
+        printf("  %-8d %12.1f %12.1f\n", size, times[0] * 1e9 / pixels, times[1] * 1e9 / pixels);
+    }
+    printf("\n");
+
+    free(kernel);
+    image_destroy(dst);
+    image_destroy(source);
+}
+
+// Большие нераскладываемые ядра: прямая свертка против БПФ по плиткам.
+// Калибрует CONV_DIRECT_TAP_NS и FFT_BUTTERFLY_NS; "auto" - выбор convolution_rows.
+static void bench_fft(void) {
+    const int width = 1024;
+    const int height = 768;
+    const int sizes[] = {7, 9, 11, 15, 21, 31, 45, 63};
+    const double pixels = (double)width * height;
+
+    Image* source = bench_image(width, height, 9);
+    Image* dst = image_create_scratch(width, height);
+    ConvParams* kernel = (ConvParams*)malloc(sizeof(ConvParams) + sizeof(float) * CONV_MAX_SIZE * CONV_MAX_SIZE);
+    if (!source || !dst || !kernel) {
+        image_destroy(source);
+        image_destroy(dst);
+        free(kernel);
+        return;
+    }
+
+    static const char* method_names[] = { "direct", "separable", "fft" };
+    printf("large kernels (%dx%d), ns/pixel\n", width, height);
+    printf("  %-8s %12s %12s %12s %12s %10s\n", "size", "direct", "fft", "fft cold", "est. fft", "auto");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int size = sizes[i];
+        unsigned state = (unsigned)size * 2654435761u;
+        kernel->width = size;
+        kernel->height = size;
+        for (int k = 0; k < size * size; k++) {
+            state = state * 1664525u + 1013904223u;
+            kernel->weights[k] = (float)(state >> 8) / (float)(1u << 24) + 0.1f;
+        }
+
+        double times[3] = {-1.0, -1.0, -1.0};
+        for (int v = 0; v < 3; v++) {
+            for (int r = 0; r < 3; r++) {
+                // "fft cold" включает расчет спектра ядра
+                if (v == 2) {
+                    fft_cache_clear();
+                }
+                double start = bench_now();
+                convolution_rows_method(source, dst, 0, height, kernel,
+                                        v == 0 ? CONV_METHOD_DIRECT : CONV_METHOD_FFT);
+                double elapsed = bench_now() - start;
+                if (times[v] < 0 || elapsed < times[v]) times[v] = elapsed;
+            }
+        }
+
+        float row[CONV_MAX_SIZE];
+        float column[CONV_MAX_SIZE];
+        ConvolutionMethod method = convolution_method(kernel, width, height, row, column);
+        printf("  %-8d %12.1f %12.1f %12.1f %12.1f %10s\n", size, times[0] * 1e9 / pixels,
+               times[1] * 1e9 / pixels, times[2] * 1e9 / pixels,
+               fft_convolution_cost(size, size, width, height), method_names[method]);
+    }
+    printf("\n");
+
+    fft_cache_clear();
+    free(kernel);
+    image_destroy(dst);
+    image_destroy(source);
+}
+
+// Прежняя реализация bmp_read: fread на каждый пиксель и fseek на каждую строку
+static Image* legacy_bmp_read(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    BMPFileHeader file_header;
+    BMPInfoHeader info_header;
+    if (fread(&file_header, sizeof(BMPFileHeader), 1, file) != 1 ||
+        fread(&info_header, sizeof(BMPInfoHeader), 1, file) != 1 ||
+        fseek(file, file_header.data_offset, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    int width = info_header.width;
+    int height = abs(info_header.height);
+    int is_top_down = info_header.height < 0;
+    int row_padding = (4 - (width * 3) % 4) % 4;
+
+    Image* image = image_create(width, height);
+    if (!image) {
+        fclose(file);
+        return NULL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        int target_y = is_top_down ? y : (height - 1 - y);
+
+        for (int x = 0; x < width; x++) {
+            uint8_t pixel[3];
+            if (fread(pixel, 3, 1, file) != 1) {
+                image_destroy(image);
+                fclose(file);
+                return NULL;
+            }
+            image_set_pixel(image, x, target_y,
+                            color_create(pixel[2] / 255.0f, pixel[1] / 255.0f, pixel[0] / 255.0f));
+        }
+
+        if (row_padding > 0 && fseek(file, row_padding, SEEK_CUR) != 0) {
+            image_destroy(image);
+            fclose(file);
+            return NULL;
+        }
+    }
+
+    fclose(file);
+    return image;
+}
+
+// Прежняя реализация bmp_write: fwrite на каждый пиксель
+static bool legacy_bmp_write(const char* filename, const Image* image) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        return false;
+    }
+
+    int row_padding = (4 - (image->width * 3) % 4) % 4;
+    int image_size = (image->width * 3 + row_padding) * image->height;
+
+    BMPFileHeader file_header = { 0x4D42, (uint32_t)(54 + image_size), 0, 54 };
+    BMPInfoHeader info_header = { 40, image->width, image->height, 1, 24, 0,
+                                  (uint32_t)image_size, 2835, 2835, 0, 0 };
+    bool ok = fwrite(&file_header, sizeof(BMPFileHeader), 1, file) == 1 &&
+              fwrite(&info_header, sizeof(BMPInfoHeader), 1, file) == 1;
+
+    uint8_t padding[4] = {0, 0, 0, 0};
+    for (int y = image->height - 1; y >= 0 && ok; y--) {
+        for (int x = 0; x < image->width && ok; x++) {
+            Color color = image_get_pixel(image, x, y);
+            uint8_t pixel[3] = {
+                (uint8_t)(color.b * 255),
+                (uint8_t)(color.g * 255),
+                (uint8_t)(color.r * 255)
+            };
+            ok = fwrite(pixel, 3, 1, file) == 1;
+        }
+        if (ok && row_padding > 0) {
+            ok = fwrite(padding, row_padding, 1, file) == 1;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+// Лучшее время чтения файла из 5 попыток (файл уже в кэше страниц)
+static double bench_read(const char* filename, Image* (*reader)(const char*)) {
+    double best = -1.0;
+
+    for (int r = 0; r < 5; r++) {
+        double start = bench_now();
+        Image* image = reader(filename);
+        double elapsed = bench_now() - start;
+
+        if (!image) {
+            return -1.0;
+        }
+        image_destroy(image);
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Текущая запись в той же разрядности, что и прежняя реализация
+static bool bmp_write_24(const char* filename, const Image* image) {
+    return bmp_write(filename, image, 24);
+}
+
+static double bench_write(const char* filename, const Image* image,
+                          bool (*writer)(const char*, const Image*)) {
+    double best = -1.0;
+
+    for (int r = 0; r < 5; r++) {
+        double start = bench_now();
+        bool ok = writer(filename, image);
+        double elapsed = bench_now() - start;
+
+        if (!ok) {
+            return -1.0;
+        }
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Лучшее время resample_image_gap из repeats (результат последнего - в *out)
+static double bench_resample(const Image* source, int width, int height, ResampleMethod method,
+                             double box_gap, int repeats, Image** out) {
+    double best = -1.0;
+
+    for (int r = 0; r < repeats; r++) {
+        image_destroy(*out);
+        double start = bench_now();
+        *out = resample_image_gap(source, width, height, method, box_gap);
+        double elapsed = bench_now() - start;
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Изменение размера: время с усреднением блоками (RESAMPLE_BOX_GAP) и без
+// него, расхождение результатов в уровнях 8-битного BMP
+static void bench_resize(void) {
+    const struct { int width, height, target_width, target_height; } cases[] = {
+        { 8192, 6144, 256, 192 },      // миниатюра из 50 Мп
+        { 1920, 1080, 960, 540 },
+        { 1920, 1080, 3840, 2160 },
+    };
+    const ResampleMethod methods[] = { RESAMPLE_BILINEAR, RESAMPLE_BICUBIC, RESAMPLE_LANCZOS3 };
+
+    printf("resize, ms; error of box prefilter vs exact in 8-bit levels\n");
+    printf("  %-22s %-9s %10s %10s %10s %10s\n", "size", "method", "box", "exact", "max err", "mean err");
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        Image* source = bench_image(cases[c].width, cases[c].height, 9);
+        if (!source) {
+            continue;
+        }
+
+        int width = cases[c].target_width;
+        int height = cases[c].target_height;
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d->%dx%d", source->width, source->height, width, height);
+
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+            Image* box = NULL;
+            Image* exact = NULL;
+            double box_time = bench_resample(source, width, height, methods[m], RESAMPLE_BOX_GAP, 3, &box);
+            double exact_time = bench_resample(source, width, height, methods[m], 0.0, 2, &exact);
+            if (!box || !exact) {
+                image_destroy(box);
+                image_destroy(exact);
+                continue;
+            }
+
+            int max_error = 0;
+            double total_error = 0.0;
+            const float* a = (const float*)exact->data;
+            const float* b = (const float*)box->data;
+            size_t count = (size_t)width * height * 3;
+            for (size_t k = 0; k < count; k++) {
+                int error = abs((int)(uint8_t)(a[k] * 255) - (int)(uint8_t)(b[k] * 255));
+                if (error > max_error) max_error = error;
+                total_error += error;
+            }
+
+            printf("  %-22s %-9s %10.1f %10.1f %10d %10.3f\n", size, resample_method_name(methods[m]),
+                   box_time * 1e3, exact_time * 1e3, max_error, total_error / count);
+            image_destroy(box);
+            image_destroy(exact);
+        }
+        image_destroy(source);
+    }
+    printf("  auto: box prefilter above %.1fx downscale\n\n", RESAMPLE_BOX_GAP);
+}
+
+// BMP: построчный кодек против прежнего попиксельного, МБ/с по размеру файла
+static void bench_bmp(void) {
+    const char* filename = "image_craft_bench.bmp";
+    const int widths[] = {1023, 4096};
+    const int height = 2048;
+
+    printf("bmp codec, MB/s of file data\n");
+    printf("  %-12s %10s %10s %10s %10s\n", "size", "read", "legacy", "write", "legacy");
+
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        Image* source = bench_image(widths[i], height, 2);
+        if (!source || !bmp_write(filename, source, 24)) {
+            image_destroy(source);
+            break;
+        }
+
+        double megabytes = (54.0 + (((size_t)widths[i] * 3 + 3) & ~(size_t)3) * height) / 1e6;
+        double read = bench_read(filename, bmp_read);
+        double legacy_read = bench_read(filename, legacy_bmp_read);
+        double write = bench_write(filename, source, bmp_write_24);
+        double legacy_write = bench_write(filename, source, legacy_bmp_write);
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", widths[i], height);
+        printf("  %-12s %10.0f %10.0f %10.0f %10.0f\n", size,
+               megabytes / read, megabytes / legacy_read,
+               megabytes / write, megabytes / legacy_write);
+
+        image_destroy(source);
+    }
+    printf("\n");
+
+    remove(filename);
+}
+
+// Цепочка фильтров с временными копиями, как в пакетной обработке
+static double bench_pool_chain(const Image* source, int images) {
+    double start = bench_now();
+    for (int i = 0; i < images; i++) {
+        Image* work = image_copy(source);
+        if (!work) {
+            return -1.0;
+        }
+
+        float sharpen[3][3] = { {0, -1, 0}, {-1, 5, -1}, {0, -1, 0} };
+        apply_median_network(work, 3);
+        apply_matrix_filter(work, sharpen, 1.0f);
+        image_destroy(work);
+    }
+    return bench_now() - start;
+}
+
+// Пул буферов: повторное использование против malloc/free на каждый буфер
+static void bench_pool(void) {
+    const int sizes[][2] = { {640, 480}, {1920, 1080}, {4096, 2160} };
+    const int images = 8;
+
+    printf("buffer pool, ms per image (median 3x3, sharpen)\n");
+    printf("  %-12s %10s %10s %10s\n", "size", "pooled", "malloc", "reused");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        Image* source = bench_image(sizes[i][0], sizes[i][1], 3);
+        if (!source) {
+            break;
+        }
+
+        buffer_pool_set_limit(0);
+        double plain = bench_pool_chain(source, images);
+
+        buffer_pool_set_limit((size_t)1 << 30);
+        buffer_pool_reset_stats();
+        double pooled = bench_pool_chain(source, images);
+
+        BufferPoolStats stats;
+        buffer_pool_get_stats(&stats);
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", sizes[i][0], sizes[i][1]);
+        printf("  %-12s %10.1f %10.1f %9.0f%%\n", size,
+               pooled * 1e3 / images, plain * 1e3 / images,
+               stats.requests ? 100.0 * stats.hits / stats.requests : 0.0);
+
+        image_destroy(source);
+        buffer_pool_trim();
+    }
+    printf("\n");
+}
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} BenchGroup;
+
+static const BenchGroup bench_groups[] = {
+    { "median", bench_median },
+    { "blur", bench_blur },
+    { "box", bench_box },
+    { "vertical", bench_vertical },
+    { "conv3x3", bench_conv3x3 },
+    { "conv", bench_conv },
+    { "fft", bench_fft },
+    { "resize", bench_resize },
+    { "bmp", bench_bmp },
+    { "pool", bench_pool },
+};
+
+int main(int argc, char** argv) {
+    // Сообщения фильтров о ходе обработки не должны попадать в замеры
+    log_set_level(LOG_LEVEL_WARNING);
+
+    if (argc >= 2 && strcmp(argv[1], "suite") == 0) {
+        return bench_suite(argc - 2, argv + 2);
+    }
+
+    size_t group_count = sizeof(bench_groups) / sizeof(bench_groups[0]);
+
+    // Неизвестная группа - ошибка, а не пустой прогон
+    for (int i = 1; i < argc; i++) {
+        size_t g = 0;
+        while (g < group_count && strcmp(argv[i], bench_groups[g].name) != 0) {
+            g++;
+        }
+
+        if (g == group_count) {
+            fprintf(stderr, "Error: Unknown benchmark group '%s'\n", argv[i]);
+            fprintf(stderr, "Groups: suite");
+            for (g = 0; g < group_count; g++) {
+                fprintf(stderr, ", %s", bench_groups[g].name);
+            }
+            fprintf(stderr, "\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (size_t g = 0; g < group_count; g++) {
+        int selected = argc < 2;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], bench_groups[g].name) == 0) {
+                selected = 1;
+            }
+        }
+
+        if (selected) {
+            bench_groups[g].run();
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,16 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "../src/image.h"
+
+// Монотонное время в секундах
+double bench_now(void);
+
+// Синтетическое изображение со значениями, квантованными как у 24-битного BMP
+Image* bench_image(int width, int height, unsigned seed);
+
+// Набор замеров всех фильтров, кодека BMP, image_resize и типичных цепочек
+// на изображениях разного размера (аргументы - после слова suite)
+int bench_suite(int argc, char** argv);
+
+#endif // BENCH_H
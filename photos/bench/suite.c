@@ -0,0 +1,407 @@
+// Набор замеров для сравнения производительности между версиями:
+// каждый фильтр, кодек BMP, image_resize и типичные цепочки фильтров на
+// синтетических изображениях от 0.3 до 50 Мп.
+//
+// Использование: image_craft_bench suite [--max-mp N] [--min-time S]
+//                    [--filter ТЕКСТ] [--json ФАЙЛ] [--compare ФАЙЛ]
+//
+// Фильтры выполняются pipeline_apply_serial в одном потоке, поэтому время на
+// пиксель сравнимо между машинами с разным числом ядер. МБ/с - мегабайты
+// 24-битного изображения (3 байта на пиксель) в секунду; для кодека - байты файла.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/image.h"
+#include "../src/bmp.h"
+#include "../src/cli.h"
+#include "../src/pipeline.h"
+#include "../src/simd.h"
+#include "bench.h"
+
+// Наибольшее число слов в описании цепочки
+#define SUITE_MAX_ARGS 32
+
+// Наибольшее число повторов одного замера
+#define SUITE_MAX_RUNS 5
+
+typedef enum {
+    SUITE_FILTERS,     // цепочка фильтров в синтаксисе командной строки
+    SUITE_RESIZE,      // image_resize, spec - масштаб в процентах
+    SUITE_BMP_READ,
+    SUITE_BMP_WRITE
+} SuiteKind;
+
+typedef struct {
+    const char* group;
+    const char* name;
+    SuiteKind kind;
+    const char* spec;
+} SuiteCase;
+
+typedef struct {
+    int width;
+    int height;
+} SuiteSize;
+
+static const SuiteSize suite_sizes[] = {
+    { 640, 480 },      // 0.3 Мп
+    { 1920, 1080 },    // 2 Мп
+    { 3840, 2160 },    // 8 Мп
+    { 8192, 6144 },    // 50 Мп
+};
+
+// Ядро-диск радиуса 10: нераскладываемое, считается через БПФ
+static char suite_disk_kernel[2048];
+
+static const char* suite_disk_spec(void) {
+    if (suite_disk_kernel[0]) {
+        return suite_disk_kernel;
+    }
+
+    const int radius = 10;
+    size_t length = (size_t)snprintf(suite_disk_kernel, sizeof(suite_disk_kernel), "-conv ");
+    for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+            length += (size_t)snprintf(suite_disk_kernel + length, sizeof(suite_disk_kernel) - length,
+                                       "%s%d", x == -radius ? (y == -radius ? "" : ";") : ",",
+                                       x * x + y * y <= radius * radius + radius);
+        }
+    }
+    return suite_disk_kernel;
+}
+
+static const SuiteCase suite_cases[] = {
+    { "filter", "grayscale", SUITE_FILTERS, "-gs" },
+    { "filter", "negative", SUITE_FILTERS, "-neg" },
+    { "filter", "sepia", SUITE_FILTERS, "-sepia" },
+    { "filter", "vignette", SUITE_FILTERS, "-vignette 0.7" },
+    { "filter", "crop", SUITE_FILTERS, "-crop 320 240" },
+    { "filter", "sharpening", SUITE_FILTERS, "-sharp" },
+    { "filter", "emboss", SUITE_FILTERS, "-emboss" },
+    { "filter", "edge", SUITE_FILTERS, "-edge 0.1" },
+    { "filter", "median 3", SUITE_FILTERS, "-med 3" },
+    { "filter", "median 7", SUITE_FILTERS, "-med 7" },
+    { "filter", "gaussian 1.5", SUITE_FILTERS, "-blur 1.5" },
+    { "filter", "gaussian 25", SUITE_FILTERS, "-blur 25" },
+    { "filter", "box 7", SUITE_FILTERS, "-box 7" },
+    { "filter", "conv 5x5", SUITE_FILTERS, "-conv 1,4,6,4,1;4,16,24,16,4;6,24,36,24,6;4,16,24,16,4;1,4,6,4,1" },
+    { "filter", "conv disk 21x21", SUITE_FILTERS, NULL },
+    { "resize", "resize 50%", SUITE_RESIZE, "50" },
+    { "resize", "resize 125%", SUITE_RESIZE, "125" },
+    { "resize", "thumbnail bilinear", SUITE_FILTERS, "-resize 256 192 bilinear" },
+    { "resize", "thumbnail lanczos3", SUITE_FILTERS, "-resize 256 192 lanczos3" },
+    { "codec", "bmp_read", SUITE_BMP_READ, NULL },
+    { "codec", "bmp_write", SUITE_BMP_WRITE, NULL },
+    { "pipeline", "blur+sharpen", SUITE_FILTERS, "-blur 1.5 -sharp" },
+    { "pipeline", "point chain", SUITE_FILTERS, "-gs -neg -sepia -vignette 0.7" },
+    { "pipeline", "crop+blur+sepia", SUITE_FILTERS, "-crop 320 240 -blur 1.2 -sepia" },
+    { "pipeline", "median+edge", SUITE_FILTERS, "-med 3 -edge 0.1" },
+};
+
+typedef struct {
+    double max_megapixels;
+    double min_time;
+    const char* filter;
+    const char* json_file;
+    const char* compare_file;
+} SuiteOptions;
+
+typedef struct {
+    const SuiteCase* test;
+    int width;
+    int height;
+    int runs;
+    double seconds;        // лучшее время одного выполнения
+    double bytes;          // объем данных для МБ/с
+} SuiteResult;
+
+// Пайплайн из описания цепочки в синтаксисе командной строки
+static FilterPipeline* suite_pipeline(const char* spec) {
+    char buffer[4096];
+    char* argv[SUITE_MAX_ARGS + 3] = { "image_craft_bench", "suite_in.bmp", "suite_out.bmp" };
+    int argc = 3;
+
+    snprintf(buffer, sizeof(buffer), "%s", spec);
+    for (char* word = strtok(buffer, " "); word && argc < SUITE_MAX_ARGS + 3; word = strtok(NULL, " ")) {
+        argv[argc++] = word;
+    }
+
+    CLIArgs* args = cli_parse_args(argc, argv);
+    if (!args) {
+        return NULL;
+    }
+
+    FilterPipeline* pipeline = NULL;
+    if (args->error) {
+        fprintf(stderr, "Error: Invalid suite pipeline '%s'\n", spec);
+    } else {
+        pipeline = args->pipeline;
+        args->pipeline = NULL;
+    }
+    cli_free_args(args);
+
+    if (pipeline) {
+        pipeline_set_threads(pipeline, 1);
+    }
+    return pipeline;
+}
+
+// Одно выполнение замера; возвращает время или -1 при ошибке
+static double suite_run_once(const SuiteCase* test, const FilterPipeline* pipeline,
+                             const Image* source, const char* filename) {
+    if (test->kind == SUITE_BMP_READ) {
+        double start = bench_now();
+        Image* image = bmp_read(filename);
+        double elapsed = bench_now() - start;
+        image_destroy(image);
+        return image ? elapsed : -1.0;
+    }
+
+    if (test->kind == SUITE_BMP_WRITE) {
+        double start = bench_now();
+        bool ok = bmp_write(filename, source, 24);
+        double elapsed = bench_now() - start;
+        return ok ? elapsed : -1.0;
+    }
+
+    Image* work = image_copy(source);
+    if (!work) {
+        return -1.0;
+    }
+
+    double start = bench_now();
+    if (test->kind == SUITE_RESIZE) {
+        int percent = atoi(test->spec);
+        image_resize(work, source->width * percent / 100, source->height * percent / 100);
+    } else {
+        pipeline_apply_serial(pipeline, work);
+    }
+    double elapsed = bench_now() - start;
+
+    image_destroy(work);
+    return elapsed;
+}
+
+// Лучшее из нескольких выполнений: повторы, пока суммарное время меньше min_time
+static bool suite_measure(const SuiteCase* test, const Image* source, const char* filename,
+                          const SuiteOptions* options, SuiteResult* result) {
+    FilterPipeline* pipeline = NULL;
+    if (test->kind == SUITE_FILTERS) {
+        pipeline = suite_pipeline(test->spec ? test->spec : suite_disk_spec());
+        if (!pipeline) {
+            return false;
+        }
+    }
+
+    result->test = test;
+    result->width = source->width;
+    result->height = source->height;
+    result->runs = 0;
+    result->seconds = -1.0;
+
+    double total = 0.0;
+    while (result->runs < SUITE_MAX_RUNS && (result->runs == 0 || total < options->min_time)) {
+        double elapsed = suite_run_once(test, pipeline, source, filename);
+        if (elapsed < 0) {
+            pipeline_destroy(pipeline);
+            return false;
+        }
+
+        total += elapsed;
+        result->runs++;
+        if (result->seconds < 0 || elapsed < result->seconds) {
+            result->seconds = elapsed;
+        }
+    }
+    pipeline_destroy(pipeline);
+
+    if (test->kind == SUITE_BMP_READ || test->kind == SUITE_BMP_WRITE) {
+        result->bytes = 54.0 + (double)((((size_t)source->width * 3 + 3) & ~(size_t)3) * source->height);
+    } else {
+        result->bytes = 3.0 * source->width * source->height;
+    }
+    return true;
+}
+
+static double suite_ns_per_pixel(const SuiteResult* result) {
+    return result->seconds * 1e9 / ((double)result->width * result->height);
+}
+
+static double suite_mb_per_second(const SuiteResult* result) {
+    return result->seconds > 0 ? result->bytes / result->seconds * 1e-6 : 0.0;
+}
+
+// Время на пиксель того же замера из прежнего JSON (по имени и размеру), -1 - нет
+static double suite_baseline(FILE* file, const SuiteResult* result) {
+    char line[1024];
+
+    if (!file) {
+        return -1.0;
+    }
+
+    rewind(file);
+    while (fgets(line, sizeof(line), file)) {
+        char name[128];
+        int width = 0;
+        int height = 0;
+        double ns = -1.0;
+
+        const char* key = strstr(line, "\"name\": \"");
+        const char* w = strstr(line, "\"width\": ");
+        const char* h = strstr(line, "\"height\": ");
+        const char* n = strstr(line, "\"ns_per_pixel\": ");
+        if (!key || !w || !h || !n ||
+            sscanf(key + 9, "%127[^\"]", name) != 1 ||
+            sscanf(w + 9, "%d", &width) != 1 ||
+            sscanf(h + 10, "%d", &height) != 1 ||
+            sscanf(n + 16, "%lf", &ns) != 1) {
+            continue;
+        }
+
+        if (strcmp(name, result->test->name) == 0 &&
+            width == result->width && height == result->height) {
+            return ns;
+        }
+    }
+    return -1.0;
+}
+
+static void suite_print_json(FILE* out, const SuiteResult* results, int count) {
+    fprintf(out, "{\n  \"suite\": \"image_craft\",\n  \"simd\": \"%s\",\n  \"threads\": 1,\n  \"results\": [\n",
+            simd_level_name(simd_kernels()->level));
+    for (int i = 0; i < count; i++) {
+        const SuiteResult* result = &results[i];
+        fprintf(out, "    {\"group\": \"%s\", \"name\": \"%s\", \"width\": %d, \"height\": %d, "
+                     "\"runs\": %d, \"seconds\": %.6f, \"ns_per_pixel\": %.3f, \"mb_per_second\": %.1f}%s\n",
+                result->test->group, result->test->name, result->width, result->height,
+                result->runs, result->seconds, suite_ns_per_pixel(result),
+                suite_mb_per_second(result), i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static bool suite_parse_options(int argc, char** argv, SuiteOptions* options) {
+    options->max_megapixels = 60.0;
+    options->min_time = 0.3;
+    options->filter = NULL;
+    options->json_file = NULL;
+    options->compare_file = NULL;
+
+    for (int i = 0; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Error: Suite option %s requires a value\n", argv[i]);
+            return false;
+        }
+
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "--max-mp") == 0) {
+            options->max_megapixels = atof(value);
+        } else if (strcmp(argv[i - 1], "--min-time") == 0) {
+            options->min_time = atof(value);
+        } else if (strcmp(argv[i - 1], "--filter") == 0) {
+            options->filter = value;
+        } else if (strcmp(argv[i - 1], "--json") == 0) {
+            options->json_file = value;
+        } else if (strcmp(argv[i - 1], "--compare") == 0) {
+            options->compare_file = value;
+        } else {
+            fprintf(stderr, "Error: Unknown suite option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int bench_suite(int argc, char** argv) {
+    const char* filename = "image_craft_suite.bmp";
+    SuiteOptions options;
+    if (!suite_parse_options(argc, argv, &options)) {
+        return EXIT_FAILURE;
+    }
+
+    FILE* baseline = NULL;
+    if (options.compare_file) {
+        baseline = fopen(options.compare_file, "r");
+        if (!baseline) {
+            fprintf(stderr, "Error: Cannot open baseline '%s'\n", options.compare_file);
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t case_count = sizeof(suite_cases) / sizeof(suite_cases[0]);
+    size_t size_count = sizeof(suite_sizes) / sizeof(suite_sizes[0]);
+    SuiteResult* results = (SuiteResult*)calloc(case_count * size_count, sizeof(SuiteResult));
+    if (!results) {
+        if (baseline) fclose(baseline);
+        return EXIT_FAILURE;
+    }
+
+    printf("suite (%s, 1 thread), ns/pixel and MB/s\n", simd_level_name(simd_kernels()->level));
+    printf("  %-9s %-18s %-11s %5s %10s %10s%s\n", "group", "case", "size", "runs", "ns/pixel", "MB/s",
+           baseline ? "    speedup" : "");
+
+    int count = 0;
+    bool ok = true;
+    for (size_t s = 0; s < size_count && ok; s++) {
+        const SuiteSize* size = &suite_sizes[s];
+        if ((double)size->width * size->height * 1e-6 > options.max_megapixels) {
+            continue;
+        }
+
+        Image* source = bench_image(size->width, size->height, (unsigned)s + 11);
+        if (!source || !bmp_write(filename, source, 24)) {
+            fprintf(stderr, "Error: Cannot prepare %dx%d suite image\n", size->width, size->height);
+            image_destroy(source);
+            ok = false;
+            break;
+        }
+
+        for (size_t c = 0; c < case_count; c++) {
+            const SuiteCase* test = &suite_cases[c];
+            if (options.filter && !strstr(test->name, options.filter) && !strstr(test->group, options.filter)) {
+                continue;
+            }
+
+            SuiteResult* result = &results[count];
+            if (!suite_measure(test, source, filename, &options, result)) {
+                fprintf(stderr, "Error: Suite case '%s' failed at %dx%d\n", test->name,
+                        size->width, size->height);
+                ok = false;
+                break;
+            }
+            count++;
+
+            char dims[32];
+            snprintf(dims, sizeof(dims), "%dx%d", size->width, size->height);
+            printf("  %-9s %-18s %-11s %5d %10.2f %10.1f", test->group, test->name, dims,
+                   result->runs, suite_ns_per_pixel(result), suite_mb_per_second(result));
+
+            double base = suite_baseline(baseline, result);
+            if (base > 0) {
+                printf(" %10.2fx", base / suite_ns_per_pixel(result));
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        image_destroy(source);
+    }
+    remove(filename);
+    printf("\n");
+
+    if (options.json_file && count > 0) {
+        FILE* out = fopen(options.json_file, "w");
+        if (out) {
+            suite_print_json(out, results, count);
+            fclose(out);
+            printf("Results saved to %s\n", options.json_file);
+        } else {
+            fprintf(stderr, "Error: Cannot write '%s'\n", options.json_file);
+            ok = false;
+        }
+    }
+
+    if (baseline) fclose(baseline);
+    free(results);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
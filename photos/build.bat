@@ -40,6 +40,9 @@ if %errorlevel% neq 0 goto error
 gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\bmp.c -o bmp.o
 if %errorlevel% neq 0 goto error
 
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\bmp_decode.c -o bmp_decode.o
+if %errorlevel% neq 0 goto error
+
 gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\filters.c -o filters.o
 if %errorlevel% neq 0 goto error
 
@@ -49,9 +52,45 @@ if %errorlevel% neq 0 goto error
 gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\cli.c -o cli.o
 if %errorlevel% neq 0 goto error
 
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\threadpool.c -o threadpool.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\pixel_image.c -o pixel_image.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\simd.c -o simd.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\mapped_file.c -o mapped_file.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\batch.c -o batch.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\buffer_pool.c -o buffer_pool.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\fft.c -o fft.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\stats.c -o stats.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\log.c -o log.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\resample.c -o resample.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\pyramid.c -o pyramid.o
+if %errorlevel% neq 0 goto error
+
+gcc -std=c11 -Wall -Wextra -Werror -O2 -D_CRT_SECURE_NO_WARNINGS -c src\info.c -o info.o
+if %errorlevel% neq 0 goto error
+
 echo.
 echo 🔗 Линковка...
-gcc main.o image.o bmp.o filters.o pipeline.o cli.o -o image_craft.exe -lm
+gcc main.o image.o bmp.o bmp_decode.o filters.o pipeline.o cli.o threadpool.o pixel_image.o simd.o mapped_file.o batch.o buffer_pool.o fft.o stats.o log.o resample.o pyramid.o info.o -o image_craft.exe -lm
 if %errorlevel% neq 0 goto error
 
 REM Очистка временных файлов
@@ -1,7 +1,7 @@
 @echo off
 echo Быстрая компиляция ImageCraft...
 gcc -std=c11 -Wall -Wextra -O2 -D_CRT_SECURE_NO_WARNINGS ^
-    src\main.c src\image.c src\bmp.c src\filters.c src\pipeline.c src\cli.c ^
+    src\main.c src\image.c src\bmp.c src\bmp_decode.c src\filters.c src\pipeline.c src\cli.c src\threadpool.c src\pixel_image.c src\simd.c src\mapped_file.c src\batch.c src\buffer_pool.c src\fft.c src\stats.c src\log.c src\resample.c src\pyramid.c src\info.c ^
     -o image_craft.exe -lm
 
 if %errorlevel% equ 0 (
@@ -0,0 +1,502 @@
+#include "batch.h"
+#include "bmp.h"
+#include "threadpool.h"
+#include "buffer_pool.h"
+#include "stats.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#define BATCH_SEPARATOR '\\'
+#define batch_name_compare _stricmp
+#else
+#include <dirent.h>
+#include <glob.h>
+#define BATCH_SEPARATOR '/'
+#define batch_name_compare strcmp
+#endif
+
+// Максимальная длина строки файла-списка
+#define BATCH_MANIFEST_LINE 4096
+
+// Глубина обхода подкаталогов (ограничивает циклы символических ссылок)
+#define BATCH_TREE_DEPTH 32
+
+// Результат обработки одного файла
+typedef struct {
+    bool ok;
+    double megapixels;
+} BatchResult;
+
+// Задание для пула: один файл на задачу
+typedef struct {
+    const FilterPipeline* pipeline;
+    const BatchFiles* files;
+    const char* output_dir;
+    int output_bits;
+    BatchResult* results;
+} BatchJob;
+
+static bool batch_add_file(BatchFiles* files, const char* path) {
+    if (files->count == files->capacity) {
+        int capacity = files->capacity ? files->capacity * 2 : 64;
+        char** paths = (char**)realloc(files->paths, sizeof(char*) * capacity);
+        if (!paths) {
+            log_error("Memory allocation failed for batch file list\n");
+            return false;
+        }
+        files->paths = paths;
+        files->capacity = capacity;
+    }
+
+    files->paths[files->count] = _strdup(path);
+    if (!files->paths[files->count]) {
+        log_error("Memory allocation failed for batch file list\n");
+        return false;
+    }
+    files->count++;
+    return true;
+}
+
+static bool batch_has_bmp_extension(const char* name) {
+    size_t length = strlen(name);
+    if (length < 4) {
+        return false;
+    }
+
+    const char* ext = name + length - 4;
+    return ext[0] == '.' && tolower((unsigned char)ext[1]) == 'b' &&
+           tolower((unsigned char)ext[2]) == 'm' && tolower((unsigned char)ext[3]) == 'p';
+}
+
+static bool batch_is_directory(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// Имя файла без каталога
+static const char* batch_basename(const char* path) {
+    const char* name = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    return name;
+}
+
+// Путь dir + разделитель + name (результат освобождает вызывающий)
+static char* batch_join(const char* dir, const char* name) {
+    size_t dir_length = strlen(dir);
+    char* path = (char*)malloc(dir_length + strlen(name) + 2);
+    if (!path) {
+        return NULL;
+    }
+
+    strcpy(path, dir);
+    if (dir_length > 0 && dir[dir_length - 1] != '/' && dir[dir_length - 1] != '\\') {
+        path[dir_length++] = BATCH_SEPARATOR;
+    }
+    strcpy(path + dir_length, name);
+    return path;
+}
+
+static int batch_compare_paths(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+#ifdef _WIN32
+
+// Каталог или шаблон: FindFirstFile сам разбирает * и ? в последнем компоненте
+static bool batch_find_files(const char* pattern, const char* dir, BatchFiles* files) {
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return true;
+    }
+
+    bool ok = true;
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) &&
+            batch_has_bmp_extension(data.cFileName)) {
+            char* path = batch_join(dir, data.cFileName);
+            ok = path && batch_add_file(files, path);
+            free(path);
+        }
+    } while (ok && FindNextFileA(find, &data));
+
+    FindClose(find);
+    return ok;
+}
+
+static bool batch_list_directory(const char* dir, BatchFiles* files) {
+    char* pattern = batch_join(dir, "*");
+    bool ok = pattern && batch_find_files(pattern, dir, files);
+    free(pattern);
+    return ok;
+}
+
+static bool batch_glob(const char* pattern, BatchFiles* files) {
+    // Каталог шаблона - все до последнего разделителя
+    size_t dir_length = (size_t)(batch_basename(pattern) - pattern);
+    char* dir = (char*)malloc(dir_length + 1);
+    if (!dir) {
+        return false;
+    }
+    memcpy(dir, pattern, dir_length);
+    dir[dir_length] = '\0';
+
+    bool ok = batch_find_files(pattern, dir, files);
+    free(dir);
+    return ok;
+}
+
+static bool batch_make_directory(const char* path) {
+    return _mkdir(path) == 0 || batch_is_directory(path);
+}
+
+static bool batch_walk_tree(const char* dir, int depth, BatchFiles* files) {
+    char* pattern = batch_join(dir, "*");
+    if (!pattern) {
+        return false;
+    }
+
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE) {
+        return true;
+    }
+
+    bool ok = true;
+    do {
+        if (strcmp(data.cFileName, ".") == 0 || strcmp(data.cFileName, "..") == 0) {
+            continue;
+        }
+
+        bool directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        if (!directory && !batch_has_bmp_extension(data.cFileName)) {
+            continue;
+        }
+
+        char* path = batch_join(dir, data.cFileName);
+        if (!path) {
+            ok = false;
+        } else if (directory) {
+            ok = depth >= BATCH_TREE_DEPTH || batch_walk_tree(path, depth + 1, files);
+        } else {
+            ok = batch_add_file(files, path);
+        }
+        free(path);
+    } while (ok && FindNextFileA(find, &data));
+
+    FindClose(find);
+    return ok;
+}
+
+#else
+
+static bool batch_list_directory(const char* dir, BatchFiles* files) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        log_error("Cannot open directory '%s'\n", dir);
+        return false;
+    }
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(handle)) != NULL) {
+        if (!batch_has_bmp_extension(entry->d_name)) {
+            continue;
+        }
+
+        char* path = batch_join(dir, entry->d_name);
+        ok = path && (batch_is_directory(path) || batch_add_file(files, path));
+        free(path);
+    }
+
+    closedir(handle);
+    return ok;
+}
+
+static bool batch_glob(const char* pattern, BatchFiles* files) {
+    glob_t matches;
+    int status = glob(pattern, 0, NULL, &matches);
+    if (status == GLOB_NOMATCH) {
+        return true;
+    }
+    if (status != 0) {
+        log_error("Cannot expand pattern '%s'\n", pattern);
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < matches.gl_pathc; i++) {
+        if (!batch_is_directory(matches.gl_pathv[i])) {
+            ok = batch_add_file(files, matches.gl_pathv[i]);
+        }
+    }
+
+    globfree(&matches);
+    return ok;
+}
+
+static bool batch_make_directory(const char* path) {
+    return mkdir(path, 0777) == 0 || batch_is_directory(path);
+}
+
+static bool batch_walk_tree(const char* dir, int depth, BatchFiles* files) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        // Недоступные подкаталоги пропускаются, корень должен открываться
+        if (depth == 0) {
+            log_error("Cannot open directory '%s'\n", dir);
+            return false;
+        }
+        log_warning("Cannot open directory '%s', skipped\n", dir);
+        return true;
+    }
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(handle)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char* path = batch_join(dir, entry->d_name);
+        if (!path) {
+            ok = false;
+        } else if (batch_is_directory(path)) {
+            ok = depth >= BATCH_TREE_DEPTH || batch_walk_tree(path, depth + 1, files);
+        } else if (batch_has_bmp_extension(entry->d_name)) {
+            ok = batch_add_file(files, path);
+        }
+        free(path);
+    }
+
+    closedir(handle);
+    return ok;
+}
+
+#endif
+
+// Файл-список: по одному пути в строке, пустые строки и # - пропускаются
+static bool batch_read_manifest(const char* manifest, BatchFiles* files) {
+    FILE* file = fopen(manifest, "r");
+    if (!file) {
+        log_error("Cannot open batch input '%s'\n", manifest);
+        return false;
+    }
+
+    bool ok = true;
+    char line[BATCH_MANIFEST_LINE];
+    while (ok && fgets(line, sizeof(line), file)) {
+        size_t length = strlen(line);
+        while (length > 0 && isspace((unsigned char)line[length - 1])) {
+            line[--length] = '\0';
+        }
+
+        const char* path = line;
+        while (isspace((unsigned char)*path)) {
+            path++;
+        }
+
+        if (*path && *path != '#') {
+            ok = batch_add_file(files, path);
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+static bool batch_collect(const char* input, bool recursive, BatchFiles* files) {
+    if (!input || !files) {
+        return false;
+    }
+
+    memset(files, 0, sizeof(BatchFiles));
+
+    bool ok;
+    bool sort = true;
+    if (batch_is_directory(input)) {
+        ok = recursive ? batch_walk_tree(input, 0, files) : batch_list_directory(input, files);
+    } else if (strpbrk(input, "*?")) {
+        ok = batch_glob(input, files);
+    } else {
+        ok = batch_read_manifest(input, files);
+        sort = false;
+    }
+
+    if (!ok) {
+        batch_free_files(files);
+        return false;
+    }
+
+    if (sort && files->count > 1) {
+        qsort(files->paths, files->count, sizeof(char*), batch_compare_paths);
+    }
+    return true;
+}
+
+bool batch_collect_files(const char* input, BatchFiles* files) {
+    return batch_collect(input, false, files);
+}
+
+bool batch_collect_tree(const char* input, BatchFiles* files) {
+    return batch_collect(input, true, files);
+}
+
+void batch_free_files(BatchFiles* files) {
+    if (!files) {
+        return;
+    }
+
+    for (int i = 0; i < files->count; i++) {
+        free(files->paths[i]);
+    }
+    free(files->paths);
+    memset(files, 0, sizeof(BatchFiles));
+}
+
+static int batch_compare_names(const void* a, const void* b) {
+    return batch_name_compare(*(const char* const*)a, *(const char* const*)b);
+}
+
+// Результаты пишутся в output_dir под именами входных файлов, поэтому два
+// входа с одинаковым именем из разных каталогов перезаписали бы один выход
+static bool batch_check_output_names(const BatchFiles* files) {
+    const char** names = (const char**)malloc(sizeof(const char*) * files->count);
+    if (!names) {
+        log_error("Memory allocation failed for batch output names\n");
+        return false;
+    }
+
+    for (int i = 0; i < files->count; i++) {
+        names[i] = batch_basename(files->paths[i]);
+    }
+    qsort(names, files->count, sizeof(const char*), batch_compare_names);
+
+    bool ok = true;
+    for (int i = 1; i < files->count; i++) {
+        if (batch_name_compare(names[i - 1], names[i]) == 0) {
+            log_error("Several input files have the same name '%s'; "
+                      "output files would overwrite each other\n", names[i]);
+            ok = false;
+        }
+    }
+
+    free(names);
+    return ok;
+}
+
+// Чтение, фильтрация и запись одного файла
+static void batch_task(void* context, int index) {
+    BatchJob* job = (BatchJob*)context;
+    const char* input = job->files->paths[index];
+    BatchResult* result = &job->results[index];
+
+    char* output = batch_join(job->output_dir, batch_basename(input));
+    if (!output) {
+        log_error("Memory allocation failed for output path\n");
+        return;
+    }
+
+    double start = stats_wall_time();
+    Image* image = bmp_read(input);
+    if (!image) {
+        log_error("[%d/%d] %s: read failed\n", index + 1, job->files->count, input);
+        free(output);
+        return;
+    }
+
+    // Мегапиксели считаются по входному изображению (до обрезки)
+    int width = image->width;
+    int height = image->height;
+    result->megapixels = (double)width * height / 1e6;
+
+    double decoded = stats_wall_time();
+    pipeline_apply_serial(job->pipeline, image);
+    double filtered = stats_wall_time();
+    result->ok = bmp_write(output, image, job->output_bits);
+    double end = stats_wall_time();
+    image_destroy(image);
+
+    if (result->ok) {
+        log_info("[%d/%d] %s: %dx%d, %.1f ms (read %.1f, filters %.1f, write %.1f), %.1f MP/s\n",
+               index + 1, job->files->count, input, width, height, (end - start) * 1e3,
+               (decoded - start) * 1e3, (filtered - decoded) * 1e3, (end - filtered) * 1e3,
+               end > start ? result->megapixels / (end - start) : 0.0);
+    } else {
+        log_error("[%d/%d] %s: write to '%s' failed\n", index + 1, job->files->count, input, output);
+    }
+    free(output);
+}
+
+bool batch_process(const FilterPipeline* pipeline, const BatchFiles* files,
+                   const char* output_dir, int worker_count, int output_bits) {
+    if (!pipeline || !files || !output_dir) {
+        log_error("Invalid parameters for batch_process\n");
+        return false;
+    }
+
+    if (files->count == 0) {
+        log_error("No input files for batch processing\n");
+        return false;
+    }
+
+    if (!batch_check_output_names(files)) {
+        return false;
+    }
+
+    if (!batch_make_directory(output_dir)) {
+        log_error("Cannot create output directory '%s'\n", output_dir);
+        return false;
+    }
+
+    BatchResult* results = (BatchResult*)calloc(files->count, sizeof(BatchResult));
+    ThreadPool* pool = worker_count == 1 ? NULL : threadpool_create(worker_count);
+    if (!results) {
+        log_error("Memory allocation failed for batch results\n");
+        threadpool_destroy(pool);
+        return false;
+    }
+
+    int workers = threadpool_get_size(pool);
+    if (workers > files->count) workers = files->count;
+    log_info("\nBatch: %d file(s), %d worker(s), %d filter(s)\n",
+           files->count, workers, pipeline_get_count(pipeline));
+    log_info("========================================\n");
+
+    BatchJob job = { pipeline, files, output_dir, output_bits, results };
+    double start = stats_wall_time();
+    threadpool_run(pool, batch_task, &job, files->count);
+    double elapsed = stats_wall_time() - start;
+
+    int succeeded = 0;
+    double megapixels = 0.0;
+    for (int i = 0; i < files->count; i++) {
+        if (results[i].ok) {
+            succeeded++;
+            megapixels += results[i].megapixels;
+        }
+    }
+
+    log_info("========================================\n");
+    log_info("Processed %d/%d file(s) in %.2f s: %.1f images/s, %.1f MP/s\n",
+           succeeded, files->count, elapsed,
+           elapsed > 0 ? succeeded / elapsed : 0.0,
+           elapsed > 0 ? megapixels / elapsed : 0.0);
+    buffer_pool_print_stats();
+
+    free(results);
+    threadpool_destroy(pool);
+    return succeeded == files->count;
+}
@@ -0,0 +1,29 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "pipeline.h"
+
+// Список входных файлов пакетной обработки
+typedef struct {
+    char** paths;
+    int count;
+    int capacity;
+} BatchFiles;
+
+// Сбор входных файлов. input - каталог (все файлы .bmp), шаблон с * и ?
+// или текстовый файл-список (по одному пути в строке, # - комментарий).
+// Пути упорядочиваются по имени, кроме списка - там сохраняется его порядок.
+bool batch_collect_files(const char* input, BatchFiles* files);
+// То же, но каталог обходится вместе со всеми подкаталогами
+bool batch_collect_tree(const char* input, BatchFiles* files);
+void batch_free_files(BatchFiles* files);
+
+// Обработка всех файлов одним пайплайном на worker_count потоках (0 - по числу
+// ядер). Каждый поток читает, фильтрует и записывает свой файл, поэтому чтение,
+// фильтры и запись разных файлов выполняются одновременно. Результаты пишутся
+// в output_dir под исходными именами (разрядность output_bits: 24 или 32);
+// входы с совпадающими именами - ошибка. Возвращает true, если обработаны все файлы.
+bool batch_process(const FilterPipeline* pipeline, const BatchFiles* files,
+                   const char* output_dir, int worker_count, int output_bits);
+
+#endif // BATCH_H
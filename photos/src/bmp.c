@@ -1,150 +1,231 @@
 #include "bmp.h"
+#include "simd.h"
+#include "log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
-Image* bmp_read(const char* filename) {
-    if (!filename) {
-        fprintf(stderr, "Error: Filename is NULL\n");
-        return NULL;
-    }
+// Размер блока строк, читаемого или записываемого одним вызовом
+#define BMP_CHUNK_BYTES (1 << 20)
 
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s': %s\n", filename, strerror(errno));
-        return NULL;
+// Длина строки в файле с выравниванием до 4 байт
+static size_t bmp_row_size(int width, int bits) {
+    return ((size_t)width * bits + 31) / 32 * 4;
+}
+
+// Число строк в одном блоке ввода-вывода
+static int bmp_chunk_rows(size_t row_size, int height) {
+    size_t rows = BMP_CHUNK_BYTES / row_size;
+    if (rows < 1) rows = 1;
+    return rows < (size_t)height ? (int)rows : height;
+}
+
+// Записываются только 24- и 32-битные файлы
+static bool bmp_check_write_bits(int bits) {
+    if (bits != 24 && bits != 32) {
+        log_error("Unsupported output bit depth %d (expected 24 or 32)\n", bits);
+        return false;
     }
+    return true;
+}
 
-    // Чтение заголовков
-    BMPFileHeader file_header;
-    BMPInfoHeader info_header;
+// Строка Color в формате файла заданной разрядности
+static void bmp_encode_row(const SimdKernels* kernels, int bits, const Color* pixels, uint8_t* row, int width) {
+    if (bits == 32) {
+        kernels->color_to_bgrx8(pixels, row, width);
+    } else {
+        kernels->color_to_bgr8(pixels, row, width);
+    }
+}
 
-    if (fread(&file_header, sizeof(BMPFileHeader), 1, file) != 1) {
-        fprintf(stderr, "Error: Cannot read BMP file header from '%s'\n", filename);
-        fclose(file);
-        return NULL;
+// Проверка области чтения; NULL заменяется всем изображением
+static bool bmp_check_region(const char* filename, int width, int height,
+                             const ImageRegion* region, ImageRegion* checked) {
+    if (!region) {
+        checked->x = 0;
+        checked->y = 0;
+        checked->width = width;
+        checked->height = height;
+        return true;
     }
 
-    // Проверка сигнатуры
-    if (file_header.signature != 0x4D42) { // 'BM'
-        fprintf(stderr, "Error: Invalid BMP signature in '%s' (expected 'BM')\n", filename);
-        fclose(file);
-        return NULL;
+    if (region->x < 0 || region->y < 0 || region->width <= 0 || region->height <= 0 ||
+        region->width > width - region->x || region->height > height - region->y) {
+        log_error("Region %dx%d at (%d, %d) is outside %dx%d image '%s'\n", region->width,
+                  region->height, region->x, region->y, width, height, filename);
+        return false;
     }
 
-    if (fread(&info_header, sizeof(BMPInfoHeader), 1, file) != 1) {
-        fprintf(stderr, "Error: Cannot read BMP info header from '%s'\n", filename);
-        fclose(file);
-        return NULL;
+    *checked = *region;
+    return true;
+}
+
+// Строка области для получателя: строки BGRX отдаются как есть, если
+// получатель их принимает (bgrx), остальные преобразуются в BGR8
+static void bmp_store_row(BMPRowDecoder* decoder, bool bgrx, const uint8_t* row, int x, int count,
+                          int y, BMPRowStore store, void* target) {
+    if (bgrx) {
+        store(target, y, row + 4 * (size_t)x, true);
+    } else {
+        store(target, y, bmp_row_decoder_run(decoder, row, x, count), false);
     }
+}
 
-    // Проверка формата (только 24-битные без сжатия)
-    if (info_header.bits_per_pixel != 24) {
-        fprintf(stderr, "Error: Only 24-bit BMP supported (got %d-bit) in '%s'\n",
-                info_header.bits_per_pixel, filename);
-        fclose(file);
-        return NULL;
+// Чтение строк области через stdio. Если область занимает строку целиком (или
+// почти), строки читаются блоками, иначе для каждой строки читаются только
+// байты области - объем чтения пропорционален области, а не изображению.
+// Файлы RLE распаковываются по порядку до верхней строки области.
+static bool bmp_read_file_region(FILE* file, const char* filename, const BMPLayout* layout,
+                                 const ImageRegion* region, bool accepts_bgrx,
+                                 BMPRowStore store, void* target) {
+    int64_t data_offset = layout->data_offset;
+    if (layout->compression == BMP_BI_RLE8 || layout->compression == BMP_BI_RLE4) {
+        if (bmp_seek(file, data_offset) != 0) {
+            log_error("Cannot seek to pixel data in '%s'\n", filename);
+            return false;
+        }
+        BMPByteStream stream = { .file = file, .origin = data_offset };
+        return bmp_decode_rle(layout, &stream, region, store, target, filename);
     }
 
-    if (info_header.compression != 0) {
-        fprintf(stderr, "Error: Only uncompressed BMP supported in '%s'\n", filename);
-        fclose(file);
-        return NULL;
+    int height = layout->height;
+    int bits = layout->bits_per_pixel;
+    size_t row_size = bmp_layout_row_size(layout);
+
+    // Частичные строки - только если пиксель занимает целое число байт
+    size_t region_bytes = (size_t)region->width * bits / 8;
+    size_t region_offset = (size_t)region->x * bits / 8;
+    bool whole_rows = bits < 8 || region_bytes * 2 >= row_size;
+
+    size_t read_size = whole_rows ? row_size : region_bytes;
+    int chunk_rows = whole_rows ? bmp_chunk_rows(row_size, region->height) : 1;
+    int first_x = whole_rows ? region->x : 0;
+    uint8_t* chunk = (uint8_t*)malloc(read_size * chunk_rows);
+    BMPRowDecoder* decoder = chunk ? bmp_row_decoder_create(layout) : NULL;
+    if (!decoder) {
+        log_error("Cannot allocate row buffer for '%s'\n", filename);
+        free(chunk);
+        return false;
     }
 
-    // Переход к данным изображения
-    if (fseek(file, file_header.data_offset, SEEK_SET) != 0) {
-        fprintf(stderr, "Error: Cannot seek to pixel data in '%s'\n", filename);
-        fclose(file);
-        return NULL;
+    bool bgrx = accepts_bgrx && bmp_layout_is_bgrx32(layout);
+    bool ok = true;
+
+    // Строки блока лежат в файле подряд при любом порядке строк
+    for (int y = 0; ok && y < region->height; y += chunk_rows) {
+        int rows = region->height - y < chunk_rows ? region->height - y : chunk_rows;
+        int image_y = region->y + y;
+        int first = layout->top_down ? image_y : height - image_y - rows;
+        int64_t offset = data_offset + (int64_t)row_size * first +
+                         (whole_rows ? 0 : (int64_t)region_offset);
+
+        if (bmp_seek(file, offset) != 0 || fread(chunk, read_size, rows, file) != (size_t)rows) {
+            log_error("Cannot read pixel rows %d-%d in '%s'\n",
+                    image_y, image_y + rows - 1, filename);
+            ok = false;
+            break;
+        }
+
+        for (int i = 0; i < rows; i++) {
+            int file_row = layout->top_down ? i : rows - 1 - i;
+            bmp_store_row(decoder, bgrx, chunk + read_size * file_row, first_x, region->width,
+                          y + i, store, target);
+        }
     }
 
-    // Создание изображения
-    int width = info_header.width;
-    int height = abs(info_header.height); // Обрабатываем отрицательную высоту
+    bmp_row_decoder_destroy(decoder);
+    free(chunk);
+    return ok;
+}
 
-    if (width <= 0 || height <= 0) {
-        fprintf(stderr, "Error: Invalid image dimensions %dx%d in '%s'\n",
-                width, height, filename);
-        fclose(file);
-        return NULL;
+// Чтение области отображенного файла, формат которого отличается от BGR8
+static bool bmp_read_mapped_region(const BMPMapping* mapping, const char* filename,
+                                   const ImageRegion* region, bool accepts_bgrx,
+                                   BMPRowStore store, void* target) {
+    const BMPLayout* layout = &mapping->layout;
+    if (layout->compression == BMP_BI_RLE8 || layout->compression == BMP_BI_RLE4) {
+        BMPByteStream stream = {
+            .data = mapping->rows,
+            .size = mapped_file_size(mapping->file) - layout->data_offset
+        };
+        return bmp_decode_rle(layout, &stream, region, store, target, filename);
     }
 
-    Image* image = image_create(width, height);
-    if (!image) {
-        fprintf(stderr, "Error: Cannot create image structure for '%s'\n", filename);
-        fclose(file);
-        return NULL;
+    BMPRowDecoder* decoder = bmp_row_decoder_create(layout);
+    if (!decoder) {
+        return false;
     }
 
-    // Расчет выравнивания строк
-    int row_padding = (4 - (width * 3) % 4) % 4;
+    bool bgrx = accepts_bgrx && bmp_layout_is_bgrx32(layout);
+    for (int y = 0; y < region->height; y++) {
+        bmp_store_row(decoder, bgrx, mapping->rows + mapping->stride * (region->y + y),
+                      region->x, region->width, y, store, target);
+    }
 
-    // Определяем порядок строк (снизу вверх или сверху вниз)
-    int is_top_down = info_header.height < 0;
+    bmp_row_decoder_destroy(decoder);
+    return true;
+}
 
-    // Чтение данных пикселей
-    for (int y = 0; y < height; y++) {
-        int target_y = is_top_down ? y : (height - 1 - y);
+static void bmp_store_color_row(void* target, int y, const uint8_t* pixels, bool bgrx) {
+    Image* image = (Image*)target;
+    const SimdKernels* kernels = simd_kernels();
+    Color* row = image->data + (size_t)y * image->width;
+    if (bgrx) {
+        kernels->bgrx8_to_color(pixels, row, image->width);
+    } else {
+        kernels->bgr8_to_color(pixels, row, image->width);
+    }
+}
 
-        for (int x = 0; x < width; x++) {
-            uint8_t pixel[3];
-            if (fread(pixel, 3, 1, file) != 1) {
-                fprintf(stderr, "Error: Cannot read pixel data at (%d, %d) in '%s'\n",
-                        x, y, filename);
-                image_destroy(image);
-                fclose(file);
-                return NULL;
-            }
+// Получатель PixelImage принимает только BGR8
+static void bmp_store_pixel_row(void* target, int y, const uint8_t* pixels, bool bgrx) {
+    (void)bgrx;
+    pixel_image_write_row_bgr8((PixelImage*)target, y, pixels);
+}
 
-            // BMP хранит цвета в порядке BGR
-            Color color = color_create(
-                pixel[2] / 255.0f, // R
-                pixel[1] / 255.0f, // G
-                pixel[0] / 255.0f  // B
-            );
+// Представление области отображенного файла (без копирования)
+static PixelImage bmp_region_view(const BMPMapping* mapping, const ImageRegion* region) {
+    PixelImage view = mapping->view;
+    view.planes[0] = pixel_image_row(&mapping->view, 0, region->y) + (size_t)region->x * 3;
+    view.width = region->width;
+    view.height = region->height;
+    return view;
+}
 
-            image_set_pixel(image, x, target_y, color);
-        }
+// Открытие файла и разбор заголовков
+static FILE* bmp_open_pixels(const char* filename, BMPLayout* layout) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        log_error("Cannot open file '%s': %s\n", filename, strerror(errno));
+        return NULL;
+    }
 
-        // Пропуск выравнивания
-        if (row_padding > 0) {
-            if (fseek(file, row_padding, SEEK_CUR) != 0) {
-                fprintf(stderr, "Error: Cannot skip padding in '%s'\n", filename);
-                image_destroy(image);
-                fclose(file);
-                return NULL;
-            }
-        }
+    // Заголовки, маски и палитра помещаются в начало файла фиксированной длины
+    uint8_t header[BMP_HEADER_MAX];
+    size_t size = fread(header, 1, sizeof(header), file);
+    if (!bmp_parse_layout(header, size, filename, layout)) {
+        fclose(file);
+        return NULL;
     }
 
-    fclose(file);
-    return image;
+    return file;
 }
 
-bool bmp_write(const char* filename, const Image* image) {
-    if (!filename || !image) {
-        fprintf(stderr, "Error: Invalid parameters for bmp_write\n");
-        return false;
-    }
-
+// Создание файла и запись заголовков BMP без сжатия (строки снизу вверх)
+static FILE* bmp_create_file(const char* filename, int width, int height, int bits) {
     FILE* file = fopen(filename, "wb");
     if (!file) {
-        fprintf(stderr, "Error: Cannot create file '%s': %s\n", filename, strerror(errno));
-        return false;
+        log_error("Cannot create file '%s': %s\n", filename, strerror(errno));
+        return NULL;
     }
 
-    // Расчет выравнивания строк
-    int row_padding = (4 - (image->width * 3) % 4) % 4;
-    int row_size = image->width * 3 + row_padding;
-    int image_size = row_size * image->height;
-    int file_size = 54 + image_size;
+    uint32_t image_size = (uint32_t)(bmp_row_size(width, bits) * height);
 
     // Заголовок файла
     BMPFileHeader file_header = {
         .signature = 0x4D42, // 'BM'
-        .file_size = file_size,
+        .file_size = 54 + image_size,
         .reserved = 0,
         .data_offset = 54
     };
@@ -152,10 +233,10 @@ bool bmp_write(const char* filename, const Image* image) {
     // Информационный заголовок
     BMPInfoHeader info_header = {
         .header_size = 40,
-        .width = image->width,
-        .height = image->height, // Положительное - снизу вверх
+        .width = width,
+        .height = height, // Положительное - снизу вверх
         .planes = 1,
-        .bits_per_pixel = 24,
+        .bits_per_pixel = (uint16_t)bits,
         .compression = 0,
         .image_size = image_size,
         .x_pixels_per_meter = 2835, // 72 DPI
@@ -164,48 +245,340 @@ bool bmp_write(const char* filename, const Image* image) {
         .important_colors = 0
     };
 
-    // Запись заголовков
-    if (fwrite(&file_header, sizeof(BMPFileHeader), 1, file) != 1) {
-        fprintf(stderr, "Error: Cannot write BMP file header to '%s'\n", filename);
+    if (fwrite(&file_header, sizeof(BMPFileHeader), 1, file) != 1 ||
+        fwrite(&info_header, sizeof(BMPInfoHeader), 1, file) != 1) {
+        log_error("Cannot write BMP headers to '%s'\n", filename);
         fclose(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+// Разбор заголовков отображенного файла и построение представления пикселей.
+// Владение file переходит к результату (при ошибке файл закрывается).
+static BMPMapping* bmp_map_file(MappedFile* file, const char* filename) {
+    const uint8_t* data = mapped_file_data(file);
+    size_t size = mapped_file_size(file);
+
+    BMPMapping* mapping = (BMPMapping*)calloc(1, sizeof(BMPMapping));
+    if (!mapping) {
+        log_error("Memory allocation failed for BMP mapping\n");
+        mapped_file_close(file);
+        return NULL;
+    }
+    mapping->file = file;
+
+    BMPLayout* layout = &mapping->layout;
+    if (!bmp_parse_layout(data, size, filename, layout)) {
+        bmp_unmap(mapping);
+        return NULL;
+    }
+
+    int width = layout->width;
+    int height = layout->height;
+    bool compressed = layout->compression == BMP_BI_RLE8 || layout->compression == BMP_BI_RLE4;
+    size_t row_size = bmp_layout_row_size(layout);
+
+    // Все строки должны лежать внутри файла, иначе обращение к ним завершит процесс
+    if (layout->data_offset > size ||
+        (!compressed && (size - layout->data_offset) / row_size < (size_t)height)) {
+        log_error("Pixel data is truncated in '%s'\n", filename);
+        bmp_unmap(mapping);
+        return NULL;
+    }
+
+    // Строка 0 изображения - последняя строка файла, если строки идут снизу вверх
+    const uint8_t* pixels = data + layout->data_offset;
+    if (compressed) {
+        mapping->rows = pixels;
+        mapping->stride = 0;
+    } else {
+        mapping->rows = layout->top_down ? pixels : pixels + row_size * (height - 1);
+        mapping->stride = layout->top_down ? (ptrdiff_t)row_size : -(ptrdiff_t)row_size;
+    }
+
+    mapping->view.format = PIXEL_FORMAT_BGR_U8;
+    mapping->view.width = width;
+    mapping->view.height = height;
+    mapping->view.stride = mapping->stride;
+    mapping->view.planes[0] = bmp_layout_is_bgr24(layout) ? (uint8_t*)mapping->rows : NULL;
+    mapping->view.buffer = NULL;
+    mapping->view.buffer_size = 0;
+    return mapping;
+}
+
+// Область отображенного файла в Image: 24-битные файлы преобразуются через
+// представление без копирования, остальные - построчно через BGR8
+static Image* bmp_mapping_to_image(const BMPMapping* mapping, const char* filename, const ImageRegion* area) {
+    Image* image = NULL;
+    if (mapping->view.planes[0]) {
+        PixelImage view = bmp_region_view(mapping, area);
+        image = pixel_image_to_image(&view);
+    } else {
+        image = image_create_scratch(area->width, area->height);
+    }
+    if (!image) {
+        log_error("Cannot create image structure for '%s'\n", filename);
+        return NULL;
+    }
+
+    if (!mapping->view.planes[0] &&
+        !bmp_read_mapped_region(mapping, filename, area, true, bmp_store_color_row, image)) {
+        image_destroy(image);
+        return NULL;
+    }
+    return image;
+}
+
+static PixelImage* bmp_mapping_to_pixels(const BMPMapping* mapping, const char* filename,
+                                         PixelFormat format, const ImageRegion* area) {
+    PixelImage* image = NULL;
+    if (mapping->view.planes[0]) {
+        PixelImage view = bmp_region_view(mapping, area);
+        image = pixel_image_convert(&view, format);
+    } else {
+        image = pixel_image_create(area->width, area->height, format);
+    }
+    if (!image) {
+        log_error("Cannot create image structure for '%s'\n", filename);
+        return NULL;
+    }
+
+    if (!mapping->view.planes[0] &&
+        !bmp_read_mapped_region(mapping, filename, area, false, bmp_store_pixel_row, image)) {
+        pixel_image_destroy(image);
+        return NULL;
+    }
+    return image;
+}
+
+BMPMapping* bmp_map(const char* filename) {
+    if (!filename) {
+        log_error("Filename is NULL\n");
+        return NULL;
+    }
+
+    MappedFile* file = mapped_file_open(filename);
+    if (!file) {
+        log_error("Cannot map file '%s' into memory\n", filename);
+        return NULL;
+    }
+
+    return bmp_map_file(file, filename);
+}
+
+void bmp_unmap(BMPMapping* mapping) {
+    if (!mapping) {
+        return;
+    }
+
+    mapped_file_close(mapping->file);
+    free(mapping);
+}
+
+struct BMPFile {
+    char* filename;        // для сообщений об ошибках
+    BMPMapping* mapping;   // отображение файла или NULL при чтении через stdio
+    FILE* file;
+    BMPLayout layout;
+    uint64_t size;
+};
+
+// Длина файла, открытого через stdio (в том числе больше 2 ГБ)
+static uint64_t bmp_file_length(FILE* file) {
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0) return 0;
+    int64_t length = _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0) return 0;
+    int64_t length = (int64_t)ftello(file);
+#endif
+    return length > 0 ? (uint64_t)length : 0;
+}
+
+BMPFile* bmp_open(const char* filename) {
+    if (!filename) {
+        log_error("Filename is NULL\n");
+        return NULL;
+    }
+
+    BMPFile* bmp = (BMPFile*)calloc(1, sizeof(BMPFile));
+    size_t length = strlen(filename);
+    char* name = (char*)malloc(length + 1);
+    if (!bmp || !name) {
+        log_error("Memory allocation failed for BMP file '%s'\n", filename);
+        free(bmp);
+        free(name);
+        return NULL;
+    }
+    memcpy(name, filename, length + 1);
+    bmp->filename = name;
+
+    // Отображенный файл преобразуется прямо из страниц кэша, без буфера stdio
+    MappedFile* file_map = mapped_file_open(filename);
+    if (file_map) {
+        bmp->size = mapped_file_size(file_map);
+        bmp->mapping = bmp_map_file(file_map, filename);
+        if (!bmp->mapping) {
+            bmp_close(bmp);
+            return NULL;
+        }
+        bmp->layout = bmp->mapping->layout;
+        return bmp;
+    }
+
+    bmp->file = bmp_open_pixels(filename, &bmp->layout);
+    if (!bmp->file) {
+        bmp_close(bmp);
+        return NULL;
+    }
+    bmp->size = bmp_file_length(bmp->file);
+    return bmp;
+}
+
+void bmp_close(BMPFile* file) {
+    if (!file) {
+        return;
+    }
+
+    bmp_unmap(file->mapping);
+    if (file->file) {
+        fclose(file->file);
+    }
+    free(file->filename);
+    free(file);
+}
+
+const BMPLayout* bmp_file_layout(const BMPFile* file) {
+    return &file->layout;
+}
+
+uint64_t bmp_file_size(const BMPFile* file) {
+    return file->size;
+}
+
+Image* bmp_file_read(BMPFile* file, const ImageRegion* region) {
+    if (!file) {
+        log_error("Invalid parameters for bmp_file_read\n");
+        return NULL;
+    }
+
+    const char* filename = file->filename;
+    ImageRegion area;
+    if (!bmp_check_region(filename, file->layout.width, file->layout.height, region, &area)) {
+        return NULL;
+    }
+
+    if (file->mapping) {
+        return bmp_mapping_to_image(file->mapping, filename, &area);
+    }
+
+    Image* image = image_create_scratch(area.width, area.height);
+    if (!image) {
+        log_error("Cannot create image structure for '%s'\n", filename);
+        return NULL;
+    }
+
+    // Строки читаются блоками вместе с выравниванием и сразу преобразуются,
+    // пока блок находится в кэше
+    if (!bmp_read_file_region(file->file, filename, &file->layout, &area, true, bmp_store_color_row, image)) {
+        image_destroy(image);
+        return NULL;
+    }
+    return image;
+}
+
+PixelImage* bmp_file_read_pixels(BMPFile* file, PixelFormat format, const ImageRegion* region) {
+    if (!file) {
+        log_error("Invalid parameters for bmp_file_read_pixels\n");
+        return NULL;
+    }
+
+    const char* filename = file->filename;
+    ImageRegion area;
+    if (!bmp_check_region(filename, file->layout.width, file->layout.height, region, &area)) {
+        return NULL;
+    }
+
+    if (file->mapping) {
+        return bmp_mapping_to_pixels(file->mapping, filename, format, &area);
+    }
+
+    PixelImage* image = pixel_image_create(area.width, area.height, format);
+    if (!image) {
+        log_error("Cannot create image structure for '%s'\n", filename);
+        return NULL;
+    }
+
+    if (!bmp_read_file_region(file->file, filename, &file->layout, &area, false, bmp_store_pixel_row, image)) {
+        pixel_image_destroy(image);
+        return NULL;
+    }
+    return image;
+}
+
+Image* bmp_read(const char* filename) {
+    return bmp_read_region(filename, NULL);
+}
+
+Image* bmp_read_region(const char* filename, const ImageRegion* region) {
+    BMPFile* file = bmp_open(filename);
+    if (!file) {
+        return NULL;
+    }
+
+    Image* image = bmp_file_read(file, region);
+    bmp_close(file);
+    return image;
+}
+
+bool bmp_write(const char* filename, const Image* image, int bits) {
+    if (!filename || !image) {
+        log_error("Invalid parameters for bmp_write\n");
+        return false;
+    }
+    if (!bmp_check_write_bits(bits)) {
         return false;
     }
 
-    if (fwrite(&info_header, sizeof(BMPInfoHeader), 1, file) != 1) {
-        fprintf(stderr, "Error: Cannot write BMP info header to '%s'\n", filename);
-        fclose(file);
+    size_t row_size = bmp_row_size(image->width, bits);
+    int chunk_rows = bmp_chunk_rows(row_size, image->height);
+
+    // Выравнивание строк остается нулевым
+    uint8_t* chunk = (uint8_t*)calloc(row_size * chunk_rows, 1);
+    if (!chunk) {
+        log_error("Cannot allocate row buffer for '%s'\n", filename);
         return false;
     }
 
-    // Запись данных пикселей
-    uint8_t padding[4] = {0, 0, 0, 0};
+    FILE* file = bmp_create_file(filename, image->width, image->height, bits);
+    if (!file) {
+        free(chunk);
+        return false;
+    }
 
-    for (int y = image->height - 1; y >= 0; y--) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
+    const SimdKernels* kernels = simd_kernels();
 
-            // Преобразование в BGR и 0-255
-            uint8_t pixel[3] = {
-                (uint8_t)(color.b * 255),
-                (uint8_t)(color.g * 255),
-                (uint8_t)(color.r * 255)
-            };
+    // Запись данных пикселей блоками строк (в файле снизу вверх)
+    for (int y = 0; y < image->height; y += chunk_rows) {
+        int rows = image->height - y < chunk_rows ? image->height - y : chunk_rows;
 
-            if (fwrite(pixel, 3, 1, file) != 1) {
-                fprintf(stderr, "Error: Cannot write pixel data to '%s'\n", filename);
-                fclose(file);
-                return false;
-            }
+        for (int i = 0; i < rows; i++) {
+            int source_y = image->height - 1 - y - i;
+            bmp_encode_row(kernels, bits, image->data + (size_t)source_y * image->width,
+                           chunk + row_size * i, image->width);
         }
 
-        // Запись выравнивания
-        if (row_padding > 0 && fwrite(padding, row_padding, 1, file) != 1) {
-            fprintf(stderr, "Error: Cannot write padding to '%s'\n", filename);
+        if (fwrite(chunk, row_size, rows, file) != (size_t)rows) {
+            log_error("Cannot write pixel data to '%s'\n", filename);
+            free(chunk);
             fclose(file);
             return false;
         }
     }
 
+    free(chunk);
     fclose(file);
     return true;
 }
@@ -258,3 +631,359 @@ bool bmp_get_info(const char* filename, int* width, int* height) {
     fclose(file);
     return success;
 }
+
+
+PixelImage* bmp_read_pixels(const char* filename, PixelFormat format) {
+    return bmp_read_pixels_region(filename, format, NULL);
+}
+
+PixelImage* bmp_read_pixels_region(const char* filename, PixelFormat format, const ImageRegion* region) {
+    BMPFile* file = bmp_open(filename);
+    if (!file) {
+        return NULL;
+    }
+
+    PixelImage* image = bmp_file_read_pixels(file, format, region);
+    bmp_close(file);
+    return image;
+}
+
+// BGR8 -> BGRX8 на месте: строка расширяется с конца
+static void bmp_expand_bgrx_row(uint8_t* row, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        row[4 * i + 3] = 255;
+        row[4 * i + 2] = row[3 * i + 2];
+        row[4 * i + 1] = row[3 * i + 1];
+        row[4 * i] = row[3 * i];
+    }
+}
+
+bool bmp_write_pixels(const char* filename, const PixelImage* image, int bits) {
+    if (!filename || !image) {
+        log_error("Invalid parameters for bmp_write_pixels\n");
+        return false;
+    }
+    if (!bmp_check_write_bits(bits)) {
+        return false;
+    }
+
+    size_t row_size = bmp_row_size(image->width, bits);
+    int chunk_rows = bmp_chunk_rows(row_size, image->height);
+
+    uint8_t* chunk = (uint8_t*)calloc(row_size * chunk_rows, 1);
+    if (!chunk) {
+        log_error("Cannot allocate row buffer for '%s'\n", filename);
+        return false;
+    }
+
+    FILE* file = bmp_create_file(filename, image->width, image->height, bits);
+    if (!file) {
+        free(chunk);
+        return false;
+    }
+
+    for (int y = 0; y < image->height; y += chunk_rows) {
+        int rows = image->height - y < chunk_rows ? image->height - y : chunk_rows;
+
+        for (int i = 0; i < rows; i++) {
+            pixel_image_read_row_bgr8(image, image->height - 1 - y - i, chunk + row_size * i);
+            if (bits == 32) {
+                bmp_expand_bgrx_row(chunk + row_size * i, image->width);
+            }
+        }
+
+        if (fwrite(chunk, row_size, rows, file) != (size_t)rows) {
+            log_error("Cannot write pixel data to '%s'\n", filename);
+            free(chunk);
+            fclose(file);
+            return false;
+        }
+    }
+
+    free(chunk);
+    fclose(file);
+    return true;
+}
+
+struct BMPRowReader {
+    BMPFile* file;
+    BMPRowDecoder* decoder;
+    BMPRleCursor* rle_rows;   // RLE: состояние распаковки перед каждой строкой файла
+    BMPByteStream stream;
+    uint8_t* line;            // RLE: распакованная строка BGR8
+    int width;
+    int height;
+    size_t row_size;
+    uint8_t* chunk;        // буфер блока строк для stdio
+    int chunk_rows;
+};
+
+// Строки файла приходят сверху вниз, а строки RLE идут снизу вверх, поэтому
+// сжатые данные разбираются один раз без записи пикселей и для каждой строки
+// запоминается состояние распаковки. Чтение полосы распаковывает только ее
+// строки, начиная с нижней: в памяти только таблица состояний (несколько
+// байт на строку), а не распакованное изображение.
+static bool bmp_row_reader_index_rle(BMPRowReader* reader) {
+    const BMPFile* file = reader->file;
+    const BMPLayout* layout = &file->layout;
+
+    reader->rle_rows = (BMPRleCursor*)malloc(sizeof(BMPRleCursor) * reader->height);
+    reader->line = (uint8_t*)malloc((size_t)reader->width * 3);
+    if (!reader->rle_rows || !reader->line) {
+        log_error("Memory allocation failed for RLE row index\n");
+        return false;
+    }
+
+    if (file->mapping) {
+        reader->stream.data = file->mapping->rows;
+        reader->stream.size = mapped_file_size(file->mapping->file) - layout->data_offset;
+    } else {
+        reader->stream.file = file->file;
+        reader->stream.origin = layout->data_offset;
+        if (bmp_seek(file->file, layout->data_offset) != 0) {
+            log_error("Cannot seek to pixel data in '%s'\n", file->filename);
+            return false;
+        }
+    }
+
+    BMPRleCursor cursor = { 0 };
+    for (int row = 0; row < reader->height; row++) {
+        reader->rle_rows[row] = cursor;
+        bmp_rle_decode_row(layout, &reader->stream, &cursor, NULL);
+    }
+
+    if (cursor.truncated) {
+        log_warning("RLE data in '%s' ends before the end of the image\n", file->filename);
+    }
+    return true;
+}
+
+BMPRowReader* bmp_row_reader_open(const char* filename, int* width, int* height) {
+    if (!filename || !width || !height) {
+        log_error("Invalid parameters for bmp_row_reader_open\n");
+        return NULL;
+    }
+
+    BMPFile* file = bmp_open(filename);
+    if (!file) {
+        return NULL;
+    }
+    return bmp_row_reader_open_file(file, width, height);
+}
+
+BMPRowReader* bmp_row_reader_open_file(BMPFile* file, int* width, int* height) {
+    if (!file || !width || !height) {
+        log_error("Invalid parameters for bmp_row_reader_open_file\n");
+        bmp_close(file);
+        return NULL;
+    }
+
+    BMPRowReader* reader = (BMPRowReader*)calloc(1, sizeof(BMPRowReader));
+    if (!reader) {
+        log_error("Memory allocation failed for BMP row reader\n");
+        bmp_close(file);
+        return NULL;
+    }
+
+    const BMPLayout* layout = &file->layout;
+    reader->file = file;
+    reader->width = layout->width;
+    reader->height = layout->height;
+    reader->row_size = bmp_layout_row_size(layout);
+
+    bool ok = true;
+    if (layout->compression == BMP_BI_RLE8 || layout->compression == BMP_BI_RLE4) {
+        ok = bmp_row_reader_index_rle(reader);
+    } else if (!bmp_layout_is_bgr24(layout) && !bmp_layout_is_bgrx32(layout)) {
+        reader->decoder = bmp_row_decoder_create(layout);
+        ok = reader->decoder != NULL;
+    }
+
+    if (!ok) {
+        bmp_row_reader_close(reader);
+        return NULL;
+    }
+
+    *width = reader->width;
+    *height = reader->height;
+    return reader;
+}
+
+// Строка файла в Color: BGR8 и BGRX8 преобразуются напрямую, остальные
+// форматы - через BGR8
+static void bmp_row_reader_convert(const BMPRowReader* reader, const uint8_t* row, Color* pixels) {
+    const SimdKernels* kernels = simd_kernels();
+
+    if (reader->decoder) {
+        row = bmp_row_decoder_run(reader->decoder, row, 0, reader->width);
+    } else if (!reader->rle_rows && bmp_layout_is_bgrx32(&reader->file->layout)) {
+        kernels->bgrx8_to_color(row, pixels, reader->width);
+        return;
+    }
+    kernels->bgr8_to_color(row, pixels, reader->width);
+}
+
+bool bmp_row_reader_read(BMPRowReader* reader, int y, int count, Color* rows) {
+    if (!reader || !rows || y < 0 || count < 0 || y + count > reader->height) {
+        return false;
+    }
+
+    if (reader->rle_rows) {
+        if (count == 0) {
+            return true;
+        }
+
+        // Строки y..y+count-1 - это строки файла first..last снизу вверх
+        const BMPLayout* layout = &reader->file->layout;
+        int first = reader->height - y - count;
+        BMPRleCursor cursor;
+        if (!bmp_rle_seek(&reader->stream, &cursor, &reader->rle_rows[first])) {
+            log_error("Cannot read pixel rows %d-%d\n", y, y + count - 1);
+            return false;
+        }
+
+        for (int row = first; row < first + count; row++) {
+            bmp_rle_decode_row(layout, &reader->stream, &cursor, reader->line);
+            int i = reader->height - 1 - row - y;
+            bmp_row_reader_convert(reader, reader->line, rows + (size_t)i * reader->width);
+        }
+        return true;
+    }
+
+    const BMPMapping* mapping = reader->file->mapping;
+    if (mapping) {
+        for (int i = 0; i < count; i++) {
+            const uint8_t* row = mapping->rows + mapping->stride * (y + i);
+            bmp_row_reader_convert(reader, row, rows + (size_t)i * reader->width);
+        }
+        return true;
+    }
+
+    // Строки y..y+count-1 лежат в файле подряд при любом порядке строк
+    if (count > reader->chunk_rows) {
+        uint8_t* chunk = (uint8_t*)realloc(reader->chunk, reader->row_size * count);
+        if (!chunk) {
+            log_error("Memory allocation failed for BMP row buffer\n");
+            return false;
+        }
+        reader->chunk = chunk;
+        reader->chunk_rows = count;
+    }
+
+    const BMPLayout* layout = &reader->file->layout;
+    int first = layout->top_down ? y : reader->height - y - count;
+    if (bmp_seek(reader->file->file, layout->data_offset + (int64_t)reader->row_size * first) != 0 ||
+        fread(reader->chunk, reader->row_size, count, reader->file->file) != (size_t)count) {
+        log_error("Cannot read pixel rows %d-%d\n", y, y + count - 1);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int file_row = layout->top_down ? i : count - 1 - i;
+        bmp_row_reader_convert(reader, reader->chunk + reader->row_size * file_row,
+                               rows + (size_t)i * reader->width);
+    }
+    return true;
+}
+
+void bmp_row_reader_close(BMPRowReader* reader) {
+    if (!reader) {
+        return;
+    }
+
+    bmp_row_decoder_destroy(reader->decoder);
+    free(reader->rle_rows);
+    free(reader->stream.buffer);
+    free(reader->line);
+    bmp_close(reader->file);
+    free(reader->chunk);
+    free(reader);
+}
+
+struct BMPRowWriter {
+    FILE* file;
+    int width;
+    int height;
+    int bits;
+    size_t row_size;
+    uint8_t* chunk;
+    int chunk_rows;
+    bool failed;
+};
+
+BMPRowWriter* bmp_row_writer_open(const char* filename, int width, int height, int bits) {
+    if (!filename || width <= 0 || height <= 0) {
+        log_error("Invalid parameters for bmp_row_writer_open\n");
+        return NULL;
+    }
+    if (!bmp_check_write_bits(bits)) {
+        return NULL;
+    }
+
+    BMPRowWriter* writer = (BMPRowWriter*)calloc(1, sizeof(BMPRowWriter));
+    if (!writer) {
+        log_error("Memory allocation failed for BMP row writer\n");
+        return NULL;
+    }
+
+    writer->bits = bits;
+    writer->file = bmp_create_file(filename, width, height, writer->bits);
+    if (!writer->file) {
+        free(writer);
+        return NULL;
+    }
+
+    writer->width = width;
+    writer->height = height;
+    writer->row_size = bmp_row_size(width, writer->bits);
+    return writer;
+}
+
+bool bmp_row_writer_write(BMPRowWriter* writer, int y, int count, const Color* rows) {
+    if (!writer || !rows || y < 0 || count < 0 || y + count > writer->height) {
+        return false;
+    }
+
+    if (count > writer->chunk_rows) {
+        // calloc: выравнивание строк остается нулевым
+        uint8_t* chunk = (uint8_t*)calloc(writer->row_size * count, 1);
+        if (!chunk) {
+            log_error("Memory allocation failed for BMP row buffer\n");
+            writer->failed = true;
+            return false;
+        }
+        free(writer->chunk);
+        writer->chunk = chunk;
+        writer->chunk_rows = count;
+    }
+
+    // Файл хранит строки снизу вверх: блок записывается в обратном порядке
+    const SimdKernels* kernels = simd_kernels();
+    for (int i = 0; i < count; i++) {
+        bmp_encode_row(kernels, writer->bits, rows + (size_t)(count - 1 - i) * writer->width,
+                       writer->chunk + writer->row_size * i, writer->width);
+    }
+
+    int64_t offset = 54 + (int64_t)writer->row_size * (writer->height - y - count);
+    if (bmp_seek(writer->file, offset) != 0 ||
+        fwrite(writer->chunk, writer->row_size, count, writer->file) != (size_t)count) {
+        log_error("Cannot write pixel rows %d-%d\n", y, y + count - 1);
+        writer->failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool bmp_row_writer_close(BMPRowWriter* writer) {
+    if (!writer) {
+        return false;
+    }
+
+    bool ok = !writer->failed && fclose(writer->file) == 0;
+    if (writer->failed) {
+        fclose(writer->file);
+    }
+    free(writer->chunk);
+    free(writer);
+    return ok;
+}
@@ -2,6 +2,9 @@
 #define BMP_H
 
 #include "image.h"
+#include "pixel_image.h"
+#include "mapped_file.h"
+#include "bmp_decode.h"
 #include <stdbool.h>
 
 #pragma pack(push, 1)
@@ -13,12 +16,12 @@ typedef struct {
 } BMPFileHeader;
 
 typedef struct {
-    uint32_t header_size;    // 40
+    uint32_t header_size;    // 40 (в файлах V4/V5 - 108/124, дальше идут маски)
     int32_t width;
     int32_t height;
     uint16_t planes;         // 1
-    uint16_t bits_per_pixel; // 24
-    uint32_t compression;    // 0
+    uint16_t bits_per_pixel; // 24 или 32 при записи
+    uint32_t compression;    // 0 при записи
     uint32_t image_size;
     int32_t x_pixels_per_meter;
     int32_t y_pixels_per_meter;
@@ -27,11 +30,74 @@ typedef struct {
 } BMPInfoHeader;
 #pragma pack(pop)
 
-// Чтение BMP файла
+// Чтение BMP файла: 1, 4, 8 бит с палитрой, 16 и 32 бита (в том числе
+// BI_BITFIELDS), 24 бита, RLE8/RLE4; заголовки BITMAPINFOHEADER, V4 и V5
 Image* bmp_read(const char* filename);
 
-// Запись BMP файла
-bool bmp_write(const char* filename, const Image* image);
+// Запись BMP файла разрядности bits: 24 или 32. Строки 32-битного файла
+// (BGRX, X = 255) не имеют выравнивания и заполняются без остатка.
+bool bmp_write(const char* filename, const Image* image, int bits);
+
+// Чтение и запись BMP в заданном формате хранения (без промежуточного Color)
+PixelImage* bmp_read_pixels(const char* filename, PixelFormat format);
+bool bmp_write_pixels(const char* filename, const PixelImage* image, int bits);
+
+// Чтение только области region (NULL - все изображение): читаются и
+// преобразуются лишь строки и столбцы области, поэтому время пропорционально
+// ее размеру, а не размеру файла
+Image* bmp_read_region(const char* filename, const ImageRegion* region);
+PixelImage* bmp_read_pixels_region(const char* filename, PixelFormat format, const ImageRegion* region);
+
+// Проба файла: одно открытие (отображение в память или stdio), сразу
+// разбираются все заголовки. Описание доступно без чтения пикселей, а чтение
+// идет из того же отображения или дескриптора без повторного открытия.
+typedef struct BMPFile BMPFile;
+
+BMPFile* bmp_open(const char* filename);
+void bmp_close(BMPFile* file);
+
+const BMPLayout* bmp_file_layout(const BMPFile* file);
+uint64_t bmp_file_size(const BMPFile* file);
+
+// Чтение области region (NULL - все изображение) открытого файла
+Image* bmp_file_read(BMPFile* file, const ImageRegion* region);
+PixelImage* bmp_file_read_pixels(BMPFile* file, PixelFormat format, const ImageRegion* region);
+
+// BMP, отображенный в память. rows - верхняя строка файла в исходном формате,
+// у файлов со строками снизу вверх шаг stride отрицателен (у RLE rows - начало
+// сжатых данных). Для несжатых 24-битных файлов view - представление пикселей
+// без копирования (формат BGR_U8, только для чтения), у остальных
+// view.planes[0] == NULL. Действительно до bmp_unmap.
+typedef struct {
+    MappedFile* file;
+    BMPLayout layout;
+    const uint8_t* rows;
+    ptrdiff_t stride;
+    PixelImage view;
+} BMPMapping;
+
+BMPMapping* bmp_map(const char* filename);
+void bmp_unmap(BMPMapping* mapping);
+
+// Потоковое чтение: строки y..y+count-1 (сверху вниз) в произвольном порядке,
+// без загрузки всего файла. Для RLE при открытии строится таблица состояний
+// распаковки по строкам, и каждое чтение распаковывает только свои строки.
+// Размеры возвращаются через width и height.
+typedef struct BMPRowReader BMPRowReader;
+
+BMPRowReader* bmp_row_reader_open(const char* filename, int* width, int* height);
+// То же для открытого файла: file переходит к читателю (при ошибке закрывается)
+BMPRowReader* bmp_row_reader_open_file(BMPFile* file, int* width, int* height);
+bool bmp_row_reader_read(BMPRowReader* reader, int y, int count, Color* rows);
+void bmp_row_reader_close(BMPRowReader* reader);
+
+// Потоковая запись: заголовки пишутся сразу, строки - блоками в любом порядке.
+// Результат совпадает с bmp_write той же разрядности. close возвращает false при ошибке записи.
+typedef struct BMPRowWriter BMPRowWriter;
+
+BMPRowWriter* bmp_row_writer_open(const char* filename, int width, int height, int bits);
+bool bmp_row_writer_write(BMPRowWriter* writer, int y, int count, const Color* rows);
+bool bmp_row_writer_close(BMPRowWriter* writer);
 
 // Проверка формата файла
 bool bmp_is_valid_format(const char* filename);
@@ -0,0 +1,501 @@
+#include "bmp_decode.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Размер блока сжатых данных, читаемого через stdio
+#define BMP_STREAM_CHUNK (64 * 1024)
+
+// Наибольшая разрядность канала в таблицах битовых полей
+#define BMP_CHANNEL_MAX_BITS 16
+
+static uint16_t bmp_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t bmp_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static bool bmp_check_depth(const char* filename, int bits, uint32_t compression, bool top_down) {
+    switch (compression) {
+        case BMP_BI_RGB:
+            if (bits == 1 || bits == 4 || bits == 8 || bits == 16 || bits == 24 || bits == 32) {
+                return true;
+            }
+            break;
+        case BMP_BI_RLE8:
+        case BMP_BI_RLE4:
+            // Сжатые файлы хранятся только снизу вверх
+            if (bits == (compression == BMP_BI_RLE8 ? 8 : 4) && !top_down) {
+                return true;
+            }
+            break;
+        case BMP_BI_BITFIELDS:
+        case BMP_BI_ALPHABITFIELDS:
+            if (bits == 16 || bits == 32) {
+                return true;
+            }
+            break;
+        default:
+            log_error("Unsupported BMP compression %u in '%s'\n", compression, filename);
+            return false;
+    }
+
+    log_error("Unsupported %d-bit BMP with compression %u in '%s'\n", bits, compression, filename);
+    return false;
+}
+
+bool bmp_parse_layout(const uint8_t* data, size_t size, const char* filename, BMPLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+
+    if (size < 18) {
+        log_error("Cannot read BMP file header from '%s'\n", filename);
+        return false;
+    }
+
+    if (bmp_u16(data) != 0x4D42) { // 'BM'
+        log_error("Invalid BMP signature in '%s' (expected 'BM')\n", filename);
+        return false;
+    }
+
+    uint32_t header_size = bmp_u32(data + 14);
+    if (header_size != 40 && header_size != 52 && header_size != 56 &&
+        header_size != 108 && header_size != 124) {
+        log_error("Unsupported BMP header size %u in '%s'\n", header_size, filename);
+        return false;
+    }
+
+    if (size < 14 + (size_t)header_size) {
+        log_error("Cannot read BMP info header from '%s'\n", filename);
+        return false;
+    }
+
+    const uint8_t* info = data + 14;
+    int32_t width = (int32_t)bmp_u32(info + 4);
+    int32_t height = (int32_t)bmp_u32(info + 8);
+    int bits = bmp_u16(info + 14);
+    uint32_t compression = bmp_u32(info + 16);
+    uint32_t colors_used = bmp_u32(info + 32);
+
+    if (width <= 0 || height == 0 || height == INT32_MIN) {
+        log_error("Invalid image dimensions %dx%d in '%s'\n", width, height, filename);
+        return false;
+    }
+
+    layout->width = width;
+    layout->height = height < 0 ? -height : height;
+    layout->top_down = height < 0;
+    layout->bits_per_pixel = bits;
+    layout->compression = compression;
+    layout->header_size = header_size;
+    layout->data_offset = bmp_u32(data + 10);
+
+    if (!bmp_check_depth(filename, bits, compression, layout->top_down)) {
+        return false;
+    }
+
+    // Маски: в заголовках V2 и новее или сразу после BITMAPINFOHEADER
+    size_t offset = 14 + (size_t)header_size;
+    if (compression == BMP_BI_BITFIELDS || compression == BMP_BI_ALPHABITFIELDS) {
+        const uint8_t* masks = info + 40;
+        if (header_size == 40) {
+            if (size < offset + 12) {
+                log_error("Cannot read BMP color masks from '%s'\n", filename);
+                return false;
+            }
+            masks = data + offset;
+            offset += compression == BMP_BI_ALPHABITFIELDS ? 16 : 12;
+        }
+        for (int c = 0; c < 3; c++) {
+            layout->masks[c] = bmp_u32(masks + 4 * c);
+        }
+    } else if (bits == 16) {
+        layout->masks[0] = 0x7C00;
+        layout->masks[1] = 0x03E0;
+        layout->masks[2] = 0x001F;
+    } else if (bits == 32) {
+        layout->masks[0] = 0x00FF0000;
+        layout->masks[1] = 0x0000FF00;
+        layout->masks[2] = 0x000000FF;
+    }
+
+    // Палитра (элементы BGRX) - между заголовками и пикселями
+    if (bits <= 8) {
+        size_t entries = colors_used && colors_used < (1u << bits) ? colors_used : (1u << bits);
+        size_t end = layout->data_offset > offset && layout->data_offset < size ? layout->data_offset : size;
+        size_t available = end > offset ? (end - offset) / 4 : 0;
+        if (entries > available) {
+            entries = available;
+        }
+        if (entries == 0) {
+            log_error("Missing color palette in '%s'\n", filename);
+            return false;
+        }
+
+        for (size_t i = 0; i < entries; i++) {
+            memcpy(layout->palette[i], data + offset + 4 * i, 3);
+        }
+        layout->palette_size = (int)entries;
+    }
+
+    return true;
+}
+
+size_t bmp_layout_row_size(const BMPLayout* layout) {
+    return ((size_t)layout->width * layout->bits_per_pixel + 31) / 32 * 4;
+}
+
+bool bmp_layout_is_bgr24(const BMPLayout* layout) {
+    return layout->bits_per_pixel == 24 && layout->compression == BMP_BI_RGB;
+}
+
+bool bmp_layout_is_bgrx32(const BMPLayout* layout) {
+    return layout->bits_per_pixel == 32 && layout->masks[0] == 0x00FF0000 &&
+           layout->masks[1] == 0x0000FF00 && layout->masks[2] == 0x000000FF;
+}
+
+const char* bmp_compression_name(uint32_t compression) {
+    switch (compression) {
+        case BMP_BI_RGB: return "RGB";
+        case BMP_BI_RLE8: return "RLE8";
+        case BMP_BI_RLE4: return "RLE4";
+        case BMP_BI_BITFIELDS: return "BITFIELDS";
+        case BMP_BI_ALPHABITFIELDS: return "ALPHABITFIELDS";
+        default: return "unknown";
+    }
+}
+
+const char* bmp_header_name(uint32_t header_size) {
+    switch (header_size) {
+        case 40: return "INFO";
+        case 52: return "V2";
+        case 56: return "V3";
+        case 108: return "V4";
+        case 124: return "V5";
+        default: return "unknown";
+    }
+}
+
+struct BMPRowDecoder {
+    const BMPLayout* layout;
+    bool bgrx;
+    // Битовые поля: канал = lut[c][(value >> shift[c]) & max[c]], c - R, G, B
+    int shift[3];
+    uint32_t max[3];
+    uint8_t* lut[3];
+    uint8_t* row;      // строка результата BGR8
+};
+
+// Таблица канала: значение поля маски -> 0..255 с округлением
+static bool bmp_channel_table(BMPRowDecoder* decoder, int c, uint32_t mask) {
+    int shift = 0;
+    int bits = 0;
+    if (mask) {
+        while (!(mask >> shift & 1)) shift++;
+        while (shift + bits < 32 && (mask >> (shift + bits))) bits++;
+    }
+    // Младшие разряды широких полей отбрасываются
+    if (bits > BMP_CHANNEL_MAX_BITS) {
+        shift += bits - BMP_CHANNEL_MAX_BITS;
+        bits = BMP_CHANNEL_MAX_BITS;
+    }
+
+    uint32_t max = bits ? (1u << bits) - 1 : 0;
+    uint8_t* lut = (uint8_t*)malloc((size_t)max + 1);
+    if (!lut) {
+        return false;
+    }
+    for (uint32_t v = 0; v <= max; v++) {
+        lut[v] = max ? (uint8_t)((v * 255u + max / 2) / max) : 0;
+    }
+
+    decoder->shift[c] = shift;
+    decoder->max[c] = max;
+    decoder->lut[c] = lut;
+    return true;
+}
+
+BMPRowDecoder* bmp_row_decoder_create(const BMPLayout* layout) {
+    BMPRowDecoder* decoder = (BMPRowDecoder*)calloc(1, sizeof(BMPRowDecoder));
+    if (!decoder) {
+        log_error("Memory allocation failed for BMP row decoder\n");
+        return NULL;
+    }
+
+    decoder->layout = layout;
+    decoder->bgrx = bmp_layout_is_bgrx32(layout);
+    decoder->row = (uint8_t*)malloc((size_t)layout->width * 3);
+    bool ok = decoder->row != NULL;
+
+    if (ok && (layout->bits_per_pixel == 16 || (layout->bits_per_pixel == 32 && !decoder->bgrx))) {
+        for (int c = 0; c < 3 && ok; c++) {
+            ok = bmp_channel_table(decoder, c, layout->masks[c]);
+        }
+    }
+
+    if (!ok) {
+        log_error("Memory allocation failed for BMP row decoder\n");
+        bmp_row_decoder_destroy(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+void bmp_row_decoder_destroy(BMPRowDecoder* decoder) {
+    if (!decoder) {
+        return;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        free(decoder->lut[c]);
+    }
+    free(decoder->row);
+    free(decoder);
+}
+
+// Битовые поля 16 или 32 бит
+static void bmp_decode_bitfields(const BMPRowDecoder* decoder, const uint8_t* row, int x, int count,
+                                 uint8_t* out) {
+    bool wide = decoder->layout->bits_per_pixel == 32;
+    for (int i = 0; i < count; i++) {
+        uint32_t value = wide ? bmp_u32(row + 4 * (size_t)(x + i)) : bmp_u16(row + 2 * (size_t)(x + i));
+        out[3 * i] = decoder->lut[2][(value >> decoder->shift[2]) & decoder->max[2]];
+        out[3 * i + 1] = decoder->lut[1][(value >> decoder->shift[1]) & decoder->max[1]];
+        out[3 * i + 2] = decoder->lut[0][(value >> decoder->shift[0]) & decoder->max[0]];
+    }
+}
+
+const uint8_t* bmp_row_decoder_run(BMPRowDecoder* decoder, const uint8_t* row, int x, int count) {
+    const BMPLayout* layout = decoder->layout;
+    uint8_t* out = decoder->row;
+
+    switch (layout->bits_per_pixel) {
+        case 24:
+            return row + 3 * (size_t)x;
+
+        case 32:
+            if (decoder->bgrx) {
+                const uint8_t* p = row + 4 * (size_t)x;
+                for (int i = 0; i < count; i++) {
+                    out[3 * i] = p[4 * i];
+                    out[3 * i + 1] = p[4 * i + 1];
+                    out[3 * i + 2] = p[4 * i + 2];
+                }
+                break;
+            }
+            bmp_decode_bitfields(decoder, row, x, count, out);
+            break;
+
+        case 16:
+            bmp_decode_bitfields(decoder, row, x, count, out);
+            break;
+
+        case 8:
+            for (int i = 0; i < count; i++) {
+                memcpy(out + 3 * i, layout->palette[row[x + i]], 3);
+            }
+            break;
+
+        case 4:
+            for (int i = 0; i < count; i++) {
+                int p = x + i;
+                int index = (row[p >> 1] >> (p & 1 ? 0 : 4)) & 0x0F;
+                memcpy(out + 3 * i, layout->palette[index], 3);
+            }
+            break;
+
+        default: // 1 бит
+            for (int i = 0; i < count; i++) {
+                int p = x + i;
+                int index = (row[p >> 3] >> (7 - (p & 7))) & 1;
+                memcpy(out + 3 * i, layout->palette[index], 3);
+            }
+            break;
+    }
+
+    return out;
+}
+
+int bmp_seek(FILE* file, int64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+// Следующий байт сжатых данных или -1 в конце
+static int bmp_stream_byte(BMPByteStream* stream) {
+    if (stream->position < stream->size) {
+        return stream->data[stream->position++];
+    }
+    if (!stream->file) {
+        return -1;
+    }
+
+    if (!stream->buffer) {
+        stream->buffer = (uint8_t*)malloc(BMP_STREAM_CHUNK);
+        if (!stream->buffer) {
+            return -1;
+        }
+    }
+    stream->base += stream->size;
+    stream->data = stream->buffer;
+    stream->size = fread(stream->buffer, 1, BMP_STREAM_CHUNK, stream->file);
+    stream->position = 0;
+    return stream->size ? stream->data[stream->position++] : -1;
+}
+
+bool bmp_rle_seek(BMPByteStream* stream, BMPRleCursor* cursor, const BMPRleCursor* saved) {
+    uint64_t offset = saved->offset;
+    if (offset >= stream->base && offset - stream->base <= stream->size) {
+        // Позиция внутри отображения или текущего блока
+        stream->position = (size_t)(offset - stream->base);
+    } else if (!stream->file || bmp_seek(stream->file, stream->origin + (int64_t)offset) != 0) {
+        return false;
+    } else {
+        stream->base = offset;
+        stream->size = 0;
+        stream->position = 0;
+    }
+
+    *cursor = *saved;
+    return true;
+}
+
+static void bmp_rle_put(const BMPLayout* layout, uint8_t* line, int x, int index) {
+    if (line && x < layout->width) {
+        memcpy(line + 3 * (size_t)x, layout->palette[index], 3);
+    }
+}
+
+void bmp_rle_decode_row(const BMPLayout* layout, BMPByteStream* stream, BMPRleCursor* cursor,
+                        uint8_t* line) {
+    if (line) {
+        memset(line, 0, (size_t)layout->width * 3);
+    }
+    if (cursor->skip > 0) {
+        cursor->skip--;
+        return;
+    }
+    if (cursor->ended) {
+        return;
+    }
+
+    bool rle4 = layout->compression == BMP_BI_RLE4;
+    int x = cursor->x;
+
+    for (;;) {
+        int count = bmp_stream_byte(stream);
+        int value = bmp_stream_byte(stream);
+        if (value < 0) {
+            cursor->truncated = true;
+            cursor->ended = true;
+            break;
+        }
+
+        if (count > 0) {
+            // Повтор: count пикселей одного индекса (RLE4 - чередование двух)
+            for (int i = 0; i < count; i++, x++) {
+                bmp_rle_put(layout, line, x, rle4 ? (i & 1 ? value & 0x0F : value >> 4) : value);
+            }
+        } else if (value == 0) {
+            // Конец строки
+            x = 0;
+            break;
+        } else if (value == 1) {
+            // Конец изображения
+            cursor->ended = true;
+            break;
+        } else if (value == 2) {
+            // Сдвиг на dx пикселей вправо и dy строк вверх
+            int dx = bmp_stream_byte(stream);
+            int dy = bmp_stream_byte(stream);
+            if (dy < 0) {
+                cursor->truncated = true;
+                cursor->ended = true;
+                break;
+            }
+            x += dx;
+            if (x > layout->width) {
+                x = layout->width;
+            }
+            if (dy > 0) {
+                cursor->skip = dy - 1;
+                break;
+            }
+        } else {
+            // Несжатый участок из value пикселей, дополненный до четного числа байт
+            int bytes = rle4 ? (value + 1) / 2 : value;
+            int pixel = 0;
+            for (int i = 0; i < bytes; i++) {
+                int byte = bmp_stream_byte(stream);
+                if (byte < 0) {
+                    cursor->truncated = true;
+                    cursor->ended = true;
+                    break;
+                }
+                if (rle4) {
+                    bmp_rle_put(layout, line, x + pixel++, byte >> 4);
+                    if (pixel < value) {
+                        bmp_rle_put(layout, line, x + pixel++, byte & 0x0F);
+                    }
+                } else {
+                    bmp_rle_put(layout, line, x + pixel++, byte);
+                }
+            }
+            if (cursor->ended) {
+                break;
+            }
+            x += value;
+            if (bytes & 1) {
+                bmp_stream_byte(stream);
+            }
+        }
+
+        // Дальше ширины строки пиксели не записываются
+        if (x > layout->width) {
+            x = layout->width;
+        }
+    }
+
+    cursor->x = x;
+    cursor->offset = stream->base + stream->position;
+}
+
+bool bmp_decode_rle(const BMPLayout* layout, BMPByteStream* stream, const ImageRegion* region,
+                    BMPRowStore store, void* target, const char* filename) {
+    uint8_t* line = (uint8_t*)malloc((size_t)layout->width * 3);
+    if (!line) {
+        log_error("Memory allocation failed for RLE row buffer\n");
+        free(stream->buffer);
+        stream->buffer = NULL;
+        return false;
+    }
+
+    // Строки файла идут снизу вверх; распаковка заканчивается на верхней строке области
+    BMPRleCursor cursor = { 0 };
+    int row_begin = layout->height - region->y - region->height;
+    int row_end = layout->height - region->y;
+    for (int row = 0; row < row_end; row++) {
+        // После конца данных все строки черные: строки ниже области не перебираются
+        if (cursor.ended && cursor.skip == 0 && row < row_begin) {
+            row = row_begin;
+        }
+        bmp_rle_decode_row(layout, stream, &cursor, line);
+        int y = layout->height - 1 - row;
+        if (y < region->y + region->height) {
+            store(target, y - region->y, line + 3 * (size_t)region->x, false);
+        }
+    }
+
+    if (cursor.truncated) {
+        log_warning("RLE data in '%s' ends before the end of the image\n", filename);
+    }
+
+    free(line);
+    free(stream->buffer);
+    stream->buffer = NULL;
+    return true;
+}
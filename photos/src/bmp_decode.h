@@ -0,0 +1,107 @@
+#ifndef BMP_DECODE_H
+#define BMP_DECODE_H
+
+#include "image.h"
+#include <stdio.h>
+
+// Разбор заголовков BMP всех распространенных вариантов (BITMAPINFOHEADER,
+// V2/V3 с масками, V4, V5) и преобразование строк файла в BGR8: палитры 1, 4
+// и 8 бит, 16 и 32 бита с битовыми полями, потоковая распаковка RLE8/RLE4.
+// Преобразование табличное: палитра и таблицы каналов строятся один раз.
+
+// Поле compression
+#define BMP_BI_RGB             0
+#define BMP_BI_RLE8            1
+#define BMP_BI_RLE4            2
+#define BMP_BI_BITFIELDS       3
+#define BMP_BI_ALPHABITFIELDS  6
+
+// Сколько байт от начала файла достаточно для разбора заголовков, масок и палитры
+#define BMP_HEADER_MAX (14 + 124 + 16 + 256 * 4)
+
+typedef struct {
+    int width;
+    int height;               // всегда положительная
+    bool top_down;            // строки в файле сверху вниз
+    int bits_per_pixel;       // 1, 4, 8, 16, 24 или 32
+    uint32_t compression;
+    uint32_t header_size;     // 40, 52, 56, 108 (V4) или 124 (V5)
+    uint32_t data_offset;
+    uint32_t masks[3];        // маски R, G, B для 16 и 32 бит
+    int palette_size;         // элементов палитры в файле
+    uint8_t palette[256][3];  // BGR; отсутствующие в файле элементы - черные
+} BMPLayout;
+
+// Разбор заголовков по первым size байтам файла (не больше BMP_HEADER_MAX нужно)
+bool bmp_parse_layout(const uint8_t* data, size_t size, const char* filename, BMPLayout* layout);
+
+// Длина строки в файле с выравниванием до 4 байт (для несжатых файлов)
+size_t bmp_layout_row_size(const BMPLayout* layout);
+
+// Несжатый 24-битный файл: строки уже в BGR8
+bool bmp_layout_is_bgr24(const BMPLayout* layout);
+
+// 32 бита с масками X8R8G8B8: строки в BGRX, альфа (если есть) не используется
+bool bmp_layout_is_bgrx32(const BMPLayout* layout);
+
+// Имена для отчетов: сжатие (RGB, RLE8, BITFIELDS...) и заголовок (INFO, V2..V5)
+const char* bmp_compression_name(uint32_t compression);
+const char* bmp_header_name(uint32_t header_size);
+
+// Получатель готовой строки: y - номер строки сверху, pixels - BGR8 или
+// BGRX8 (bgrx), ровно столько пикселей, сколько ожидает получатель
+typedef void (*BMPRowStore)(void* target, int y, const uint8_t* pixels, bool bgrx);
+
+// Преобразование строк несжатого файла в BGR8 по таблицам
+typedef struct BMPRowDecoder BMPRowDecoder;
+
+BMPRowDecoder* bmp_row_decoder_create(const BMPLayout* layout);
+void bmp_row_decoder_destroy(BMPRowDecoder* decoder);
+
+// Пиксели x..x+count-1 строки файла row в BGR8. Результат действителен до
+// следующего вызова (для 24-битных файлов указывает прямо в row).
+const uint8_t* bmp_row_decoder_run(BMPRowDecoder* decoder, const uint8_t* row, int x, int count);
+
+// Абсолютное позиционирование, в том числе в файлах больше 2 ГБ
+int bmp_seek(FILE* file, int64_t offset);
+
+// Сжатые данные: отображение файла (data, size) или файл, читаемый блоками.
+// Для файла origin - смещение сжатых данных (нужно для bmp_rle_seek), base -
+// сколько байт данных прочитано до текущего блока.
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    FILE* file;
+    uint8_t* buffer;
+    int64_t origin;
+    uint64_t base;
+} BMPByteStream;
+
+// Состояние распаковки RLE на границе строк файла. Сохраненное перед строкой,
+// оно позволяет распаковать эту строку снова, не разбирая данные с начала.
+typedef struct {
+    uint64_t offset;   // байт сжатых данных от начала
+    int x;             // столбец, с которого продолжается строка после сдвига
+    int skip;          // строк, целиком пропущенных сдвигом
+    bool ended;        // конец изображения или данных: дальше строки черные
+    bool truncated;    // данные закончились раньше изображения
+} BMPRleCursor;
+
+// Распаковка следующей строки файла (строки идут снизу вверх) в line - BGR8
+// на всю ширину; line = NULL только продвигает cursor. Пропущенные сдвигом и
+// не записанные пиксели - черные.
+void bmp_rle_decode_row(const BMPLayout* layout, BMPByteStream* stream, BMPRleCursor* cursor,
+                        uint8_t* line);
+
+// Возврат к сохраненному состоянию saved: в отображении меняется позиция,
+// файл перечитывается с origin + saved->offset
+bool bmp_rle_seek(BMPByteStream* stream, BMPRleCursor* cursor, const BMPRleCursor* saved);
+
+// Потоковая распаковка RLE8/RLE4: строки распаковываются по порядку файла в
+// буфер одной строки и сразу отдаются store, если попадают в region (y
+// считается от верха области). Строки выше области не распаковываются.
+bool bmp_decode_rle(const BMPLayout* layout, BMPByteStream* stream, const ImageRegion* region,
+                    BMPRowStore store, void* target, const char* filename);
+
+#endif // BMP_DECODE_H
@@ -0,0 +1,243 @@
+#include "buffer_pool.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+static SRWLOCK pool_lock = SRWLOCK_INIT;
+#define pool_lock_acquire()  AcquireSRWLockExclusive(&pool_lock)
+#define pool_lock_release()  ReleaseSRWLockExclusive(&pool_lock)
+#else
+#include <pthread.h>
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#define pool_lock_acquire()  pthread_mutex_lock(&pool_lock)
+#define pool_lock_release()  pthread_mutex_unlock(&pool_lock)
+#endif
+
+// Наибольшее число хранимых буферов
+#define BUFFER_POOL_MAX_ENTRIES 64
+
+// Предел хранимого объема по умолчанию
+#define BUFFER_POOL_DEFAULT_LIMIT ((size_t)1 << 30)
+
+// Заголовок перед каждым буфером: размер нужен при возврате в пул.
+// 16 байт сохраняют выравнивание malloc для векторных ядер.
+typedef struct {
+    size_t size;
+    size_t reserved;
+} BufferHeader;
+
+typedef struct {
+    BufferHeader* entries[BUFFER_POOL_MAX_ENTRIES];  // в порядке возврата (старые первыми)
+    int count;
+    size_t limit;
+    bool limit_set;
+    BufferPoolStats stats;
+} BufferPool;
+
+static BufferPool pool;
+
+// Вызывается под блокировкой
+static void buffer_pool_init_limit(void) {
+    if (pool.limit_set) {
+        return;
+    }
+
+    pool.limit = BUFFER_POOL_DEFAULT_LIMIT;
+    const char* megabytes = getenv("IMAGE_CRAFT_POOL_MB");
+    if (megabytes) {
+        char* end = NULL;
+        long value = strtol(megabytes, &end, 10);
+        if (end != megabytes && *end == '\0' && value >= 0) {
+            pool.limit = (size_t)value << 20;
+        }
+    }
+    pool.limit_set = true;
+}
+
+static void buffer_pool_update_peak(void) {
+    size_t total = pool.stats.bytes_in_use + pool.stats.bytes_cached;
+    if (total > pool.stats.peak_bytes) {
+        pool.stats.peak_bytes = total;
+    }
+    if (pool.stats.bytes_in_use > pool.stats.peak_in_use) {
+        pool.stats.peak_in_use = pool.stats.bytes_in_use;
+    }
+}
+
+// Удаление записи index из списка хранимых (под блокировкой)
+static BufferHeader* buffer_pool_take(int index) {
+    BufferHeader* header = pool.entries[index];
+    memmove(&pool.entries[index], &pool.entries[index + 1],
+            sizeof(BufferHeader*) * (pool.count - index - 1));
+    pool.count--;
+    pool.stats.bytes_cached -= header->size;
+    return header;
+}
+
+void* buffer_pool_acquire(size_t bytes, bool zero) {
+    BufferHeader* header = NULL;
+
+    pool_lock_acquire();
+    buffer_pool_init_limit();
+    pool.stats.requests++;
+
+    // Наименьший подходящий буфер; слишком большие не берутся, чтобы не
+    // удерживать лишнюю память под маленькие запросы
+    int best = -1;
+    for (int i = 0; i < pool.count; i++) {
+        size_t size = pool.entries[i]->size;
+        if (size >= bytes && size - bytes <= bytes / 4 &&
+            (best < 0 || size < pool.entries[best]->size)) {
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        header = buffer_pool_take(best);
+        pool.stats.hits++;
+        pool.stats.bytes_in_use += header->size;
+        buffer_pool_update_peak();
+    }
+    pool_lock_release();
+
+    if (header) {
+        if (zero) {
+            memset(header + 1, 0, bytes);
+        }
+        return header + 1;
+    }
+
+    header = (BufferHeader*)(zero ? calloc(1, sizeof(BufferHeader) + bytes)
+                                  : malloc(sizeof(BufferHeader) + bytes));
+    if (!header) {
+        // Хранимые буферы могли занять память - освобождаем их и пробуем снова
+        buffer_pool_trim();
+        header = (BufferHeader*)(zero ? calloc(1, sizeof(BufferHeader) + bytes)
+                                      : malloc(sizeof(BufferHeader) + bytes));
+        if (!header) {
+            return NULL;
+        }
+    }
+
+    header->size = bytes;
+
+    pool_lock_acquire();
+    pool.stats.bytes_in_use += bytes;
+    buffer_pool_update_peak();
+    pool_lock_release();
+
+    return header + 1;
+}
+
+void buffer_pool_release(void* buffer) {
+    if (!buffer) {
+        return;
+    }
+
+    BufferHeader* header = (BufferHeader*)buffer - 1;
+    BufferHeader* evicted[BUFFER_POOL_MAX_ENTRIES + 1];
+    int evicted_count = 0;
+
+    pool_lock_acquire();
+    buffer_pool_init_limit();
+    pool.stats.bytes_in_use -= header->size;
+
+    if (header->size > pool.limit) {
+        evicted[evicted_count++] = header;
+    } else {
+        // Вытесняются самые давно возвращенные буферы
+        while (pool.count > 0 &&
+               (pool.count == BUFFER_POOL_MAX_ENTRIES ||
+                pool.stats.bytes_cached + header->size > pool.limit)) {
+            evicted[evicted_count++] = buffer_pool_take(0);
+        }
+        pool.entries[pool.count++] = header;
+        pool.stats.bytes_cached += header->size;
+    }
+    pool_lock_release();
+
+    for (int i = 0; i < evicted_count; i++) {
+        free(evicted[i]);
+    }
+}
+
+void buffer_pool_set_limit(size_t bytes) {
+    pool_lock_acquire();
+    pool.limit = bytes;
+    pool.limit_set = true;
+    pool_lock_release();
+
+    // Если хранимые буферы не помещаются в новый предел, они освобождаются
+    BufferPoolStats stats;
+    buffer_pool_get_stats(&stats);
+    if (stats.bytes_cached > bytes) {
+        buffer_pool_trim();
+    }
+}
+
+void buffer_pool_trim(void) {
+    BufferHeader* entries[BUFFER_POOL_MAX_ENTRIES];
+
+    pool_lock_acquire();
+    int count = pool.count;
+    memcpy(entries, pool.entries, sizeof(BufferHeader*) * count);
+    pool.count = 0;
+    pool.stats.bytes_cached = 0;
+    pool_lock_release();
+
+    for (int i = 0; i < count; i++) {
+        free(entries[i]);
+    }
+}
+
+void buffer_pool_get_stats(BufferPoolStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    pool_lock_acquire();
+    *stats = pool.stats;
+    pool_lock_release();
+}
+
+void buffer_pool_reset_stats(void) {
+    pool_lock_acquire();
+    pool.stats.requests = 0;
+    pool.stats.hits = 0;
+    pool.stats.peak_bytes = pool.stats.bytes_in_use + pool.stats.bytes_cached;
+    pool.stats.peak_in_use = pool.stats.bytes_in_use;
+    pool_lock_release();
+}
+
+size_t buffer_pool_peak_begin(void) {
+    pool_lock_acquire();
+    size_t outer_peak = pool.stats.peak_in_use;
+    pool.stats.peak_in_use = pool.stats.bytes_in_use;
+    pool_lock_release();
+    return outer_peak;
+}
+
+size_t buffer_pool_peak_end(size_t outer_peak) {
+    pool_lock_acquire();
+    size_t peak = pool.stats.peak_in_use;
+    if (outer_peak > pool.stats.peak_in_use) {
+        pool.stats.peak_in_use = outer_peak;
+    }
+    pool_lock_release();
+    return peak;
+}
+
+void buffer_pool_print_stats(void) {
+    BufferPoolStats stats;
+    buffer_pool_get_stats(&stats);
+
+    log_info("Buffer pool: %llu request(s), %.1f%% reused, peak %.1f MB, cached %.1f MB\n",
+           stats.requests,
+           stats.requests ? 100.0 * stats.hits / stats.requests : 0.0,
+           stats.peak_bytes / 1048576.0, stats.bytes_cached / 1048576.0);
+}
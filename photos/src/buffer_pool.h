@@ -0,0 +1,49 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Пул буферов пикселей. Возвращенные буферы не освобождаются, а хранятся и
+// выдаются повторно под запросы того же (или чуть меньшего) размера: временные
+// копии фильтров и изображения одинакового размера в пакетной обработке
+// перестают нагружать распределитель памяти и вызывать отказы страниц.
+// Все функции потокобезопасны.
+
+// Статистика пула
+typedef struct {
+    unsigned long long requests;   // всего запросов
+    unsigned long long hits;       // запросов, обслуженных из пула
+    size_t bytes_in_use;           // выдано и еще не возвращено
+    size_t bytes_cached;           // хранится для повторного использования
+    size_t peak_bytes;             // наибольшее значение in_use + cached
+    size_t peak_in_use;            // наибольшее значение in_use в текущем окне замера
+} BufferPoolStats;
+
+// Выделение буфера не меньше bytes байт (выровнен по 16 байт).
+// zero - заполнить нулями (как calloc), иначе содержимое не определено.
+void* buffer_pool_acquire(size_t bytes, bool zero);
+
+// Возврат буфера в пул (NULL допускается)
+void buffer_pool_release(void* buffer);
+
+// Наибольший объем хранимых буферов; 0 - не хранить (каждый буфер освобождается).
+// По умолчанию 1 ГБ, переменная окружения IMAGE_CRAFT_POOL_MB задает другой предел.
+void buffer_pool_set_limit(size_t bytes);
+
+// Освобождение всех хранимых буферов
+void buffer_pool_trim(void);
+
+void buffer_pool_get_stats(BufferPoolStats* stats);
+void buffer_pool_reset_stats(void);
+
+// Окно замера наибольшего объема выданных буферов (для статистики этапов).
+// begin начинает окно с текущего объема и возвращает пик внешнего окна;
+// end возвращает пик окна и продолжает внешнее, поэтому окна можно вкладывать.
+size_t buffer_pool_peak_begin(void);
+size_t buffer_pool_peak_end(size_t outer_peak);
+
+// Вывод статистики одной строкой
+void buffer_pool_print_stats(void);
+
+#endif // BUFFER_POOL_H
@@ -1,8 +1,135 @@
 #include "cli.h"
+#include "log.h"
+#include "pyramid.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <math.h>
+
+// Наибольший размер файла с ядром свертки
+#define CLI_KERNEL_FILE_MAX 65536
+
+// Текст ядра свертки из файла (результат освобождает вызывающий) или NULL,
+// если файла нет
+static char* cli_read_kernel_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    char* text = (char*)malloc(CLI_KERNEL_FILE_MAX + 1);
+    if (text) {
+        size_t length = fread(text, 1, CLI_KERNEL_FILE_MAX, file);
+        text[length] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+// Целое число без лишних символов
+static bool cli_parse_int(const char* text, int* value) {
+    char* end = NULL;
+    long number = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || number < INT_MIN || number > INT_MAX) {
+        return false;
+    }
+    *value = (int)number;
+    return true;
+}
+
+// Ядро свертки: строки разделяются ';', '/' или переводом строки, веса в
+// строке - запятыми или пробелами, '#' - комментарий до конца строки.
+// spec - путь к файлу с ядром или само ядро, например "1,2,1;2,4,2;1,2,1".
+// missing_file - spec не разобран как ядро и похож на путь к несуществующему файлу.
+static ConvParams* cli_parse_kernel(const char* spec, const char** error, bool* missing_file) {
+    char* file_text = cli_read_kernel_file(spec);
+    const char* p = file_text ? file_text : spec;
+    *missing_file = false;
+
+    ConvParams* kernel = (ConvParams*)malloc(sizeof(ConvParams) +
+                                             sizeof(float) * CONV_MAX_SIZE * CONV_MAX_SIZE);
+    if (!kernel) {
+        free(file_text);
+        *error = "Memory allocation failed";
+        return NULL;
+    }
+
+    kernel->width = 0;
+    kernel->height = 0;
+    int count = 0;      // весов в текущей строке
+    bool comma = false; // после запятой ожидается вес
+    *error = NULL;
+
+    while (!*error) {
+        if (*p == '#') {
+            while (*p && *p != '\n') p++;
+        }
+
+        if (*p == '\0' || *p == ';' || *p == '/' || *p == '\n') {
+            // Конец строки ядра (пустые строки пропускаются)
+            if (comma) {
+                *error = "Invalid value in convolution kernel";
+                break;
+            }
+            if (count > 0) {
+                if (kernel->height == 0) {
+                    kernel->width = count;
+                } else if (count != kernel->width) {
+                    *error = "Convolution kernel rows must have equal length";
+                    break;
+                }
+                kernel->height++;
+                count = 0;
+            }
+            if (*p == '\0') break;
+            p++;
+        } else if (*p == ',') {
+            // Пустой вес: запятая в начале строки или две запятые подряд
+            if (comma || count == 0) {
+                *error = "Invalid value in convolution kernel";
+            }
+            comma = true;
+            p++;
+        } else if (isspace((unsigned char)*p)) {
+            p++;
+        } else {
+            char* end = NULL;
+            float value = strtof(p, &end);
+            comma = false;
+            if (end == p) {
+                *error = "Invalid value in convolution kernel";
+                // Без разделителей весов аргумент скорее путь к файлу, чем ядро
+                *missing_file = !file_text && (spec[strcspn(spec, ",; \t\r\n")] == '\0' ||
+                                               strchr(spec, '\\') != NULL);
+            } else if (!isfinite(value)) {
+                *error = "Invalid value in convolution kernel";
+            } else if (count >= CONV_MAX_SIZE || kernel->height >= CONV_MAX_SIZE) {
+                *error = "Convolution kernel is too large";
+            } else {
+                kernel->weights[kernel->height * CONV_MAX_SIZE + count++] = value;
+                p = end;
+            }
+        }
+    }
+    free(file_text);
+
+    if (!*error && (kernel->height == 0 || kernel->width % 2 == 0 || kernel->height % 2 == 0)) {
+        *error = "Convolution kernel must have odd width and height";
+    }
+    if (*error) {
+        free(kernel);
+        return NULL;
+    }
+
+    // Строки записывались с шагом CONV_MAX_SIZE - сжимаем до ширины ядра
+    for (int y = 1; y < kernel->height; y++) {
+        memmove(kernel->weights + y * kernel->width, kernel->weights + y * CONV_MAX_SIZE,
+                sizeof(float) * kernel->width);
+    }
+    return kernel;
+}
 
 CLIArgs* cli_parse_args(int argc, char** argv) {
     CLIArgs* args = (CLIArgs*)calloc(1, sizeof(CLIArgs));
@@ -15,6 +142,7 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
         free(args);
         return NULL;
     }
+    args->output_bits = 24;
 
     // Если нет аргументов - показываем помощь
     if (argc < 2) {
@@ -22,6 +150,18 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
         return args;
     }
 
+    // Уровень журнала задается до разбора фильтров, чтобы -v показал и их добавление
+    for (int j = 1; j < argc; j++) {
+        if (strcmp(argv[j], "-q") == 0 || strcmp(argv[j], "--quiet") == 0) {
+            log_set_level(LOG_LEVEL_WARNING);
+        } else if (strcmp(argv[j], "-v") == 0 || strcmp(argv[j], "--verbose") == 0) {
+            log_set_level(LOG_LEVEL_DEBUG);
+        }
+    }
+
+    // Фильтры до -pyramid применяются к изображению, после - к каждому уровню
+    FilterPipeline* target = args->pipeline;
+
     // Парсинг аргументов
     int i = 1;
     while (i < argc) {
@@ -32,12 +172,33 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
             return args;
         }
 
+        // Уровень журнала уже задан
+        if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0 ||
+            strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            i++;
+            continue;
+        }
+
+        // Пакетный режим: входной путь - каталог, шаблон или список файлов
+        if (strcmp(argv[i], "-batch") == 0) {
+            args->batch = 1;
+            i++;
+            continue;
+        }
+
+        // Обзор заголовков: нужен только входной путь
+        if (strcmp(argv[i], "--info") == 0) {
+            args->info = 1;
+            i++;
+            continue;
+        }
+
         // Первый аргумент - входной файл
         if (!args->input_file) {
             args->input_file = _strdup(argv[i]);
         }
         // Второй аргумент - выходной файл
-        else if (!args->output_file) {
+        else if (!args->output_file && !args->info) {
             args->output_file = _strdup(argv[i]);
         }
         // Фильтры
@@ -58,6 +219,8 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
 
                 params->width = atoi(argv[i + 1]);
                 params->height = atoi(argv[i + 2]);
+                params->x = 0;
+                params->y = 0;
 
                 if (params->width <= 0 || params->height <= 0) {
                     free(params);
@@ -66,17 +229,109 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
                     return args;
                 }
 
-                pipeline_add_filter(args->pipeline, filter_crop, params, "crop");
+                // Необязательное смещение левого верхнего угла
+                if (i + 4 < argc && cli_parse_int(argv[i + 3], &params->x) &&
+                    cli_parse_int(argv[i + 4], &params->y)) {
+                    if (params->x < 0 || params->y < 0) {
+                        free(params);
+                        args->error = 1;
+                        args->error_message = "Crop offset must not be negative";
+                        return args;
+                    }
+                    i += 2;
+                }
+
+                pipeline_add_filter(target, filter_crop, params, "crop");
+                i += 2;
+            }
+            else if (strcmp(argv[i], "-resize") == 0) {
+                if (i + 2 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-resize requires width and height";
+                    return args;
+                }
+
+                ResizeParams* params = (ResizeParams*)malloc(sizeof(ResizeParams));
+                if (!params) {
+                    args->error = 1;
+                    args->error_message = "Memory allocation failed";
+                    return args;
+                }
+
+                params->width = atoi(argv[i + 1]);
+                params->height = atoi(argv[i + 2]);
+                params->method = RESAMPLE_BICUBIC;
+
+                if (params->width <= 0 || params->height <= 0) {
+                    free(params);
+                    args->error = 1;
+                    args->error_message = "Resize dimensions must be positive";
+                    return args;
+                }
+
+                // Необязательный способ: nearest, bilinear, bicubic, lanczos3
+                if (i + 3 < argc && resample_method_parse(argv[i + 3], &params->method)) {
+                    i += 1;
+                }
+
+                pipeline_add_filter(target, filter_resize, params, "resize");
+                i += 2;
+            }
+            else if (strcmp(argv[i], "-pyramid") == 0) {
+                if (i + 2 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-pyramid requires level count and file name pattern";
+                    return args;
+                }
+
+                if (args->level_pipeline) {
+                    args->error = 1;
+                    args->error_message = "-pyramid can be used only once";
+                    return args;
+                }
+
+                args->pyramid_levels = atoi(argv[i + 1]);
+                if (args->pyramid_levels <= 0 || args->pyramid_levels > PYRAMID_MAX_LEVELS) {
+                    args->error = 1;
+                    snprintf(args->error_buffer, sizeof(args->error_buffer),
+                             "Pyramid level count must be between 1 and %d", PYRAMID_MAX_LEVELS);
+                    args->error_message = args->error_buffer;
+                    return args;
+                }
+
+                if (!pyramid_pattern_valid(argv[i + 2])) {
+                    args->error = 1;
+                    args->error_message = "Pyramid file name pattern must contain one %d (for example out_%d.bmp)";
+                    return args;
+                }
+
+                args->pyramid_pattern = _strdup(argv[i + 2]);
+                args->pyramid_method = RESAMPLE_BICUBIC;
+                args->level_pipeline = pipeline_create();
+                if (!args->pyramid_pattern || !args->level_pipeline) {
+                    args->error = 1;
+                    args->error_message = "Memory allocation failed";
+                    return args;
+                }
+                target = args->level_pipeline;
+
+                // Необязательный способ уменьшения, как у -resize
+                if (i + 3 < argc && resample_method_parse(argv[i + 3], &args->pyramid_method)) {
+                    i += 1;
+                }
                 i += 2;
             }
             else if (strcmp(argv[i], "-gs") == 0) {
-                pipeline_add_filter(args->pipeline, filter_grayscale, NULL, "grayscale");
+                pipeline_add_filter(target, filter_grayscale, NULL, "grayscale");
             }
             else if (strcmp(argv[i], "-neg") == 0) {
-                pipeline_add_filter(args->pipeline, filter_negative, NULL, "negative");
+                pipeline_add_filter(target, filter_negative, NULL, "negative");
             }
             else if (strcmp(argv[i], "-sharp") == 0) {
-                pipeline_add_filter(args->pipeline, filter_sharpening, NULL, "sharpening");
+                pipeline_add_filter(target, filter_sharpening, NULL, "sharpening");
+            }
+            else if (strcmp(argv[i], "-emboss") == 0) {
+                pipeline_add_filter(target, filter_emboss, NULL, "emboss");
             }
             else if (strcmp(argv[i], "-edge") == 0) {
                 if (i + 1 >= argc) {
@@ -101,7 +356,7 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
                     return args;
                 }
 
-                pipeline_add_filter(args->pipeline, filter_edge_detection, params, "edge_detection");
+                pipeline_add_filter(target, filter_edge_detection, params, "edge_detection");
                 i += 1;
             }
             else if (strcmp(argv[i], "-med") == 0) {
@@ -127,7 +382,7 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
                     return args;
                 }
 
-                pipeline_add_filter(args->pipeline, filter_median, params, "median");
+                pipeline_add_filter(target, filter_median, params, "median");
                 i += 1;
             }
             else if (strcmp(argv[i], "-blur") == 0) {
@@ -153,11 +408,59 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
                     return args;
                 }
 
-                pipeline_add_filter(args->pipeline, filter_gaussian_blur, params, "gaussian_blur");
+                pipeline_add_filter(target, filter_gaussian_blur, params, "gaussian_blur");
+                i += 1;
+            }
+            else if (strcmp(argv[i], "-box") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-box requires radius";
+                    return args;
+                }
+
+                BoxBlurParams* params = (BoxBlurParams*)malloc(sizeof(BoxBlurParams));
+                if (!params) {
+                    args->error = 1;
+                    args->error_message = "Memory allocation failed";
+                    return args;
+                }
+
+                params->radius = atoi(argv[i + 1]);
+
+                if (params->radius <= 0) {
+                    free(params);
+                    args->error = 1;
+                    args->error_message = "Box blur radius must be positive";
+                    return args;
+                }
+
+                pipeline_add_filter(target, filter_box_blur, params, "box_blur");
+                i += 1;
+            }
+            else if (strcmp(argv[i], "-conv") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-conv requires kernel or kernel file";
+                    return args;
+                }
+
+                bool missing_file = false;
+                ConvParams* params = cli_parse_kernel(argv[i + 1], &args->error_message, &missing_file);
+                if (!params) {
+                    args->error = 1;
+                    if (missing_file) {
+                        snprintf(args->error_buffer, sizeof(args->error_buffer),
+                                 "Cannot open convolution kernel file '%s'", argv[i + 1]);
+                        args->error_message = args->error_buffer;
+                    }
+                    return args;
+                }
+
+                pipeline_add_filter(target, filter_convolve, params, "convolve");
                 i += 1;
             }
             else if (strcmp(argv[i], "-sepia") == 0) {
-                pipeline_add_filter(args->pipeline, filter_sepia, NULL, "sepia");
+                pipeline_add_filter(target, filter_sepia, NULL, "sepia");
             }
             else if (strcmp(argv[i], "-vignette") == 0) {
                 VignetteParams* params = (VignetteParams*)malloc(sizeof(VignetteParams));
@@ -176,29 +479,102 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
                     i += 1;
                 }
 
-                pipeline_add_filter(args->pipeline, filter_vignette, params, "vignette");
+                pipeline_add_filter(target, filter_vignette, params, "vignette");
+            }
+            else if (strcmp(argv[i], "-threads") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-threads requires thread count";
+                    return args;
+                }
+
+                char* end = NULL;
+                long threads = strtol(argv[i + 1], &end, 10);
+
+                if (end == argv[i + 1] || *end != '\0' || threads < 0 || threads > 1024) {
+                    args->error = 1;
+                    args->error_message = "Thread count must be between 0 and 1024";
+                    return args;
+                }
+
+                pipeline_set_threads(args->pipeline, (int)threads);
+                i += 1;
+            }
+            else if (strcmp(argv[i], "-format") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-format requires pixel format name";
+                    return args;
+                }
+
+                if (!pixel_format_parse(argv[i + 1], &args->format)) {
+                    args->error = 1;
+                    args->error_message = "Pixel format must be f32, u8, u16, planar8 or planar16";
+                    return args;
+                }
+                i += 1;
+            }
+            else if (strcmp(argv[i], "-bpp") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "-bpp requires bit depth";
+                    return args;
+                }
+
+                if (strcmp(argv[i + 1], "24") != 0 && strcmp(argv[i + 1], "32") != 0) {
+                    args->error = 1;
+                    args->error_message = "Output bit depth must be 24 or 32";
+                    return args;
+                }
+                args->output_bits = atoi(argv[i + 1]);
+                i += 1;
+            }
+            else if (strcmp(argv[i], "-stream") == 0) {
+                args->stream = 1;
+            }
+            else if (strcmp(argv[i], "--stats") == 0) {
+                if (i + 1 >= argc) {
+                    args->error = 1;
+                    args->error_message = "--stats requires report format";
+                    return args;
+                }
+
+                if (!stats_format_parse(argv[i + 1], &args->stats)) {
+                    args->error = 1;
+                    args->error_message = "Stats format must be text or json";
+                    return args;
+                }
+                i += 1;
             }
             else {
                 args->error = 1;
-                args->error_message = malloc(100);
-                if (args->error_message) {
-                    sprintf(args->error_message, "Unknown filter: %s", argv[i]);
-                }
+                snprintf(args->error_buffer, sizeof(args->error_buffer), "Unknown filter: %s", argv[i]);
+                args->error_message = args->error_buffer;
                 return args;
             }
         }
         else {
             args->error = 1;
-            args->error_message = malloc(100);
-            if (args->error_message) {
-                sprintf(args->error_message, "Unexpected argument: %s", argv[i]);
-            }
+            snprintf(args->error_buffer, sizeof(args->error_buffer), "Unexpected argument: %s", argv[i]);
+            args->error_message = args->error_buffer;
             return args;
         }
 
         i++;
     }
 
+    // В режиме обзора выходного файла и фильтров нет
+    if (args->info) {
+        if (!args->input_file) {
+            args->error = 1;
+            args->error_message = "--info requires input directory, pattern or list";
+        } else if (args->output_file || args->batch || args->pipeline->count > 0 || args->level_pipeline) {
+            args->error = 1;
+            args->error_message = "--info accepts only input path, -threads and --stats";
+        }
+        return args;
+    }
+
     // Проверка обязательных аргументов
     if (!args->input_file || !args->output_file) {
         args->error = 1;
@@ -206,6 +582,20 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
         return args;
     }
 
+    // Фильтры уровней работают с тем же числом потоков
+    if (args->level_pipeline) {
+        pipeline_set_threads(args->level_pipeline, args->pipeline->thread_count);
+    }
+
+    // В пакетном режиме вход - каталог, шаблон или список, выход - каталог
+    if (args->batch) {
+        if (args->level_pipeline) {
+            args->error = 1;
+            args->error_message = "-pyramid cannot be used with -batch";
+        }
+        return args;
+    }
+
     // Проверка расширений файлов
     if (strstr(args->input_file, ".bmp") == NULL &&
         strstr(args->input_file, ".BMP") == NULL) {
@@ -221,6 +611,14 @@ CLIArgs* cli_parse_args(int argc, char** argv) {
         return args;
     }
 
+    if (args->pyramid_pattern &&
+        strstr(args->pyramid_pattern, ".bmp") == NULL &&
+        strstr(args->pyramid_pattern, ".BMP") == NULL) {
+        args->error = 1;
+        args->error_message = "Pyramid file name pattern must have .bmp extension";
+        return args;
+    }
+
     return args;
 }
 
@@ -232,7 +630,8 @@ void cli_free_args(CLIArgs* args) {
     if (args->input_file) free(args->input_file);
     if (args->output_file) free(args->output_file);
     if (args->pipeline) pipeline_destroy(args->pipeline);
-    if (args->error_message) free(args->error_message);
+    if (args->level_pipeline) pipeline_destroy(args->level_pipeline);
+    if (args->pyramid_pattern) free(args->pyramid_pattern);
     free(args);
 }
 
@@ -244,25 +643,66 @@ void cli_print_help(void) {
     printf("\n");
     printf("Использование:\n");
     printf("  image_craft.exe <input.bmp> <output.bmp> [фильтры...]\n");
+    printf("  image_craft.exe -batch <вход> <выходной_каталог> [фильтры...]\n");
+    printf("    <вход> - каталог (все .bmp), шаблон (photos\\*.bmp) или файл-список\n");
+    printf("    (по одному пути в строке); файлы обрабатываются параллельно\n");
+    printf("  image_craft.exe --info <вход> [-threads N] [--stats json]\n");
+    printf("    размеры, разрядность и оценка стоимости обработки каждого BMP (каталог\n");
+    printf("    обходится вместе с подкаталогами, заголовки читаются параллельно)\n");
     printf("\n");
     printf("Фильтры:\n");
-    printf("  -crop <ширина> <высота>   Обрезать изображение\n");
+    printf("  -crop <ширина> <высота> [x y]\n");
+    printf("                            Обрезать изображение (от угла x, y; по умолчанию\n");
+    printf("                            0 0); если перед обрезкой нет фильтров, зависящих\n");
+    printf("                            от положения, читается только нужная часть файла\n");
+    printf("  -resize <ширина> <высота> [способ]\n");
+    printf("                            Изменить размер: nearest, bilinear, bicubic (по\n");
+    printf("                            умолчанию), lanczos3\n");
     printf("  -gs                       Градации серого\n");
     printf("  -neg                      Негатив\n");
     printf("  -sharp                    Повышение резкости\n");
+    printf("  -emboss                   Тиснение\n");
     printf("  -edge <порог>             Обнаружение границ (0-1)\n");
     printf("  -med <размер_окна>        Медианный фильтр (нечетный)\n");
-    printf("  -blur <сигма>             Гауссово размытие\n");
+    printf("  -blur <сигма>             Гауссово размытие (от сигмы 20 - быстрое приближение)\n");
+    printf("  -box <радиус>             Размытие квадратным окном (любой радиус за одно время)\n");
+    printf("  -conv <ядро|файл>         Свертка ядром нечетного размера до %dx%d, строки\n", CONV_MAX_SIZE, CONV_MAX_SIZE);
+    printf("                            через ';', веса через ',' (\"1,2,1;2,4,2;1,2,1\")\n");
+    printf("                            или из файла; результат делится на сумму весов;\n");
+    printf("                            большие ядра считаются через БПФ\n");
     printf("  -sepia                    Эффект сепии\n");
     printf("  -vignette [интенсивность] Виньетирование (0-1, по умолчанию 0.8)\n");
     printf("\n");
+    printf("Параметры:\n");
+    printf("  -threads <N>              Число потоков (0 - по числу ядер, 1 - без потоков);\n");
+    printf("                            в пакетном режиме - число одновременных файлов\n");
+    printf("  -format <формат>          Хранение пикселей: f32 (по умолчанию), u8, u16,\n");
+    printf("                            planar8, planar16\n");
+    printf("  -bpp <24|32>              Разрядность выходных BMP (по умолчанию 24);\n");
+    printf("                            строки 32-битных файлов не требуют выравнивания\n");
+    printf("  -stream                   Потоковая обработка полосами строк (для\n");
+    printf("                            изображений больше оперативной памяти)\n");
+    printf("  --stats <text|json>       Время, ЦП, Мп/с и пик памяти чтения, каждого\n");
+    printf("                            фильтра и записи\n");
+    printf("  -pyramid <N> <шаблон> [способ]\n");
+    printf("                            Записать еще N уровней, каждый вдвое меньше\n");
+    printf("                            предыдущего, в файлы по шаблону (out_%%d.bmp,\n");
+    printf("                            уровни 1..N); фильтры после -pyramid применяются\n");
+    printf("                            к каждому уровню и к output.bmp\n");
+    printf("  -q, --quiet               Выводить только ошибки и предупреждения\n");
+    printf("  -v, --verbose             Подробный вывод (в том числе разбор фильтров)\n");
+    printf("\n");
     printf("Примеры:\n");
     printf("  image_craft.exe input.bmp output.bmp -gs\n");
     printf("  image_craft.exe input.bmp output.bmp -crop 800 600 -gs -blur 0.5\n");
     printf("  image_craft.exe input.bmp output.bmp -edge 0.1 -neg\n");
     printf("  image_craft.exe input.bmp output.bmp -sepia -vignette 0.7\n");
+    printf("  image_craft.exe mosaic.bmp tile.bmp -crop 1000 1000 5000 3000 -sharp\n");
+    printf("  image_craft.exe input.bmp thumb.bmp -resize 320 240 lanczos3\n");
+    printf("  image_craft.exe input.bmp full.bmp -blur 0.8 -pyramid 5 mip_%%d.bmp -sharp\n");
     printf("\n");
-    printf("Формат изображений: 24-битный BMP без сжатия\n");
+    printf("Формат изображений: BMP 1, 4, 8 бит (палитра, RLE8/RLE4), 16, 24 и 32 бита\n");
+    printf("(в том числе BI_BITFIELDS), заголовки BITMAPINFOHEADER, V4 и V5\n");
     printf("\n");
 }
 
@@ -8,9 +8,20 @@ typedef struct {
     char* input_file;
     char* output_file;
     FilterPipeline* pipeline;
+    PixelFormat format;   // формат хранения пикселей (по умолчанию RGB_F32)
+    int output_bits;      // разрядность выходных BMP: 24 (по умолчанию) или 32
+    int stream;           // потоковая обработка полосами строк
+    int batch;            // пакетная обработка: input_file - источник, output_file - каталог
+    int info;             // --info: обзор заголовков файлов input_file без обработки
+    StatsFormat stats;    // отчет о замерах этапов (--stats)
+    int pyramid_levels;   // -pyramid: число уменьшенных уровней (0 - без пирамиды)
+    char* pyramid_pattern;            // шаблон имен файлов уровней
+    ResampleMethod pyramid_method;
+    FilterPipeline* level_pipeline;   // фильтры после -pyramid - для каждого уровня
     int show_help;
     int error;
-    char* error_message;
+    const char* error_message;
+    char error_buffer[128];   // текст ошибки с подставленным аргументом
 } CLIArgs;
 
 // Парсинг аргументов командной строки
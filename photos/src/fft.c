@@ -0,0 +1,511 @@
+#include "fft.h"
+#include "buffer_pool.h"
+#include "simd.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+#define cache_lock_acquire()  AcquireSRWLockExclusive(&cache_lock)
+#define cache_lock_release()  ReleaseSRWLockExclusive(&cache_lock)
+#else
+#include <pthread.h>
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define cache_lock_acquire()  pthread_mutex_lock(&cache_lock)
+#define cache_lock_release()  pthread_mutex_unlock(&cache_lock)
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct FftPlan {
+    int n;
+    FftComplex* twiddles;   // exp(-2πik/n), k < n/2
+    int* reversed;          // перестановка с обращением битов
+    void (*butterfly)(float*, float*, float, float, int);  // векторное ядро (simd.h)
+};
+
+FftPlan* fft_plan_create(int n) {
+    if (n < 1 || (n & (n - 1)) != 0) {
+        log_error("FFT size %d is not a power of two\n", n);
+        return NULL;
+    }
+
+    FftPlan* plan = (FftPlan*)malloc(sizeof(FftPlan));
+    if (!plan) {
+        return NULL;
+    }
+
+    plan->n = n;
+    plan->butterfly = simd_kernels()->butterfly_rows;
+    plan->twiddles = (FftComplex*)malloc(sizeof(FftComplex) * (n / 2 + 1));
+    plan->reversed = (int*)malloc(sizeof(int) * n);
+    if (!plan->twiddles || !plan->reversed) {
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    // Повороты считаются в double, чтобы ошибка не копилась по углу
+    for (int k = 0; k < n / 2; k++) {
+        double angle = -2.0 * M_PI * k / n;
+        plan->twiddles[k].re = (float)cos(angle);
+        plan->twiddles[k].im = (float)sin(angle);
+    }
+
+    int bits = 0;
+    while ((1 << bits) < n) bits++;
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->reversed[i] = r;
+    }
+    return plan;
+}
+
+void fft_plan_destroy(FftPlan* plan) {
+    if (!plan) {
+        return;
+    }
+    free(plan->twiddles);
+    free(plan->reversed);
+    free(plan);
+}
+
+// Итеративное БПФ по основанию 2 с прореживанием по времени
+void fft_transform(const FftPlan* plan, FftComplex* data, bool inverse) {
+    int n = plan->n;
+
+    for (int i = 0; i < n; i++) {
+        int j = plan->reversed[i];
+        if (i < j) {
+            FftComplex t = data[i];
+            data[i] = data[j];
+            data[j] = t;
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (int size = 2; size <= n; size *= 2) {
+        int half = size / 2;
+        int step = n / size;
+        for (int start = 0; start < n; start += size) {
+            FftComplex* a = data + start;
+            FftComplex* b = data + start + half;
+            for (int k = 0; k < half; k++) {
+                FftComplex w = plan->twiddles[k * step];
+                float wi = w.im * sign;
+                float re = b[k].re * w.re - b[k].im * wi;
+                float im = b[k].re * wi + b[k].im * w.re;
+                b[k].re = a[k].re - re;
+                b[k].im = a[k].im - im;
+                a[k].re += re;
+                a[k].im += im;
+            }
+        }
+    }
+}
+
+// Преобразование всех столбцов матрицы rows x columns (plan длины rows):
+// бабочки применяются сразу к парам строк, векторное ядро идет вдоль строки
+static void fft_columns(const FftPlan* plan, FftComplex* data, int columns, bool inverse) {
+    int n = plan->n;
+    size_t stride = (size_t)columns;
+
+    for (int i = 0; i < n; i++) {
+        int j = plan->reversed[i];
+        if (i < j) {
+            FftComplex* a = data + (size_t)i * stride;
+            FftComplex* b = data + (size_t)j * stride;
+            for (int c = 0; c < columns; c++) {
+                FftComplex t = a[c];
+                a[c] = b[c];
+                b[c] = t;
+            }
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (int size = 2; size <= n; size *= 2) {
+        int half = size / 2;
+        int step = n / size;
+        for (int start = 0; start < n; start += size) {
+            for (int k = 0; k < half; k++) {
+                FftComplex w = plan->twiddles[k * step];
+                plan->butterfly((float*)(data + (size_t)(start + k) * stride),
+                                (float*)(data + (size_t)(start + k + half) * stride),
+                                w.re, w.im * sign, columns);
+            }
+        }
+    }
+}
+
+// Транспонирование блоками 16x16: строки и столбцы блока остаются в кэше
+static void fft_transpose(const FftComplex* in, FftComplex* out, int rows, int columns) {
+    for (int r0 = 0; r0 < rows; r0 += 16) {
+        for (int c0 = 0; c0 < columns; c0 += 16) {
+            int r1 = r0 + 16 < rows ? r0 + 16 : rows;
+            int c1 = c0 + 16 < columns ? c0 + 16 : columns;
+            for (int r = r0; r < r1; r++) {
+                for (int c = c0; c < c1; c++) {
+                    out[(size_t)c * rows + r] = in[(size_t)r * columns + c];
+                }
+            }
+        }
+    }
+}
+
+void fft_2d(FftComplex* in, FftComplex* out, int rows, int columns,
+            const FftPlan* row_plan, const FftPlan* column_plan, bool inverse) {
+    // row_plan - длины columns (вдоль строки), column_plan - длины rows.
+    // Столбцы in, затем после транспонирования - бывшие строки.
+    fft_columns(column_plan, in, columns, inverse);
+    fft_transpose(in, out, rows, columns);
+    fft_columns(row_plan, out, rows, inverse);
+}
+
+static int fft_next_power(int n) {
+    int p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+int fft_tile_size(int kernel_size, int frame_size) {
+    // Плитка в несколько раз больше ядра: доля отбрасываемых краев мала
+    int tile = fft_next_power(4 * (kernel_size - 1));
+    if (tile < 32) tile = 32;
+    if (tile > FFT_MAX_TILE) tile = FFT_MAX_TILE;
+    if (tile < kernel_size) tile = fft_next_power(2 * kernel_size);
+
+    // Маленький кадр целиком помещается в меньшую плитку
+    int whole = fft_next_power(frame_size + kernel_size - 1);
+    return whole < tile ? whole : tile;
+}
+
+// Время одной бабочки с учетом разбора плиток и умножения спектров, нс
+// (по bench/bench.c fft)
+#define FFT_BUTTERFLY_NS 1.6
+
+double fft_convolution_cost(int kernel_width, int kernel_height, int frame_width, int frame_height) {
+    int tw = fft_tile_size(kernel_width, frame_width);
+    int th = fft_tile_size(kernel_height, frame_height);
+    int bw = tw - kernel_width + 1;
+    int bh = th - kernel_height + 1;
+    if (bw > frame_width) bw = frame_width;
+    if (bh > frame_height) bh = frame_height;
+
+    double log_size = log2((double)tw) + log2((double)th);
+    // Три двумерных преобразования на плитку (по шесть прямых и обратных на пару)
+    double butterflies = 3.0 * tw * th / 2.0 * log_size;
+    return butterflies * FFT_BUTTERFLY_NS / ((double)bw * bh);
+}
+
+// ---------------------------------------------------------------------------
+// Кэш спектров ядер
+// ---------------------------------------------------------------------------
+
+#define FFT_CACHE_ENTRIES 8
+
+typedef struct {
+    int tile_width;
+    int tile_height;
+    int kernel_width;
+    int kernel_height;
+    float* kernel;            // копия весов для сравнения
+    FftPlan* row_plan;        // длины tile_width
+    FftPlan* column_plan;     // длины tile_height
+    FftComplex* spectrum;     // tile_width строк по tile_height (транспонирован)
+    int refs;                 // число пользователей, запись с refs > 0 не вытесняется
+    unsigned long long used;  // для вытеснения давно не использованных
+} FftSpectrum;
+
+static FftSpectrum* fft_cache[FFT_CACHE_ENTRIES];
+static unsigned long long fft_cache_clock;
+
+static void fft_spectrum_destroy(FftSpectrum* entry) {
+    if (!entry) {
+        return;
+    }
+    free(entry->kernel);
+    fft_plan_destroy(entry->row_plan);
+    fft_plan_destroy(entry->column_plan);
+    buffer_pool_release(entry->spectrum);
+    free(entry);
+}
+
+static FftSpectrum* fft_spectrum_create(const float* kernel, int kernel_width, int kernel_height,
+                                        int tile_width, int tile_height) {
+    size_t tile = (size_t)tile_width * tile_height;
+    FftSpectrum* entry = (FftSpectrum*)calloc(1, sizeof(FftSpectrum));
+    FftComplex* grid = (FftComplex*)buffer_pool_acquire(sizeof(FftComplex) * tile, true);
+    if (!entry || !grid) {
+        free(entry);
+        buffer_pool_release(grid);
+        return NULL;
+    }
+
+    entry->tile_width = tile_width;
+    entry->tile_height = tile_height;
+    entry->kernel_width = kernel_width;
+    entry->kernel_height = kernel_height;
+    entry->kernel = (float*)malloc(sizeof(float) * kernel_width * kernel_height);
+    entry->row_plan = fft_plan_create(tile_width);
+    entry->column_plan = fft_plan_create(tile_height);
+    entry->spectrum = (FftComplex*)buffer_pool_acquire(sizeof(FftComplex) * tile, false);
+    if (!entry->kernel || !entry->row_plan || !entry->column_plan || !entry->spectrum) {
+        buffer_pool_release(grid);
+        fft_spectrum_destroy(entry);
+        return NULL;
+    }
+    memcpy(entry->kernel, kernel, sizeof(float) * kernel_width * kernel_height);
+
+    // Ядро записывается отраженным относительно начала координат: круговая
+    // свертка тогда дает ту же сумму K[ky][kx] * src[y + ky - ry][x + kx - rx],
+    // что и прямой путь. Нормировка обратного преобразования входит в спектр.
+    int rx = kernel_width / 2;
+    int ry = kernel_height / 2;
+    float scale = 1.0f / (float)tile;
+    for (int ky = 0; ky < kernel_height; ky++) {
+        for (int kx = 0; kx < kernel_width; kx++) {
+            int y = ((ry - ky) % tile_height + tile_height) % tile_height;
+            int x = ((rx - kx) % tile_width + tile_width) % tile_width;
+            grid[(size_t)y * tile_width + x].re += kernel[ky * kernel_width + kx] * scale;
+        }
+    }
+
+    fft_2d(grid, entry->spectrum, tile_height, tile_width, entry->row_plan, entry->column_plan, false);
+    buffer_pool_release(grid);
+    return entry;
+}
+
+static bool fft_spectrum_matches(const FftSpectrum* entry, const float* kernel, int kernel_width,
+                                 int kernel_height, int tile_width, int tile_height) {
+    return entry->tile_width == tile_width && entry->tile_height == tile_height &&
+           entry->kernel_width == kernel_width && entry->kernel_height == kernel_height &&
+           memcmp(entry->kernel, kernel, sizeof(float) * kernel_width * kernel_height) == 0;
+}
+
+// Спектр ядра из кэша или новый (refs увеличен, вернуть fft_spectrum_release)
+static FftSpectrum* fft_spectrum_acquire(const float* kernel, int kernel_width, int kernel_height,
+                                         int tile_width, int tile_height) {
+    cache_lock_acquire();
+    for (int i = 0; i < FFT_CACHE_ENTRIES; i++) {
+        FftSpectrum* entry = fft_cache[i];
+        if (entry && fft_spectrum_matches(entry, kernel, kernel_width, kernel_height,
+                                          tile_width, tile_height)) {
+            entry->refs++;
+            entry->used = ++fft_cache_clock;
+            cache_lock_release();
+            return entry;
+        }
+    }
+    cache_lock_release();
+
+    // Спектр считается без блокировки: другие потоки могут посчитать тот же
+    FftSpectrum* created = fft_spectrum_create(kernel, kernel_width, kernel_height,
+                                               tile_width, tile_height);
+    if (!created) {
+        return NULL;
+    }
+    created->refs = 1;
+
+    FftSpectrum* evicted = NULL;
+    cache_lock_acquire();
+    int slot = -1;
+    for (int i = 0; i < FFT_CACHE_ENTRIES; i++) {
+        FftSpectrum* entry = fft_cache[i];
+        if (entry && fft_spectrum_matches(entry, kernel, kernel_width, kernel_height,
+                                          tile_width, tile_height)) {
+            // Уже добавлен другим потоком
+            entry->refs++;
+            entry->used = ++fft_cache_clock;
+            cache_lock_release();
+            fft_spectrum_destroy(created);
+            return entry;
+        }
+        if (!entry) {
+            if (slot < 0 || fft_cache[slot]) slot = i;
+        } else if (entry->refs == 0 && (slot < 0 || (fft_cache[slot] && entry->used < fft_cache[slot]->used))) {
+            slot = i;
+        }
+    }
+
+    if (slot >= 0) {
+        evicted = fft_cache[slot];
+        fft_cache[slot] = created;
+    }
+    created->used = ++fft_cache_clock;
+    cache_lock_release();
+
+    fft_spectrum_destroy(evicted);
+    return created;
+}
+
+static void fft_spectrum_release(FftSpectrum* entry) {
+    bool cached = false;
+
+    cache_lock_acquire();
+    entry->refs--;
+    for (int i = 0; i < FFT_CACHE_ENTRIES; i++) {
+        if (fft_cache[i] == entry) {
+            cached = true;
+        }
+    }
+    cache_lock_release();
+
+    // Не попавший в кэш спектр (все записи были заняты) освобождает владелец
+    if (!cached) {
+        fft_spectrum_destroy(entry);
+    }
+}
+
+void fft_cache_clear(void) {
+    FftSpectrum* entries[FFT_CACHE_ENTRIES];
+    int count = 0;
+
+    cache_lock_acquire();
+    for (int i = 0; i < FFT_CACHE_ENTRIES; i++) {
+        if (fft_cache[i] && fft_cache[i]->refs == 0) {
+            entries[count++] = fft_cache[i];
+            fft_cache[i] = NULL;
+        }
+    }
+    cache_lock_release();
+
+    for (int i = 0; i < count; i++) {
+        fft_spectrum_destroy(entries[i]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Свертка плитками
+// ---------------------------------------------------------------------------
+
+static float fft_clamp(float value) {
+    return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+// Пара соседних по горизонтали плиток с началами (tx, ty) и (tx + bw, ty):
+// три действительных канала каждой укладываются в три комплексных
+// преобразования - r + ig первой, r + ig второй и b первой + ib второй
+#define FFT_TILE_CHANNELS 3
+
+static void fft_convolve_tiles(const Image* src, Image* dst, int y0, int y1, int tx, int ty,
+                               const FftSpectrum* spectrum, FftComplex* const* channels,
+                               FftComplex* temp) {
+    int tw = spectrum->tile_width;
+    int th = spectrum->tile_height;
+    int rx = spectrum->kernel_width / 2;
+    int ry = spectrum->kernel_height / 2;
+    int bw = tw - 2 * rx;
+    int bh = th - 2 * ry;
+    int width = src->width;
+
+    // Входная область плиток с повтором краев
+    for (int i = 0; i < th; i++) {
+        int sy = ty - ry + i - src->frame_y;
+        if (sy < 0) sy = 0;
+        if (sy >= src->height) sy = src->height - 1;
+        const Color* row = src->data + (size_t)sy * width;
+
+        FftComplex* blue = channels[2] + (size_t)i * tw;
+        for (int t = 0; t < 2; t++) {
+            FftComplex* rg = channels[t] + (size_t)i * tw;
+            float* b = (float*)blue + t;
+            for (int j = 0; j < tw; j++) {
+                int sx = tx + t * bw - rx + j;
+                if (sx < 0) sx = 0;
+                if (sx >= width) sx = width - 1;
+                rg[j].re = row[sx].r;
+                rg[j].im = row[sx].g;
+                b[2 * j] = row[sx].b;
+            }
+        }
+    }
+
+    // Произведение спектров; ядро действительное, поэтому каналы в
+    // действительной и мнимой частях не смешиваются
+    size_t count = (size_t)tw * th;
+    for (int c = 0; c < FFT_TILE_CHANNELS; c++) {
+        fft_2d(channels[c], temp, th, tw, spectrum->row_plan, spectrum->column_plan, false);
+        for (size_t k = 0; k < count; k++) {
+            FftComplex x = temp[k];
+            FftComplex h = spectrum->spectrum[k];
+            temp[k].re = x.re * h.re - x.im * h.im;
+            temp[k].im = x.re * h.im + x.im * h.re;
+        }
+        fft_2d(temp, channels[c], tw, th, spectrum->column_plan, spectrum->row_plan, true);
+    }
+
+    // Верные значения - внутри плитки на радиус ядра от краев
+    for (int i = 0; i < bh; i++) {
+        int y = ty + i - dst->frame_y;
+        if (y < y0 || y >= y1) {
+            continue;
+        }
+
+        Color* out = dst->data + (size_t)y * width;
+        const float* blue = (const float*)(channels[2] + (size_t)(i + ry) * tw + rx);
+        for (int t = 0; t < 2; t++) {
+            int x0 = tx + t * bw;
+            const FftComplex* rg = channels[t] + (size_t)(i + ry) * tw + rx;
+            for (int j = 0; j < bw && x0 + j < width; j++) {
+                out[x0 + j].r = fft_clamp(rg[j].re);
+                out[x0 + j].g = fft_clamp(rg[j].im);
+                out[x0 + j].b = fft_clamp(blue[2 * j + t]);
+            }
+        }
+    }
+}
+
+bool fft_convolution_rows(const Image* src, Image* dst, int y0, int y1,
+                          const float* kernel, int kernel_width, int kernel_height) {
+    int tw = fft_tile_size(kernel_width, src->width);
+    int th = fft_tile_size(kernel_height, src->frame_height);
+
+    FftSpectrum* spectrum = fft_spectrum_acquire(kernel, kernel_width, kernel_height, tw, th);
+    size_t tile = (size_t)tw * th;
+    FftComplex* channels[FFT_TILE_CHANNELS];
+    bool allocated = spectrum != NULL;
+    for (int c = 0; c < FFT_TILE_CHANNELS; c++) {
+        channels[c] = (FftComplex*)buffer_pool_acquire(sizeof(FftComplex) * tile, false);
+        allocated = allocated && channels[c];
+    }
+    FftComplex* temp = (FftComplex*)buffer_pool_acquire(sizeof(FftComplex) * tile, false);
+    if (!allocated || !temp) {
+        log_error("Memory allocation failed for FFT convolution\n");
+        if (spectrum) fft_spectrum_release(spectrum);
+        for (int c = 0; c < FFT_TILE_CHANNELS; c++) {
+            buffer_pool_release(channels[c]);
+        }
+        buffer_pool_release(temp);
+        return false;
+    }
+
+    // Сетка плиток привязана к кадру: каждый пиксель считается одной и той же
+    // плиткой при любом разбиении на полосы
+    int bw = tw - kernel_width + 1;
+    int bh = th - kernel_height + 1;
+    int frame_y0 = y0 + src->frame_y;
+    int frame_y1 = y1 + src->frame_y;
+    for (int ty = frame_y0 / bh * bh; ty < frame_y1; ty += bh) {
+        for (int tx = 0; tx < src->width; tx += 2 * bw) {
+            fft_convolve_tiles(src, dst, y0, y1, tx, ty, spectrum, channels, temp);
+        }
+    }
+
+    buffer_pool_release(temp);
+    for (int c = 0; c < FFT_TILE_CHANNELS; c++) {
+        buffer_pool_release(channels[c]);
+    }
+    fft_spectrum_release(spectrum);
+    return true;
+}
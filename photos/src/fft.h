@@ -0,0 +1,54 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include "image.h"
+#include <stdbool.h>
+
+// Быстрое преобразование Фурье и свертка через него для больших ядер.
+// Свертка считается плитками (перекрытие с отбрасыванием краев): память
+// ограничена размером плитки и не зависит от размера изображения.
+
+typedef struct {
+    float re;
+    float im;
+} FftComplex;
+
+// План преобразования длины n (степень двойки): таблицы поворотов и перестановки
+typedef struct FftPlan FftPlan;
+
+FftPlan* fft_plan_create(int n);
+void fft_plan_destroy(FftPlan* plan);
+
+// Преобразование на месте без нормировки (обратное - с сопряженными поворотами)
+void fft_transform(const FftPlan* plan, FftComplex* data, bool inverse);
+
+// Двумерное преобразование: in - rows строк по columns элементов (портится),
+// out - результат в транспонированном виде (columns строк по rows элементов).
+// Повторный вызов над out с переставленными планами возвращает исходную ориентацию.
+void fft_2d(FftComplex* in, FftComplex* out, int rows, int columns,
+            const FftPlan* row_plan, const FftPlan* column_plan, bool inverse);
+
+// Наибольшая сторона плитки свертки
+#define FFT_MAX_TILE 512
+
+// Сторона плитки для ядра kernel_size при размере кадра frame_size
+int fft_tile_size(int kernel_size, int frame_size);
+
+// Оценка времени свертки через БПФ на пиксель, нс (сравнивается с оценками
+// прямой и сепарабельной свертки в convolution_rows, см. bench/bench.c fft)
+double fft_convolution_cost(int kernel_width, int kernel_height, int frame_width, int frame_height);
+
+// Свертка строк [y0, y1) ядром kernel_width x kernel_height (веса по строкам,
+// уже нормированные; за краями кадра повторяются крайние пиксели). Плитки
+// выровнены по кадру, поэтому результат не зависит от разбиения на полосы.
+// Спектры ядра хранятся в кэше и повторно используются для изображений того же
+// размера (например, в пакетной обработке). Ошибка округления зависит от всей
+// плитки, поэтому в потоковом режиме, где строки за окрестностью полосы
+// недоступны, отдельные пиксели могут отличаться на единицу младшего разряда.
+bool fft_convolution_rows(const Image* src, Image* dst, int y0, int y1,
+                          const float* kernel, int kernel_width, int kernel_height);
+
+// Освобождение кэша спектров ядер
+void fft_cache_clear(void);
+
+#endif // FFT_H
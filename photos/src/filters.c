@@ -1,263 +1,483 @@
 #include "filters.h"
+#include "simd.h"
+#include "buffer_pool.h"
+#include "fft.h"
+#include "log.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <assert.h>
 #include <stdio.h>
 
+// Формула сепии
+static const float sepia_matrix[3][4] = {
+    {0.393f, 0.769f, 0.189f, 0.0f},
+    {0.349f, 0.686f, 0.168f, 0.0f},
+    {0.272f, 0.534f, 0.131f, 0.0f}
+};
+
+// Обработка полосы строк без вывода сообщений (используется и пайплайном)
+static void band_grayscale(Image* image, void* params);
+static void band_negative(Image* image, void* params);
+static void band_sharpening(Image* image, void* params);
+static void band_edge_detection(Image* image, void* params);
+static void band_emboss(Image* image, void* params);
+static void band_convolve(Image* image, void* params);
+static void band_median(Image* image, void* params);
+static void band_gaussian_blur(Image* image, void* params);
+static void band_box_blur(Image* image, void* params);
+static void band_sepia(Image* image, void* params);
+static void band_vignette(Image* image, void* params);
+static bool point_vignette(const void* params, PointOp* op);
+
+// Проходы из src в dst для фильтров с окрестностью
+static bool pass_sharpening(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_edge_detection(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_emboss(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_convolve(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_median(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_gaussian_blur(const Image* src, Image* dst, int y0, int y1, const void* params);
+static bool pass_box_blur(const Image* src, Image* dst, int y0, int y1, const void* params);
+
+// Выполнение прохода на месте: результат пишется в буфер из пула, который
+// затем становится данными изображения
+static Image* pass_target(const Image* image) {
+    Image* dst = image_create_scratch(image->width, image->height);
+    if (dst) {
+        dst->frame_y = image->frame_y;
+        dst->frame_height = image->frame_height;
+    }
+    return dst;
+}
+
+static void pass_commit(Image* image, Image* dst, bool ok) {
+    if (ok) {
+        image_swap_data(image, dst);
+    }
+    image_destroy(dst);
+}
+
+static void apply_pass(Image* image, FilterPassFunc pass, const void* params) {
+    Image* dst = pass_target(image);
+    if (!dst) {
+        log_error("Cannot create temporary image for filter\n");
+        return;
+    }
+
+    pass_commit(image, dst, pass(image, dst, 0, image->height, params));
+}
+
+bool crop_clip(const CropParams* crop, int width, int height, ImageRegion* region) {
+    if (crop->x < 0 || crop->y < 0 || crop->x >= width || crop->y >= height) {
+        return false;
+    }
+
+    region->x = crop->x;
+    region->y = crop->y;
+    region->width = crop->width < width - crop->x ? crop->width : width - crop->x;
+    region->height = crop->height < height - crop->y ? crop->height : height - crop->y;
+    return region->width > 0 && region->height > 0;
+}
+
 // Crop filter
 void filter_crop(Image* image, void* params) {
     if (!image || !params) {
-        fprintf(stderr, "Error: filter_crop received NULL parameters\n");
+        log_error("filter_crop received NULL parameters\n");
         return;
     }
 
     CropParams* crop = (CropParams*)params;
-    int new_width = crop->width;
-    int new_height = crop->height;
-
-    // Ограничение размеров до размеров изображения
-    if (new_width > image->width) new_width = image->width;
-    if (new_height > image->height) new_height = image->height;
-
-    if (new_width <= 0 || new_height <= 0) {
-        fprintf(stderr, "Error: Invalid crop dimensions %dx%d\n", new_width, new_height);
+    ImageRegion region;
+    if (!crop_clip(crop, image->width, image->height, &region)) {
+        log_error("Invalid crop %dx%d at (%d, %d) for %dx%d image\n", crop->width, crop->height,
+                  crop->x, crop->y, image->width, image->height);
         return;
     }
 
-    printf("Cropping to %dx%d\n", new_width, new_height);
+    log_info("Cropping to %dx%d at (%d, %d)\n", region.width, region.height, region.x, region.y);
+    if (region.width == image->width && region.height == image->height) {
+        return;
+    }
 
     // Создание нового изображения с обрезанными размерами
-    Image* cropped = image_create(new_width, new_height);
+    Image* cropped = image_create_scratch(region.width, region.height);
     if (!cropped) {
-        fprintf(stderr, "Error: Cannot create cropped image\n");
+        log_error("Cannot create cropped image\n");
         return;
     }
 
-    // Копирование верхней левой части
-    for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            Color color = image_get_pixel(image, x, y);
-            image_set_pixel(cropped, x, y, color);
-        }
+    // Копирование области построчно
+    for (int y = 0; y < region.height; y++) {
+        memcpy(cropped->data + (size_t)y * region.width,
+               image->data + (size_t)(region.y + y) * image->width + region.x,
+               sizeof(Color) * region.width);
     }
 
     // Замена данных изображения
-    free(image->data);
+    buffer_pool_release(image->data);
     image->data = cropped->data;
     image->width = cropped->width;
     image->height = cropped->height;
     image->capacity = cropped->capacity;
+    image->frame_y = 0;
+    image->frame_height = cropped->height;
     free(cropped);
 }
 
+// Resize filter
+void filter_resize(Image* image, void* params) {
+    if (!image || !params) {
+        log_error("filter_resize received NULL parameters\n");
+        return;
+    }
+
+    ResizeParams* resize = (ResizeParams*)params;
+    log_info("Resizing to %dx%d (%s)\n", resize->width, resize->height,
+             resample_method_name(resize->method));
+
+    if (!image_resample(image, resize->width, resize->height, resize->method)) {
+        log_error("Cannot resize image to %dx%d\n", resize->width, resize->height);
+    }
+}
+
 // Grayscale filter
 void filter_grayscale(Image* image, void* params) {
     if (!image) {
-        fprintf(stderr, "Error: filter_grayscale received NULL image\n");
+        log_error("filter_grayscale received NULL image\n");
         return;
     }
 
-    printf("Converting to grayscale\n");
+    log_info("Converting to grayscale\n");
+    band_grayscale(image, params);
+}
 
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
-            float luminance = color_luminance(color);
-            Color gray = color_create(luminance, luminance, luminance);
-            image_set_pixel(image, x, y, gray);
-        }
-    }
+static void band_grayscale(Image* image, void* params) {
+    simd_kernels()->grayscale(image->data, image->width * image->height);
 }
 
 // Negative filter
 void filter_negative(Image* image, void* params) {
     if (!image) {
-        fprintf(stderr, "Error: filter_negative received NULL image\n");
+        log_error("filter_negative received NULL image\n");
         return;
     }
 
-    printf("Applying negative filter\n");
+    log_info("Applying negative filter\n");
+    band_negative(image, params);
+}
 
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
-            Color negative = color_create(
-                1.0f - color.r,
-                1.0f - color.g,
-                1.0f - color.b
-            );
-            image_set_pixel(image, x, y, negative);
+static void band_negative(Image* image, void* params) {
+    simd_kernels()->negative(image->data, image->width * image->height);
+}
+
+// Свертка 3x3. Внутренние пиксели строки (все, кроме первого и последнего)
+// считаются векторным ядром convolve_rows без проверок границ: каждый
+// ненулевой вес - строка окна, сдвинутая на пиксель влево или вправо.
+// Крайние пиксели считаются по полному ядру с повтором края. Слагаемые идут
+// в том же порядке, что и в полном ядре, поэтому результат побитово совпадает.
+typedef struct {
+    float kernel[3][3];
+    float divisor;
+    int taps;                 // ненулевые веса в порядке обхода ядра
+    signed char dy[9];
+    signed char dx[9];
+    float weights[9];
+} Conv3x3;
+
+// Известные ядра: нулевые веса исключены при компиляции
+static const Conv3x3 conv3x3_known[] = {
+    [KERNEL3X3_SHARPEN] = {
+        { { 0, -1,  0}, {-1,  5, -1}, { 0, -1,  0} }, 1.0f,
+        5, {-1, 0, 0, 0, 1}, {0, -1, 0, 1, 0}, {-1, -1, 5, -1, -1}
+    },
+    [KERNEL3X3_LAPLACIAN] = {
+        { { 0, -1,  0}, {-1,  4, -1}, { 0, -1,  0} }, 1.0f,
+        5, {-1, 0, 0, 0, 1}, {0, -1, 0, 1, 0}, {-1, -1, 4, -1, -1}
+    },
+    [KERNEL3X3_EMBOSS] = {
+        { {-2, -1,  0}, {-1,  1,  1}, { 0,  1,  2} }, 1.0f,
+        7, {-1, -1, 0, 0, 0, 1, 1}, {-1, 0, -1, 0, 1, 0, 1}, {-2, -1, -1, 1, 1, 1, 2}
+    },
+};
+
+// Произвольное ядро: список ненулевых весов строится при вызове
+static void conv3x3_init(Conv3x3* conv, float kernel[3][3], float divisor) {
+    memcpy(conv->kernel, kernel, sizeof(conv->kernel));
+    conv->divisor = divisor;
+    conv->taps = 0;
+    for (int ky = 0; ky < 3; ky++) {
+        for (int kx = 0; kx < 3; kx++) {
+            if (kernel[ky][kx] != 0.0f) {
+                conv->dy[conv->taps] = (signed char)(ky - 1);
+                conv->dx[conv->taps] = (signed char)(kx - 1);
+                conv->weights[conv->taps] = kernel[ky][kx];
+                conv->taps++;
+            }
+        }
+    }
+}
+
+// Пиксель x по полному ядру: rows - строки y-1, y, y+1 (с повтором на краях)
+static Color conv3x3_pixel(const Conv3x3* conv, const Color* rows[3], int x, int width) {
+    Color sum = color_create(0, 0, 0);
+    float total_weight = 0.0f;
+
+    for (int ky = -1; ky <= 1; ky++) {
+        for (int kx = -1; kx <= 1; kx++) {
+            int nx = x + kx;
+
+            // Обработка границ: используем ближайший пиксель
+            if (nx < 0) nx = 0;
+            if (nx >= width) nx = width - 1;
+
+            Color pixel = rows[ky + 1][nx];
+            float weight = conv->kernel[ky + 1][kx + 1];
+
+            sum = color_add(sum, color_mul(pixel, weight));
+            total_weight += weight;
+        }
+    }
+
+    if (conv->divisor != 0) {
+        sum = color_mul(sum, 1.0f / conv->divisor);
+    } else if (total_weight != 0) {
+        sum = color_mul(sum, 1.0f / total_weight);
+    }
+
+    return color_clamp(sum);
+}
+
+// Множитель после суммирования (1 - не нужен)
+static float conv3x3_scale(const Conv3x3* conv) {
+    float total_weight = 0.0f;
+    for (int ky = 0; ky < 3; ky++) {
+        for (int kx = 0; kx < 3; kx++) {
+            total_weight += conv->kernel[ky][kx];
+        }
+    }
+
+    if (conv->divisor != 0) {
+        return 1.0f / conv->divisor;
+    }
+    return total_weight != 0 ? 1.0f / total_weight : 1.0f;
+}
+
+static void conv3x3_row(const Conv3x3* conv, float scale, const Color* rows[3], Color* out, int width) {
+    // Умножение после суммы нельзя внести в веса без изменения округления,
+    // поэтому векторное ядро используется только без него
+    if (width < 3 || scale != 1.0f) {
+        for (int x = 0; x < width; x++) {
+            out[x] = conv3x3_pixel(conv, rows, x, width);
+        }
+        return;
+    }
+
+    const float* taps[9];
+    for (int t = 0; t < conv->taps; t++) {
+        taps[t] = (const float*)(rows[conv->dy[t] + 1] + 1 + conv->dx[t]);
+    }
+    simd_kernels()->convolve_rows(taps, conv->weights, conv->taps, (float*)(out + 1),
+                                  0, (width - 2) * 3);
+
+    out[0] = conv3x3_pixel(conv, rows, 0, width);
+    out[width - 1] = conv3x3_pixel(conv, rows, width - 1, width);
+}
+
+static bool conv3x3_rows(const Image* src, Image* dst, int y0, int y1, const Conv3x3* conv) {
+    int width = src->width;
+    int height = src->height;
+    float scale = conv3x3_scale(conv);
+
+    for (int y = y0; y < y1; y++) {
+        const Color* rows[3];
+        for (int ky = -1; ky <= 1; ky++) {
+            int ny = y + ky;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
+            rows[ky + 1] = src->data + (size_t)ny * width;
         }
+
+        conv3x3_row(conv, scale, rows, dst->data + (size_t)y * width, width);
     }
+    return true;
+}
+
+bool matrix_filter_rows(const Image* src, Image* dst, int y0, int y1,
+                        float kernel[3][3], float divisor) {
+    Conv3x3 conv;
+    conv3x3_init(&conv, kernel, divisor);
+    return conv3x3_rows(src, dst, y0, y1, &conv);
+}
+
+bool kernel3x3_rows(const Image* src, Image* dst, int y0, int y1, Kernel3x3 kernel) {
+    return conv3x3_rows(src, dst, y0, y1, &conv3x3_known[kernel]);
 }
 
 // Sharpening filter
 void filter_sharpening(Image* image, void* params) {
     if (!image) {
-        fprintf(stderr, "Error: filter_sharpening received NULL image\n");
+        log_error("filter_sharpening received NULL image\n");
         return;
     }
 
-    printf("Applying sharpening filter\n");
+    log_info("Applying sharpening filter\n");
+    band_sharpening(image, params);
+}
+
+static void band_sharpening(Image* image, void* params) {
+    apply_pass(image, pass_sharpening, params);
+}
 
-    float kernel[3][3] = {
-        { 0, -1,  0},
-        {-1,  5, -1},
-        { 0, -1,  0}
-    };
-    apply_matrix_filter(image, kernel, 1.0f);
+static bool pass_sharpening(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    return kernel3x3_rows(src, dst, y0, y1, KERNEL3X3_SHARPEN);
 }
 
 // Edge detection filter
 void filter_edge_detection(Image* image, void* params) {
     if (!image || !params) {
-        fprintf(stderr, "Error: filter_edge_detection received NULL parameters\n");
+        log_error("filter_edge_detection received NULL parameters\n");
         return;
     }
 
-    EdgeParams* edge = (EdgeParams*)params;
-    float threshold = edge->threshold;
-
-    printf("Applying edge detection with threshold %.2f\n", threshold);
+    log_info("Applying edge detection with threshold %.2f\n", ((EdgeParams*)params)->threshold);
+    band_edge_detection(image, params);
+}
 
-    // Сначала преобразуем в градации серого
-    filter_grayscale(image, NULL);
+static void band_edge_detection(Image* image, void* params) {
+    apply_pass(image, pass_edge_detection, params);
+}
 
-    float kernel[3][3] = {
-        { 0, -1,  0},
-        {-1,  4, -1},
-        { 0, -1,  0}
-    };
+// Строки окна переводятся в градации серого в кольце из трех строк, поэтому
+// исходное изображение не изменяется
+static bool pass_edge_detection(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    float threshold = ((const EdgeParams*)params)->threshold;
+    int width = src->width;
+    int height = src->height;
+
+    Color* ring = (Color*)buffer_pool_acquire(sizeof(Color) * (size_t)width * 3, false);
+    if (!ring) {
+        log_error("Memory allocation failed for edge detection\n");
+        return false;
+    }
 
-    // Применяем матричный фильтр
-    apply_matrix_filter(image, kernel, 1.0f);
+    const SimdKernels* simd = simd_kernels();
+    int ring_rows[3] = {-1, -1, -1};
+    for (int y = y0; y < y1; y++) {
+        const Color* rows[3];
+        for (int ky = -1; ky <= 1; ky++) {
+            int ny = y + ky;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
+
+            Color* row = ring + (size_t)(ny % 3) * width;
+            if (ring_rows[ny % 3] != ny) {
+                memcpy(row, src->data + (size_t)ny * width, sizeof(Color) * width);
+                simd->grayscale(row, width);
+                ring_rows[ny % 3] = ny;
+            }
+            rows[ky + 1] = row;
+        }
 
-    // Бинаризация по порогу
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
-            float value = color.r; // Все каналы одинаковы после grayscale
+        Color* out = dst->data + (size_t)y * width;
+        conv3x3_row(&conv3x3_known[KERNEL3X3_LAPLACIAN], 1.0f, rows, out, width);
 
-            if (value > threshold) {
-                image_set_pixel(image, x, y, color_create(1.0f, 1.0f, 1.0f));
-            } else {
-                image_set_pixel(image, x, y, color_create(0.0f, 0.0f, 0.0f));
-            }
+        // Бинаризация по порогу (все каналы одинаковы после grayscale)
+        for (int x = 0; x < width; x++) {
+            float value = out[x].r > threshold ? 1.0f : 0.0f;
+            out[x] = color_create(value, value, value);
         }
     }
+
+    buffer_pool_release(ring);
+    return true;
 }
 
-// Median filter
-void filter_median(Image* image, void* params) {
-    if (!image || !params) {
-        fprintf(stderr, "Error: filter_median received NULL parameters\n");
+// Emboss filter
+void filter_emboss(Image* image, void* params) {
+    if (!image) {
+        log_error("filter_emboss received NULL image\n");
         return;
     }
 
-    MedianParams* med = (MedianParams*)params;
-    int window = med->window_size;
+    log_info("Applying emboss filter\n");
+    band_emboss(image, params);
+}
 
-    if (window % 2 == 0 || window < 1) {
-        fprintf(stderr, "Error: Median filter window size must be odd and positive (got %d)\n", window);
+static void band_emboss(Image* image, void* params) {
+    apply_pass(image, pass_emboss, params);
+}
+
+static bool pass_emboss(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    return kernel3x3_rows(src, dst, y0, y1, KERNEL3X3_EMBOSS);
+}
+
+// Convolution filter
+void filter_convolve(Image* image, void* params) {
+    if (!image || !params) {
+        log_error("filter_convolve received NULL parameters\n");
         return;
     }
 
-    printf("Applying median filter with window size %d\n", window);
-
-    int half = window / 2;
-    Image* temp = image_copy(image);
-    if (!temp) {
-        fprintf(stderr, "Error: Cannot create temporary image for median filter\n");
+    const ConvParams* kernel = (const ConvParams*)params;
+    if (kernel->width < 1 || kernel->height < 1 || kernel->width % 2 == 0 || kernel->height % 2 == 0 ||
+        kernel->width > CONV_MAX_SIZE || kernel->height > CONV_MAX_SIZE) {
+        log_error("Invalid convolution kernel size %dx%d\n", kernel->width, kernel->height);
         return;
     }
 
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            // Сбор цветов в окрестности
-            int count = 0;
-            Color* colors = (Color*)malloc(sizeof(Color) * window * window);
-            if (!colors) {
-                fprintf(stderr, "Error: Memory allocation failed for median filter\n");
-                image_destroy(temp);
-                return;
-            }
+    static const char* method_names[] = { "direct", "separable", "fft" };
+    float row[CONV_MAX_SIZE];
+    float column[CONV_MAX_SIZE];
+    log_info("Applying %dx%d convolution (%s)\n", kernel->width, kernel->height,
+           method_names[convolution_method(kernel, image->width, image->height, row, column)]);
+    band_convolve(image, params);
+}
 
-            for (int dy = -half; dy <= half; dy++) {
-                for (int dx = -half; dx <= half; dx++) {
-                    int nx = x + dx;
-                    int ny = y + dy;
+static void band_convolve(Image* image, void* params) {
+    apply_pass(image, pass_convolve, params);
+}
 
-                    // Обработка границ: используем ближайший пиксель
-                    if (nx < 0) nx = 0;
-                    if (nx >= image->width) nx = image->width - 1;
-                    if (ny < 0) ny = 0;
-                    if (ny >= image->height) ny = image->height - 1;
+static bool pass_convolve(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    return convolution_rows(src, dst, y0, y1, (const ConvParams*)params);
+}
 
-                    colors[count++] = image_get_pixel(temp, nx, ny);
-                }
-            }
+// Median filter
+void filter_median(Image* image, void* params) {
+    if (!image || !params) {
+        log_error("filter_median received NULL parameters\n");
+        return;
+    }
 
-            // Сортировка для нахождения медианы (отдельно по каналам)
-            // Простая bubble sort для каждого канала
-            float r_vals[count], g_vals[count], b_vals[count];
-            for (int i = 0; i < count; i++) {
-                r_vals[i] = colors[i].r;
-                g_vals[i] = colors[i].g;
-                b_vals[i] = colors[i].b;
-            }
+    MedianParams* med = (MedianParams*)params;
+    int window = med->window_size;
 
-            // Сортировка красного канала
-            for (int i = 0; i < count - 1; i++) {
-                for (int j = i + 1; j < count; j++) {
-                    if (r_vals[i] > r_vals[j]) {
-                        float temp_val = r_vals[i];
-                        r_vals[i] = r_vals[j];
-                        r_vals[j] = temp_val;
-                    }
-                }
-            }
+    if (window % 2 == 0 || window < 1) {
+        log_error("Median filter window size must be odd and positive (got %d)\n", window);
+        return;
+    }
 
-            // Сортировка зеленого канала
-            for (int i = 0; i < count - 1; i++) {
-                for (int j = i + 1; j < count; j++) {
-                    if (g_vals[i] > g_vals[j]) {
-                        float temp_val = g_vals[i];
-                        g_vals[i] = g_vals[j];
-                        g_vals[j] = temp_val;
-                    }
-                }
-            }
+    log_info("Applying median filter with window size %d\n", window);
+    band_median(image, params);
+}
 
-            // Сортировка синего канала
-            for (int i = 0; i < count - 1; i++) {
-                for (int j = i + 1; j < count; j++) {
-                    if (b_vals[i] > b_vals[j]) {
-                        float temp_val = b_vals[i];
-                        b_vals[i] = b_vals[j];
-                        b_vals[j] = temp_val;
-                    }
-                }
-            }
+static void band_median(Image* image, void* params) {
+    apply_pass(image, pass_median, params);
+}
 
-            Color median = color_create(
-                r_vals[count / 2],
-                g_vals[count / 2],
-                b_vals[count / 2]
-            );
+static bool pass_median(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    int window = ((const MedianParams*)params)->window_size;
 
-            image_set_pixel(image, x, y, median);
-            free(colors);
-        }
+    // Малые окна быстрее через сети сортировки, большие - через гистограммы
+    if (window <= MEDIAN_NETWORK_MAX_WINDOW) {
+        return median_network_rows(src, dst, y0, y1, window);
     }
-
-    image_destroy(temp);
+    return median_histogram_rows(src, dst, y0, y1, window);
 }
 
 // Gaussian blur filter
 void filter_gaussian_blur(Image* image, void* params) {
     if (!image || !params) {
-        fprintf(stderr, "Error: filter_gaussian_blur received NULL parameters\n");
+        log_error("filter_gaussian_blur received NULL parameters\n");
         return;
     }
 
@@ -265,42 +485,75 @@ void filter_gaussian_blur(Image* image, void* params) {
     float sigma = blur->sigma;
 
     if (sigma <= 0) {
-        fprintf(stderr, "Error: Gaussian blur sigma must be positive (got %.2f)\n", sigma);
+        log_error("Gaussian blur sigma must be positive (got %.2f)\n", sigma);
         return;
     }
 
-    printf("Applying Gaussian blur with sigma %.2f\n", sigma);
-    apply_gaussian_blur(image, sigma);
+    if (sigma >= GAUSSIAN_BOX_MIN_SIGMA) {
+        log_info("Applying Gaussian blur with sigma %.2f (box approximation)\n", sigma);
+    } else {
+        log_info("Applying Gaussian blur with sigma %.2f\n", sigma);
+    }
+    band_gaussian_blur(image, params);
 }
 
-// Sepia filter (дополнительный)
-void filter_sepia(Image* image, void* params) {
-    if (!image) {
-        fprintf(stderr, "Error: filter_sepia received NULL image\n");
+static void band_gaussian_blur(Image* image, void* params) {
+    apply_pass(image, pass_gaussian_blur, params);
+}
+
+// Большие σ - через боксы (порог по bench/bench.c blur), малые - точным ядром
+static bool pass_gaussian_blur(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    float sigma = ((const BlurParams*)params)->sigma;
+    if (sigma >= GAUSSIAN_BOX_MIN_SIGMA) {
+        return gaussian_box_rows(src, dst, y0, y1, sigma);
+    }
+    return gaussian_blur_rows(src, dst, y0, y1, sigma);
+}
+
+// Box blur filter
+void filter_box_blur(Image* image, void* params) {
+    if (!image || !params) {
+        log_error("filter_box_blur received NULL parameters\n");
         return;
     }
 
-    printf("Applying sepia filter\n");
+    int radius = ((BoxBlurParams*)params)->radius;
+    if (radius < 1) {
+        log_error("Box blur radius must be positive (got %d)\n", radius);
+        return;
+    }
 
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
+    log_info("Applying box blur with radius %d\n", radius);
+    band_box_blur(image, params);
+}
 
-            // Формула сепии
-            float new_r = color.r * 0.393f + color.g * 0.769f + color.b * 0.189f;
-            float new_g = color.r * 0.349f + color.g * 0.686f + color.b * 0.168f;
-            float new_b = color.r * 0.272f + color.g * 0.534f + color.b * 0.131f;
+static void band_box_blur(Image* image, void* params) {
+    apply_pass(image, pass_box_blur, params);
+}
 
-            Color sepia = color_create(new_r, new_g, new_b);
-            image_set_pixel(image, x, y, sepia);
-        }
+static bool pass_box_blur(const Image* src, Image* dst, int y0, int y1, const void* params) {
+    return box_blur_rows(src, dst, y0, y1, ((const BoxBlurParams*)params)->radius);
+}
+
+// Sepia filter (дополнительный)
+void filter_sepia(Image* image, void* params) {
+    if (!image) {
+        log_error("filter_sepia received NULL image\n");
+        return;
     }
+
+    log_info("Applying sepia filter\n");
+    band_sepia(image, params);
+}
+
+static void band_sepia(Image* image, void* params) {
+    simd_kernels()->color_matrix(image->data, image->width * image->height, sepia_matrix);
 }
 
 // Vignette filter (дополнительный)
 void filter_vignette(Image* image, void* params) {
     if (!image) {
-        fprintf(stderr, "Error: filter_vignette received NULL image\n");
+        log_error("filter_vignette received NULL image\n");
         return;
     }
 
@@ -308,36 +561,97 @@ void filter_vignette(Image* image, void* params) {
     float intensity = vignette ? vignette->intensity : 0.8f;
 
     if (intensity < 0 || intensity > 1) {
-        fprintf(stderr, "Warning: Vignette intensity should be between 0 and 1 (got %.2f)\n", intensity);
+        log_warning("Vignette intensity should be between 0 and 1 (got %.2f)\n", intensity);
         intensity = intensity < 0 ? 0 : (intensity > 1 ? 1 : intensity);
     }
 
-    printf("Applying vignette filter with intensity %.2f\n", intensity);
+    log_info("Applying vignette filter with intensity %.2f\n", intensity);
+    band_vignette(image, params);
+}
+
+static void band_vignette(Image* image, void* params) {
+    PointOp op;
+    point_vignette(params, &op);
+    apply_point_ops(image, &op, 1);
+}
+
+// Матрица переводит куб [0, 1]^3 в себя (с точностью до округления),
+// поэтому после нее можно не ограничивать значения
+static bool point_matrix_in_range(const float m[3][4]) {
+    for (int i = 0; i < 3; i++) {
+        float low = m[i][3];
+        float high = m[i][3];
+        for (int k = 0; k < 3; k++) {
+            if (m[i][k] > 0) high += m[i][k];
+            else low += m[i][k];
+        }
+        if (low < -1e-5f || high > 1.0f + 1e-5f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int point_ops_fuse(const PointOp* ops, int count, PointOp* out) {
+    int fused = 0;
+
+    for (int i = 0; i < count; i++) {
+        PointOp* last = fused > 0 ? &out[fused - 1] : NULL;
+
+        if (ops[i].type == POINT_OP_MATRIX && last && last->type == POINT_OP_MATRIX &&
+            point_matrix_in_range(last->matrix)) {
+            // Композиция: ops[i] после last
+            float result[3][4];
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 4; c++) {
+                    double sum = c == 3 ? ops[i].matrix[r][3] : 0.0;
+                    for (int k = 0; k < 3; k++) {
+                        sum += (double)ops[i].matrix[r][k] * last->matrix[k][c];
+                    }
+                    result[r][c] = (float)sum;
+                }
+            }
+            memcpy(last->matrix, result, sizeof(result));
+        } else {
+            out[fused++] = ops[i];
+        }
+    }
+
+    return fused;
+}
+
+// Длина участка строки, который проходит через всю цепочку операций подряд
+#define POINT_CHUNK_PIXELS 512
+
+void apply_point_ops(Image* image, const PointOp* ops, int count) {
+    if (!image || !ops || count <= 0) {
+        return;
+    }
+
+    const SimdKernels* simd = simd_kernels();
 
+    // Центр виньетки считается по полному кадру, даже если обрабатывается полоса строк
     float center_x = image->width / 2.0f;
-    float center_y = image->height / 2.0f;
+    float center_y = image->frame_height / 2.0f;
     float max_distance = sqrtf(center_x * center_x + center_y * center_y);
 
     if (max_distance < 1.0f) max_distance = 1.0f;
 
     for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color color = image_get_pixel(image, x, y);
-
-            float dx = x - center_x;
-            float dy = y - center_y;
-            float distance = sqrtf(dx * dx + dy * dy);
-            float factor = 1.0f - (distance / max_distance) * intensity;
-
-            if (factor < 0.0f) factor = 0.0f;
+        Color* row = image->data + (size_t)y * image->width;
+        float dy = (y + image->frame_y) - center_y;
 
-            Color vignetted = color_create(
-                color.r * factor,
-                color.g * factor,
-                color.b * factor
-            );
+        for (int x0 = 0; x0 < image->width; x0 += POINT_CHUNK_PIXELS) {
+            int n = image->width - x0 < POINT_CHUNK_PIXELS ? image->width - x0 : POINT_CHUNK_PIXELS;
 
-            image_set_pixel(image, x, y, vignetted);
+            for (int i = 0; i < count; i++) {
+                if (ops[i].type == POINT_OP_MATRIX) {
+                    simd->color_matrix(row + x0, n, ops[i].matrix);
+                } else {
+                    VignetteRow vignette = { center_x - x0, dy, max_distance, ops[i].intensity };
+                    simd->vignette(row + x0, n, &vignette);
+                }
+            }
         }
     }
 }
@@ -348,65 +662,25 @@ void apply_matrix_filter(Image* image, float kernel[3][3], float divisor) {
         return;
     }
 
-    Image* temp = image_copy(image);
-    if (!temp) {
+    Image* dst = pass_target(image);
+    if (!dst) {
         return;
     }
 
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color sum = color_create(0, 0, 0);
-            float total_weight = 0.0f;
-
-            for (int ky = -1; ky <= 1; ky++) {
-                for (int kx = -1; kx <= 1; kx++) {
-                    int nx = x + kx;
-                    int ny = y + ky;
-
-                    // Обработка границ: используем ближайший пиксель
-                    if (nx < 0) nx = 0;
-                    if (nx >= image->width) nx = image->width - 1;
-                    if (ny < 0) ny = 0;
-                    if (ny >= image->height) ny = image->height - 1;
-
-                    Color pixel = image_get_pixel(temp, nx, ny);
-                    float weight = kernel[ky + 1][kx + 1];
-
-                    sum = color_add(sum, color_mul(pixel, weight));
-                    total_weight += weight;
-                }
-            }
-
-            if (divisor != 0) {
-                sum = color_mul(sum, 1.0f / divisor);
-            } else if (total_weight != 0) {
-                sum = color_mul(sum, 1.0f / total_weight);
-            }
-
-            image_set_pixel(image, x, y, sum);
-        }
-    }
-
-    image_destroy(temp);
+    pass_commit(image, dst, matrix_filter_rows(image, dst, 0, image->height, kernel, divisor));
 }
 
-// Вспомогательная функция для гауссова размытия
-void apply_gaussian_blur(Image* image, float sigma) {
-    if (!image || sigma <= 0) {
-        return;
-    }
-
-    // Рассчитываем размер ядра (3σ в каждую сторону)
+// Нормированное 1D ядро Гаусса радиусом ceil(3σ)
+static float* gaussian_kernel(float sigma, int* radius) {
     int kernel_radius = (int)ceil(3 * sigma);
     int kernel_size = kernel_radius * 2 + 1;
 
     float* kernel = (float*)malloc(sizeof(float) * kernel_size);
     if (!kernel) {
-        fprintf(stderr, "Error: Memory allocation failed for Gaussian kernel\n");
-        return;
+        log_error("Memory allocation failed for Gaussian kernel\n");
+        return NULL;
     }
 
-    // Создаем 1D ядро Гаусса
     float sum = 0.0f;
     float two_sigma_sq = 2 * sigma * sigma;
 
@@ -421,67 +695,1100 @@ void apply_gaussian_blur(Image* image, float sigma) {
         kernel[i] /= sum;
     }
 
-    // Применяем раздельно по горизонтали и вертикали
-    Image* temp = image_copy(image);
-    if (!temp) {
-        free(kernel);
-        return;
+    *radius = kernel_radius;
+    return kernel;
+}
+
+// Вертикальная свертка блоками: полоса столбцов проходит все строки блока,
+// пока ее строки окна лежат в кэше. Ширина полосы в float (256 пикселей).
+#define CONVOLVE_STRIP_FLOATS 768
+
+void convolve_vertical(const float* const* window, const float* kernel, int taps,
+                       float* const* out, int rows, int count) {
+    void (*convolve)(const float* const*, const float*, int, float*, int, int) =
+        simd_kernels()->convolve_rows;
+
+    for (int x0 = 0; x0 < count; x0 += CONVOLVE_STRIP_FLOATS) {
+        int x1 = count - x0 < CONVOLVE_STRIP_FLOATS ? count : x0 + CONVOLVE_STRIP_FLOATS;
+        for (int y = 0; y < rows; y++) {
+            convolve(window + y, kernel, taps, out[y], x0, x1);
+        }
     }
+}
 
-    // Горизонтальное размытие
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color sum_color = color_create(0, 0, 0);
+// Число строк приемника, считаемых одним блоком вертикального прохода
+#define SEPARABLE_BLOCK_ROWS 32
+
+// Копия строки с повтором крайних пикселей на pad пикселей с каждой стороны
+static void pad_row(const Color* in, Color* padded, int width, int pad) {
+    for (int x = 0; x < pad; x++) {
+        padded[x] = in[0];
+        padded[pad + width + x] = in[width - 1];
+    }
+    memcpy(padded + pad, in, sizeof(Color) * width);
+}
+
+// Раздельная свертка: строка ядра по горизонтали, столбец - по вертикали (за
+// краями повторяются крайние пиксели). Строки после горизонтального прохода
+// хранятся в кольце из 2r + SEPARABLE_BLOCK_ROWS строк: каждая строка источника
+// проходится один раз, промежуточный кадр не нужен. clamp_rows - ограничивать
+// промежуточные строки [0, 1] (верно для ядер без отрицательных весов).
+static bool separable_rows(const Image* src, Image* dst, int y0, int y1,
+                           const float* row_kernel, int row_radius,
+                           const float* column_kernel, int column_radius, bool clamp_rows) {
+    int width = src->width;
+    int height = src->height;
+    int row_taps = 2 * row_radius + 1;
+    int taps = 2 * column_radius + 1;
+    int slots = taps + SEPARABLE_BLOCK_ROWS - 1;
+    const SimdKernels* simd = simd_kernels();
+    void (*horizontal)(const float* const*, const float*, int, float*, int, int) =
+        clamp_rows ? simd->convolve_rows : simd->accumulate_rows;
+
+    Color* ring = (Color*)buffer_pool_acquire(sizeof(Color) * (size_t)width * slots, false);
+    Color* padded = (Color*)buffer_pool_acquire(sizeof(Color) * ((size_t)width + 2 * row_radius), false);
+    int* ring_rows = (int*)malloc(sizeof(int) * slots);
+    const float** window = (const float**)malloc(sizeof(float*) * slots);
+    const float** shifted = (const float**)malloc(sizeof(float*) * row_taps);
+    if (!ring || !padded || !ring_rows || !window || !shifted) {
+        log_error("Memory allocation failed for separable convolution\n");
+        buffer_pool_release(ring);
+        buffer_pool_release(padded);
+        free(ring_rows);
+        free(window);
+        free(shifted);
+        return false;
+    }
 
-            for (int k = -kernel_radius; k <= kernel_radius; k++) {
-                int nx = x + k;
-                if (nx < 0) nx = 0;
-                if (nx >= image->width) nx = image->width - 1;
+    for (int i = 0; i < slots; i++) {
+        ring_rows[i] = -1;
+    }
+    // Горизонтальный проход - сумма сдвинутых копий строки с запасом
+    for (int j = 0; j < row_taps; j++) {
+        shifted[j] = (const float*)(padded + j);
+    }
+
+    for (int yb = y0; yb < y1; yb += SEPARABLE_BLOCK_ROWS) {
+        int rows = y1 - yb < SEPARABLE_BLOCK_ROWS ? y1 - yb : SEPARABLE_BLOCK_ROWS;
+
+        // Строки окна блока - последовательные номера, поэтому в кольце они не пересекаются
+        for (int k = 0; k < rows + taps - 1; k++) {
+            int ny = yb + k - column_radius;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
 
-                Color pixel = image_get_pixel(temp, nx, y);
-                sum_color = color_add(sum_color, color_mul(pixel, kernel[k + kernel_radius]));
+            Color* row = ring + (size_t)(ny % slots) * width;
+            if (ring_rows[ny % slots] != ny) {
+                pad_row(src->data + (size_t)ny * width, padded, width, row_radius);
+                horizontal(shifted, row_kernel, row_taps, (float*)row, 0, width * 3);
+                ring_rows[ny % slots] = ny;
             }
+            window[k] = (const float*)row;
+        }
 
-            image_set_pixel(image, x, y, sum_color);
+        // Вертикальный проход: слагаемые копятся в том же порядке, что и при
+        // попиксельном суммировании
+        float* out[SEPARABLE_BLOCK_ROWS];
+        for (int y = 0; y < rows; y++) {
+            out[y] = (float*)(dst->data + (size_t)(yb + y) * width);
         }
+        convolve_vertical(window, column_kernel, taps, out, rows, width * 3);
     }
 
-    // Копируем результат для вертикального размытия
-    memcpy(temp->data, image->data, sizeof(Color) * image->width * image->height);
+    free(shifted);
+    free(window);
+    free(ring_rows);
+    buffer_pool_release(padded);
+    buffer_pool_release(ring);
+    return true;
+}
 
-    // Вертикальное размытие
-    for (int y = 0; y < image->height; y++) {
-        for (int x = 0; x < image->width; x++) {
-            Color sum_color = color_create(0, 0, 0);
+// Гауссово размытие раздельно по горизонтали и вертикали (промежуточные
+// строки ограничиваются, как и в исходном двухпроходном фильтре)
+bool gaussian_blur_rows(const Image* src, Image* dst, int y0, int y1, float sigma) {
+    if (sigma <= 0) {
+        return false;
+    }
 
-            for (int k = -kernel_radius; k <= kernel_radius; k++) {
-                int ny = y + k;
-                if (ny < 0) ny = 0;
-                if (ny >= image->height) ny = image->height - 1;
+    int radius = 0;
+    float* kernel = gaussian_kernel(sigma, &radius);
+    if (!kernel) {
+        return false;
+    }
 
-                Color pixel = image_get_pixel(temp, x, ny);
-                sum_color = color_add(sum_color, color_mul(pixel, kernel[k + kernel_radius]));
-            }
+    bool ok = separable_rows(src, dst, y0, y1, kernel, radius, kernel, radius, true);
+    free(kernel);
+    return ok;
+}
+
+// Множитель нормировки ядра: 1 / сумма весов (1, если сумма равна нулю)
+static float convolution_scale(const ConvParams* kernel) {
+    float total = 0.0f;
+    for (int i = 0; i < kernel->width * kernel->height; i++) {
+        total += kernel->weights[i];
+    }
+    return total != 0.0f ? 1.0f / total : 1.0f;
+}
+
+bool convolution_factorize(const ConvParams* kernel, float* row, float* column) {
+    int width = kernel->width;
+    int height = kernel->height;
+    const float* k = kernel->weights;
 
-            image_set_pixel(image, x, y, sum_color);
+    // Опорный элемент - наибольший по модулю
+    int pivot = 0;
+    for (int i = 1; i < width * height; i++) {
+        if (fabsf(k[i]) > fabsf(k[pivot])) {
+            pivot = i;
         }
     }
+    float largest = fabsf(k[pivot]);
+    if (largest == 0.0f) {
+        return false;
+    }
 
-    image_destroy(temp);
-    free(kernel);
+    int py = pivot / width;
+    int px = pivot % width;
+    float scale = convolution_scale(kernel);
+    for (int x = 0; x < width; x++) {
+        row[x] = k[py * width + x] / k[pivot];
+    }
+    for (int y = 0; y < height; y++) {
+        column[y] = k[y * width + px];
+    }
+
+    // Ранг 1: каждый вес - произведение своих строки и столбца
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (fabsf(column[y] * row[x] - k[y * width + x]) > largest * 1e-5f) {
+                return false;
+            }
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        column[y] *= scale;
+    }
+    return true;
 }
 
-// Вспомогательная функция для нахождения медианного цвета
-Color get_median_color(Color* colors, int count) {
-    if (count <= 0) {
-        return color_create(0, 0, 0);
+// Прямая свертка: строки окна хранятся с запасом по краям в кольце из height
+// строк, каждый ненулевой вес - сдвинутая строка окна для векторного ядра
+static bool convolution_direct_rows(const Image* src, Image* dst, int y0, int y1,
+                                    const ConvParams* kernel) {
+    int width = src->width;
+    int height = src->height;
+    int rx = kernel->width / 2;
+    int ry = kernel->height / 2;
+    int slots = kernel->height;
+    int padded_width = width + 2 * rx;
+    float scale = convolution_scale(kernel);
+
+    Color* ring = (Color*)buffer_pool_acquire(sizeof(Color) * (size_t)padded_width * slots, false);
+    int* ring_rows = (int*)malloc(sizeof(int) * slots);
+    const float** taps = (const float**)malloc(sizeof(float*) * kernel->width * kernel->height);
+    float* weights = (float*)malloc(sizeof(float) * kernel->width * kernel->height);
+    int* offsets = (int*)malloc(sizeof(int) * kernel->width * kernel->height);
+    if (!ring || !ring_rows || !taps || !weights || !offsets) {
+        log_error("Memory allocation failed for convolution\n");
+        buffer_pool_release(ring);
+        free(ring_rows);
+        free(taps);
+        free(weights);
+        free(offsets);
+        return false;
     }
 
-    // Простая реализация - возвращаем средний цвет
-    Color sum = color_create(0, 0, 0);
-    for (int i = 0; i < count; i++) {
-        sum = color_add(sum, colors[i]);
+    // Ненулевые веса с нормировкой; offsets - номер строки окна и сдвиг
+    int count = 0;
+    for (int ky = 0; ky < kernel->height; ky++) {
+        for (int kx = 0; kx < kernel->width; kx++) {
+            float weight = kernel->weights[ky * kernel->width + kx];
+            if (weight != 0.0f) {
+                weights[count] = weight * scale;
+                offsets[count] = ky * kernel->width + kx;
+                count++;
+            }
+        }
     }
 
-    return color_mul(sum, 1.0f / count);
+    for (int i = 0; i < slots; i++) {
+        ring_rows[i] = -1;
+    }
+
+    void (*convolve)(const float* const*, const float*, int, float*, int, int) =
+        simd_kernels()->convolve_rows;
+
+    for (int y = y0; y < y1; y++) {
+        const Color* rows[CONV_MAX_SIZE];
+        for (int k = 0; k < kernel->height; k++) {
+            int ny = y + k - ry;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
+
+            Color* row = ring + (size_t)(ny % slots) * padded_width;
+            if (ring_rows[ny % slots] != ny) {
+                pad_row(src->data + (size_t)ny * width, row, width, rx);
+                ring_rows[ny % slots] = ny;
+            }
+            rows[k] = row;
+        }
+
+        for (int t = 0; t < count; t++) {
+            taps[t] = (const float*)(rows[offsets[t] / kernel->width] + offsets[t] % kernel->width);
+        }
+
+        Color* out = dst->data + (size_t)y * width;
+        if (count > 0) {
+            convolve(taps, weights, count, (float*)out, 0, width * 3);
+        } else {
+            memset(out, 0, sizeof(Color) * width);
+        }
+    }
+
+    free(offsets);
+    free(weights);
+    free(taps);
+    free(ring_rows);
+    buffer_pool_release(ring);
+    return true;
+}
+
+// Время на пиксель, нс: один вес прямой свертки и один вес каждого из двух
+// проходов сепарабельной (по bench/bench.c fft)
+#define CONV_DIRECT_TAP_NS 0.25
+#define CONV_SEPARABLE_TAP_NS 0.25
+
+ConvolutionMethod convolution_method(const ConvParams* kernel, int frame_width, int frame_height,
+                                     float* row, float* column) {
+    int taps = 0;
+    for (int i = 0; i < kernel->width * kernel->height; i++) {
+        if (kernel->weights[i] != 0.0f) {
+            taps++;
+        }
+    }
+
+    double direct = taps * CONV_DIRECT_TAP_NS;
+    double fft = fft_convolution_cost(kernel->width, kernel->height, frame_width, frame_height);
+    if (convolution_factorize(kernel, row, column)) {
+        double separable = (kernel->width + kernel->height) * CONV_SEPARABLE_TAP_NS;
+        return separable <= fft ? CONV_METHOD_SEPARABLE : CONV_METHOD_FFT;
+    }
+    return direct <= fft ? CONV_METHOD_DIRECT : CONV_METHOD_FFT;
+}
+
+// Свертка через БПФ: веса нормируются заранее, как в прямом пути
+static bool convolution_fft_rows(const Image* src, Image* dst, int y0, int y1,
+                                 const ConvParams* kernel) {
+    int count = kernel->width * kernel->height;
+    float* weights = (float*)malloc(sizeof(float) * count);
+    if (!weights) {
+        log_error("Memory allocation failed for convolution\n");
+        return false;
+    }
+
+    float scale = convolution_scale(kernel);
+    for (int i = 0; i < count; i++) {
+        weights[i] = kernel->weights[i] * scale;
+    }
+
+    bool result = fft_convolution_rows(src, dst, y0, y1, weights, kernel->width, kernel->height);
+    free(weights);
+    return result;
+}
+
+bool convolution_rows_method(const Image* src, Image* dst, int y0, int y1, const ConvParams* kernel,
+                             ConvolutionMethod method) {
+    float row[CONV_MAX_SIZE];
+    float column[CONV_MAX_SIZE];
+
+    switch (method) {
+        case CONV_METHOD_SEPARABLE:
+            if (convolution_factorize(kernel, row, column)) {
+                return separable_rows(src, dst, y0, y1, row, kernel->width / 2, column, kernel->height / 2, false);
+            }
+            return convolution_direct_rows(src, dst, y0, y1, kernel);
+        case CONV_METHOD_FFT:
+            return convolution_fft_rows(src, dst, y0, y1, kernel);
+        case CONV_METHOD_DIRECT:
+        default:
+            return convolution_direct_rows(src, dst, y0, y1, kernel);
+    }
+}
+
+bool convolution_rows(const Image* src, Image* dst, int y0, int y1, const ConvParams* kernel) {
+    float row[CONV_MAX_SIZE];
+    float column[CONV_MAX_SIZE];
+    ConvolutionMethod method = convolution_method(kernel, src->width, src->frame_height, row, column);
+    return convolution_rows_method(src, dst, y0, y1, kernel, method);
+}
+
+// Вспомогательная функция для гауссова размытия
+void apply_gaussian_blur(Image* image, float sigma) {
+    if (!image || sigma <= 0) {
+        return;
+    }
+
+    BlurParams params = { sigma };
+    apply_pass(image, pass_gaussian_blur, &params);
+}
+
+// Наибольшее окно, для которого строится сеть сравнений (для сравнения в замерах
+// допускаются окна больше MEDIAN_NETWORK_MAX_WINDOW), и число компараторов в ней
+#define MEDIAN_NETWORK_LIMIT 9
+#define MEDIAN_NETWORK_MAX_PAIRS 1024
+
+// Сеть сравнений Батчера (четно-нечетное слияние) для n элементов.
+// Возвращает число пар; сеть сортирует массив целиком.
+static int median_network_pairs(int n, unsigned char pairs[][2]) {
+    int count = 0;
+    for (int p = 1; p < n; p += p) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < n; j += 2 * k) {
+                for (int i = 0; i < k && i + j + k < n; i++) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && count < MEDIAN_NETWORK_MAX_PAIRS) {
+                        pairs[count][0] = (unsigned char)(i + j);
+                        pairs[count][1] = (unsigned char)(i + j + k);
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+// Таблица индексов столбцов с повтором крайних пикселей: cols[x + half] = clamp(x)
+static int* median_column_table(int width, int half) {
+    int* cols = (int*)malloc(sizeof(int) * (width + 2 * half + 1));
+    if (!cols) {
+        return NULL;
+    }
+
+    for (int i = 0; i < width + 2 * half + 1; i++) {
+        int x = i - half;
+        cols[i] = x < 0 ? 0 : (x >= width ? width - 1 : x);
+    }
+    return cols;
+}
+
+// Медиана для малых окон: значения окна упорядочиваются сетью сравнений без
+// ветвлений, отдельно по каждому каналу. Результат совпадает с полной сортировкой.
+bool median_network_rows(const Image* src, Image* dst, int y0, int y1, int window) {
+    if (window < 1 || window % 2 == 0 || window > MEDIAN_NETWORK_LIMIT) {
+        return false;
+    }
+
+    int width = src->width;
+    int height = src->height;
+    int half = window / 2;
+    int n = window * window;
+
+    unsigned char pairs[MEDIAN_NETWORK_MAX_PAIRS][2];
+    int pair_count = median_network_pairs(n, pairs);
+
+    int* cols = median_column_table(width, half);
+    if (!cols) {
+        log_error("Memory allocation failed for median filter\n");
+        return false;
+    }
+
+    const Color* rows[MEDIAN_NETWORK_LIMIT];
+    float r[MEDIAN_NETWORK_LIMIT * MEDIAN_NETWORK_LIMIT];
+    float g[MEDIAN_NETWORK_LIMIT * MEDIAN_NETWORK_LIMIT];
+    float b[MEDIAN_NETWORK_LIMIT * MEDIAN_NETWORK_LIMIT];
+
+    for (int y = y0; y < y1; y++) {
+        for (int dy = 0; dy < window; dy++) {
+            int ny = y + dy - half;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
+            rows[dy] = src->data + (size_t)ny * width;
+        }
+
+        for (int x = 0; x < width; x++) {
+            int count = 0;
+            for (int dy = 0; dy < window; dy++) {
+                for (int dx = 0; dx < window; dx++) {
+                    Color pixel = rows[dy][cols[x + dx]];
+                    r[count] = pixel.r;
+                    g[count] = pixel.g;
+                    b[count] = pixel.b;
+                    count++;
+                }
+            }
+
+            for (int i = 0; i < pair_count; i++) {
+                int lo = pairs[i][0];
+                int hi = pairs[i][1];
+                float a;
+
+                a = r[lo]; r[lo] = a < r[hi] ? a : r[hi]; r[hi] = a < r[hi] ? r[hi] : a;
+                a = g[lo]; g[lo] = a < g[hi] ? a : g[hi]; g[hi] = a < g[hi] ? g[hi] : a;
+                a = b[lo]; b[lo] = a < b[hi] ? a : b[hi]; b[hi] = a < b[hi] ? b[hi] : a;
+            }
+
+            dst->data[(size_t)y * width + x] = color_clamp(color_create(r[n / 2], g[n / 2], b[n / 2]));
+        }
+    }
+
+    free(cols);
+    return true;
+}
+
+void apply_median_network(Image* image, int window) {
+    if (!image || window < 1 || window % 2 == 0 || window > MEDIAN_NETWORK_LIMIT) {
+        return;
+    }
+
+    Image* dst = pass_target(image);
+    if (!dst) {
+        log_error("Cannot create temporary image for median filter\n");
+        return;
+    }
+
+    pass_commit(image, dst, median_network_rows(image, dst, 0, image->height, window));
+}
+
+static uint8_t median_quantize(float value) {
+    if (value <= 0.0f) return 0;
+    if (value >= 1.0f) return 255;
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+// Медиана для больших окон (метод Хуанга): для каждой строки ведется гистограмма
+// окна по 8-битным уровням каждого канала. При сдвиге на пиксель вычитается
+// уходящий столбец и добавляется новый, медиана сдвигается от предыдущей,
+// поэтому стоимость на пиксель растет линейно с размером окна, а не квадратично.
+// Для изображений из 24-битных BMP квантование не меняет результат.
+bool median_histogram_rows(const Image* src, Image* dst, int y0, int y1, int window) {
+    if (window < 1 || window % 2 == 0) {
+        return false;
+    }
+
+    int width = src->width;
+    int height = src->height;
+    int half = window / 2;
+    int mid = (window * window) / 2;
+
+    // Квантуются только строки, попадающие в окна строк [y0, y1)
+    int top = y0 - half > 0 ? y0 - half : 0;
+    int bottom = y1 + half < height ? y1 + half : height;
+
+    uint8_t* levels = (uint8_t*)buffer_pool_acquire((size_t)width * (bottom - top) * 3, false);
+    int* cols = median_column_table(width, half);
+    const uint8_t** rows = (const uint8_t**)malloc(sizeof(uint8_t*) * window);
+    if (!levels || !cols || !rows) {
+        log_error("Memory allocation failed for median filter\n");
+        buffer_pool_release(levels);
+        free(cols);
+        free(rows);
+        return false;
+    }
+
+    const Color* pixels = src->data + (size_t)top * width;
+    for (size_t i = 0; i < (size_t)width * (bottom - top); i++) {
+        levels[3 * i] = median_quantize(pixels[i].r);
+        levels[3 * i + 1] = median_quantize(pixels[i].g);
+        levels[3 * i + 2] = median_quantize(pixels[i].b);
+    }
+
+    for (int y = y0; y < y1; y++) {
+        for (int dy = 0; dy < window; dy++) {
+            int ny = y + dy - half;
+            if (ny < 0) ny = 0;
+            if (ny >= height) ny = height - 1;
+            rows[dy] = levels + (size_t)(ny - top) * width * 3;
+        }
+
+        int hist[3][256];
+        int median[3] = {0, 0, 0};
+        int below[3] = {0, 0, 0};   // число значений окна меньше median
+        memset(hist, 0, sizeof(hist));
+
+        for (int dy = 0; dy < window; dy++) {
+            for (int dx = 0; dx < window; dx++) {
+                const uint8_t* px = rows[dy] + 3 * cols[dx];
+                hist[0][px[0]]++;
+                hist[1][px[1]]++;
+                hist[2][px[2]]++;
+            }
+        }
+
+        for (int x = 0; x < width; x++) {
+            if (x > 0) {
+                int out_col = cols[x - 1];            // clamp(x - half - 1)
+                int in_col = cols[x + 2 * half];      // clamp(x + half)
+
+                for (int dy = 0; dy < window; dy++) {
+                    const uint8_t* out_px = rows[dy] + 3 * out_col;
+                    const uint8_t* in_px = rows[dy] + 3 * in_col;
+                    for (int c = 0; c < 3; c++) {
+                        hist[c][out_px[c]]--;
+                        if (out_px[c] < median[c]) below[c]--;
+                        hist[c][in_px[c]]++;
+                        if (in_px[c] < median[c]) below[c]++;
+                    }
+                }
+            }
+
+            float value[3];
+            for (int c = 0; c < 3; c++) {
+                while (below[c] > mid) {
+                    median[c]--;
+                    below[c] -= hist[c][median[c]];
+                }
+                while (below[c] + hist[c][median[c]] <= mid) {
+                    below[c] += hist[c][median[c]];
+                    median[c]++;
+                }
+                value[c] = median[c] / 255.0f;
+            }
+
+            dst->data[(size_t)y * width + x] = color_create(value[0], value[1], value[2]);
+        }
+    }
+
+    free(rows);
+    free(cols);
+    buffer_pool_release(levels);
+    return true;
+}
+
+void apply_median_histogram(Image* image, int window) {
+    if (!image || window < 1 || window % 2 == 0) {
+        return;
+    }
+
+    Image* dst = pass_target(image);
+    if (!dst) {
+        log_error("Cannot create temporary image for median filter\n");
+        return;
+    }
+
+    pass_commit(image, dst, median_histogram_rows(image, dst, 0, image->height, window));
+}
+
+// Приближение гауссова размытия тремя расширенными боксами (Gwosdek и др.):
+// бокс радиуса r с дробным весом отсчетов на расстоянии r + 1 подбирается так,
+// чтобы дисперсия трех проходов была точно σ². Каждый проход - скользящая
+// сумма, поэтому стоимость на пиксель не зависит от σ.
+#define GAUSSIAN_BOX_PASSES 3
+
+// Вертикальные скользящие суммы ведутся в целых числах с фиксированной точкой:
+// прибавление и вычитание строки точны, поэтому суммы не накапливают ошибку,
+// не требуют пересчета и не зависят от разбиения на полосы. Масштаб 2^24 -
+// точность float для значений около 1.
+#define BOX_FIXED_ONE 16777216.0f
+
+static int64_t box_fixed(float value) {
+    return (int64_t)(value * BOX_FIXED_ONE);
+}
+
+typedef struct {
+    int radius;
+    float inner;   // вес отсчетов с |k| <= radius
+    float outer;   // вес отсчетов с |k| = radius + 1
+} BoxKernel;
+
+static BoxKernel gaussian_box_kernel(float sigma) {
+    double variance = (double)sigma * sigma / GAUSSIAN_BOX_PASSES;
+    int r = (int)floor(0.5 * sqrt(12.0 * variance + 1.0) - 0.5);
+    double alpha = (2 * r + 1) * (3.0 * variance - r * (r + 1)) / (6.0 * ((r + 1) * (r + 1) - variance));
+
+    BoxKernel box;
+    box.radius = r;
+    box.inner = (float)(1.0 / (2 * r + 1 + 2 * alpha));
+    box.outer = (float)(alpha / (2 * r + 1 + 2 * alpha));
+    return box;
+}
+
+// Запас строк (и столбцов) для passes проходов: каждый читает r + 1 отсчетов вокруг
+static int box_cascade_halo(int radius, int passes) {
+    return passes * (radius + 1);
+}
+
+// Один проход бокса по отрезку: out[i] для i в [0, count), in[i] соответствует
+// той же позиции и доступен на r + 1 отсчетов за обоими концами отрезка
+static void box_blur_span(const Color* in, Color* out, int count, BoxKernel box) {
+    int r = box.radius;
+    double sr = 0.0, sg = 0.0, sb = 0.0;
+
+    for (int k = -r; k <= r; k++) {
+        sr += in[k].r;
+        sg += in[k].g;
+        sb += in[k].b;
+    }
+
+    // Обычный бокс (outer = 0) не читает отсчеты за окном
+    if (box.outer == 0.0f) {
+        for (int i = 0; i < count; i++) {
+            if (i > 0) {
+                sr += in[i + r].r - in[i - r - 1].r;
+                sg += in[i + r].g - in[i - r - 1].g;
+                sb += in[i + r].b - in[i - r - 1].b;
+            }
+
+            out[i].r = (float)(box.inner * sr);
+            out[i].g = (float)(box.inner * sg);
+            out[i].b = (float)(box.inner * sb);
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            sr += in[i + r].r - in[i - r - 1].r;
+            sg += in[i + r].g - in[i - r - 1].g;
+            sb += in[i + r].b - in[i - r - 1].b;
+        }
+
+        out[i].r = (float)(box.inner * sr + box.outer * (in[i - r - 1].r + in[i + r + 1].r));
+        out[i].g = (float)(box.inner * sg + box.outer * (in[i - r - 1].g + in[i + r + 1].g));
+        out[i].b = (float)(box.inner * sb + box.outer * (in[i - r - 1].b + in[i + r + 1].b));
+    }
+}
+
+// Ступени размытия: 0 - строки источника после горизонтальных проходов,
+// 1..passes - вертикальные проходы. Каждая ступень вычисляет строки по порядку и
+// хранит последние 2r + 3 строки - ровно окно следующей ступени.
+// Повторяются только крайние пиксели источника, а промежуточные проходы
+// продолжаются за край кадра, как если бы размывался расширенный источник:
+// так края обрабатываются так же, как в точном фильтре.
+typedef struct {
+    const Image* src;
+    BoxKernel box;
+    int passes;
+    int width;
+    int height;
+    int margin;                           // запас строки за краями, passes * (r + 1)
+    int slots;
+    Color* temp[2];                       // строки с запасом margin с каждой стороны
+    Color* rings[GAUSSIAN_BOX_PASSES + 1];
+    int64_t* sums[GAUSSIAN_BOX_PASSES + 1];   // суммы окна в BOX_FIXED_ONE
+    int start[GAUSSIAN_BOX_PASSES + 1];   // первая строка ступени
+    int next[GAUSSIAN_BOX_PASSES + 1];    // следующая вычисляемая строка
+} BoxBlur;
+
+static const Color* box_blur_stage_row(BoxBlur* blur, int stage, int y);
+
+static int box_blur_mod(int value, int divisor) {
+    int rest = value % divisor;
+    return rest < 0 ? rest + divisor : rest;
+}
+
+static Color* box_blur_ring_row(const BoxBlur* blur, int stage, int y) {
+    return blur->rings[stage] + (size_t)box_blur_mod(y, blur->slots) * blur->width;
+}
+
+static void box_blur_produce(BoxBlur* blur, int stage, int y) {
+    int width = blur->width;
+    int r = blur->box.radius;
+    Color* out = box_blur_ring_row(blur, stage, y);
+
+    if (stage == 0) {
+        int margin = blur->margin;
+        const Color* in = blur->src->data + (size_t)y * width;
+        Color* ext = blur->temp[0];
+        Color* mid = blur->temp[1];
+
+        for (int i = 0; i < margin; i++) {
+            ext[i] = in[0];
+            ext[margin + width + i] = in[width - 1];
+        }
+        memcpy(ext + margin, in, sizeof(Color) * width);
+
+        // Каждый проход, кроме последнего, считается и на запасе, нужном следующим
+        for (int p = 1; p < blur->passes; p++) {
+            int pad = margin - p * (r + 1);
+            box_blur_span(ext + margin - pad, mid + margin - pad, width + 2 * pad, blur->box);
+            Color* swap = ext;
+            ext = mid;
+            mid = swap;
+        }
+        box_blur_span(ext + margin, out, width, blur->box);
+        return;
+    }
+
+    // Строки Color обрабатываются как 3 * width отсчетов float
+    int count = 3 * width;
+    int64_t* sums = blur->sums[stage];
+    if (y == blur->start[stage]) {
+        memset(sums, 0, sizeof(int64_t) * count);
+        for (int k = -r; k <= r; k++) {
+            const float* row = (const float*)box_blur_stage_row(blur, stage - 1, y + k);
+            for (int i = 0; i < count; i++) {
+                sums[i] += box_fixed(row[i]);
+            }
+        }
+    } else {
+        const float* add = (const float*)box_blur_stage_row(blur, stage - 1, y + r);
+        const float* sub = (const float*)box_blur_stage_row(blur, stage - 1, y - r - 1);
+        for (int i = 0; i < count; i++) {
+            sums[i] += box_fixed(add[i]) - box_fixed(sub[i]);
+        }
+    }
+
+    float* values = (float*)out;
+    float inner = blur->box.inner / BOX_FIXED_ONE;
+    if (blur->box.outer == 0.0f) {
+        for (int i = 0; i < count; i++) {
+            values[i] = inner * (float)sums[i];
+        }
+        return;
+    }
+
+    const float* above = (const float*)box_blur_stage_row(blur, stage - 1, y - r - 1);
+    const float* below = (const float*)box_blur_stage_row(blur, stage - 1, y + r + 1);
+    for (int i = 0; i < count; i++) {
+        values[i] = inner * (float)sums[i] + blur->box.outer * (above[i] + below[i]);
+    }
+}
+
+// Строка y ступени; ступень досчитывается до y. Крайние строки повторяются
+// только у ступени 0, остальные ступени продолжаются за край кадра.
+static const Color* box_blur_stage_row(BoxBlur* blur, int stage, int y) {
+    if (stage == 0) {
+        if (y < 0) y = 0;
+        if (y >= blur->height) y = blur->height - 1;
+    }
+
+    while (blur->next[stage] <= y) {
+        box_blur_produce(blur, stage, blur->next[stage]);
+        blur->next[stage]++;
+    }
+    return box_blur_ring_row(blur, stage, y);
+}
+
+// passes проходов бокса box (не больше GAUSSIAN_BOX_PASSES) по строкам [y0, y1)
+static bool box_cascade_rows(const Image* src, Image* dst, int y0, int y1, BoxKernel box, int passes) {
+    BoxBlur blur;
+    memset(&blur, 0, sizeof(blur));
+    blur.src = src;
+    blur.box = box;
+    blur.passes = passes;
+    blur.width = src->width;
+    blur.height = src->height;
+    blur.margin = passes * (box.radius + 1);
+    blur.slots = 2 * blur.box.radius + 3;
+
+    int width = src->width;
+    int r = blur.box.radius;
+    size_t temp_size = (size_t)width + 2 * blur.margin;
+    blur.temp[0] = (Color*)buffer_pool_acquire(sizeof(Color) * temp_size * 2, false);
+    blur.temp[1] = blur.temp[0] ? blur.temp[0] + temp_size : NULL;
+
+    bool ok = blur.temp[0] != NULL;
+    for (int s = 0; s <= passes; s++) {
+        blur.rings[s] = (Color*)buffer_pool_acquire(sizeof(Color) * (size_t)width * blur.slots, false);
+        blur.sums[s] = s > 0 ? (int64_t*)buffer_pool_acquire(sizeof(int64_t) * 3 * (size_t)width, false) : NULL;
+        ok = ok && blur.rings[s] && (s == 0 || blur.sums[s]);
+    }
+
+    if (ok) {
+        // Каждая ступень начинается так, чтобы покрыть окна следующей
+        blur.start[passes] = y0;
+        for (int s = passes - 1; s >= 1; s--) {
+            blur.start[s] = blur.start[s + 1] - r - 1;
+        }
+        blur.start[0] = blur.start[1] - r - 1 > 0 ? blur.start[1] - r - 1 : 0;
+        for (int s = 0; s <= passes; s++) {
+            blur.next[s] = blur.start[s];
+        }
+
+        for (int y = y0; y < y1; y++) {
+            const float* row = (const float*)box_blur_stage_row(&blur, passes, y);
+            float* out = (float*)(dst->data + (size_t)y * width);
+            for (int i = 0; i < 3 * width; i++) {
+                float value = row[i];
+                out[i] = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            }
+        }
+    } else {
+        log_error("Memory allocation failed for box blur\n");
+    }
+
+    for (int s = 0; s <= passes; s++) {
+        buffer_pool_release(blur.rings[s]);
+        buffer_pool_release(blur.sums[s]);
+    }
+    buffer_pool_release(blur.temp[0]);
+    return ok;
+}
+
+bool gaussian_box_rows(const Image* src, Image* dst, int y0, int y1, float sigma) {
+    if (sigma <= 0) {
+        return false;
+    }
+    return box_cascade_rows(src, dst, y0, y1, gaussian_box_kernel(sigma), GAUSSIAN_BOX_PASSES);
+}
+
+// Обычный бокс: один проход с равными весами и скользящими суммами по строкам
+// и столбцам, стоимость на пиксель не зависит от радиуса
+bool box_blur_rows(const Image* src, Image* dst, int y0, int y1, int radius) {
+    if (radius < 1) {
+        return false;
+    }
+
+    BoxKernel box = { radius, 1.0f / (2 * radius + 1), 0.0f };
+    return box_cascade_rows(src, dst, y0, y1, box, 1);
+}
+
+// Вспомогательная функция для нахождения медианного цвета
+Color get_median_color(Color* colors, int count) {
+    if (count <= 0) {
+        return color_create(0, 0, 0);
+    }
+
+    // Простая реализация - возвращаем средний цвет
+    Color sum = color_create(0, 0, 0);
+    for (int i = 0; i < count; i++) {
+        sum = color_add(sum, colors[i]);
+    }
+
+    return color_mul(sum, 1.0f / count);
+}
+
+// Запас строк для фильтров на основе матрицы 3x3
+static int halo_matrix(const void* params) {
+    return 1;
+}
+
+static int halo_median(const void* params) {
+    return ((const MedianParams*)params)->window_size / 2;
+}
+
+static int halo_gaussian_blur(const void* params) {
+    float sigma = ((const BlurParams*)params)->sigma;
+    if (sigma >= GAUSSIAN_BOX_MIN_SIGMA) {
+        return box_cascade_halo(gaussian_box_kernel(sigma).radius, GAUSSIAN_BOX_PASSES);
+    }
+    // Совпадает с радиусом ядра в gaussian_blur_rows
+    return (int)ceil(3 * sigma);
+}
+
+static int halo_convolve(const void* params) {
+    return ((const ConvParams*)params)->height / 2;
+}
+
+static int halo_box_blur(const void* params) {
+    return box_cascade_halo(((const BoxBlurParams*)params)->radius, 1);
+}
+
+// Поля контекста для переноса обрезки в чтение: по вертикали совпадают с
+// halo, по горизонтали у всех фильтров, кроме свертки, такие же
+static void margins_point(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = 0;
+    *margin_y = 0;
+}
+
+static void margins_matrix(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = *margin_y = halo_matrix(params);
+}
+
+static void margins_median(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = *margin_y = halo_median(params);
+}
+
+static void margins_gaussian_blur(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = *margin_y = halo_gaussian_blur(params);
+}
+
+static void margins_convolve(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = ((const ConvParams*)params)->width / 2;
+    *margin_y = halo_convolve(params);
+}
+
+// По горизонтали окно читает r + 1 столбцов, по вертикали - строки каскада
+static void margins_box_blur(const void* params, int* margin_x, int* margin_y) {
+    *margin_x = ((const BoxBlurParams*)params)->radius + 1;
+    *margin_y = halo_box_blur(params);
+}
+
+// Обрезка в любом формате: строки сдвигаются к началу того же буфера
+static void pixel_crop(PixelImage* image, void* params) {
+    CropParams* crop = (CropParams*)params;
+    ImageRegion region;
+    if (!crop_clip(crop, image->width, image->height, &region)) {
+        log_error("Invalid crop %dx%d at (%d, %d) for %dx%d image\n", crop->width, crop->height,
+                  crop->x, crop->y, image->width, image->height);
+        return;
+    }
+
+    int planes = pixel_format_is_planar(image->format) ? 3 : 1;
+    size_t pixel_bytes = (size_t)pixel_format_channel_bytes(image->format) * (planes == 3 ? 1 : 3);
+    size_t row_bytes = pixel_bytes * region.width;
+    size_t new_stride = (row_bytes + 15) & ~(size_t)15;
+
+    // Новое положение каждой строки не дальше старого, поэтому копируем по порядку
+    for (int p = 0; p < planes; p++) {
+        uint8_t* plane = image->buffer + new_stride * region.height * p;
+        for (int y = 0; y < region.height; y++) {
+            memmove(plane + new_stride * y,
+                    pixel_image_row(image, p, region.y + y) + pixel_bytes * region.x, row_bytes);
+        }
+        image->planes[p] = plane;
+    }
+
+    image->width = region.width;
+    image->height = region.height;
+    image->stride = (ptrdiff_t)new_stride;
+}
+
+// Изменение размера с заменой буфера изображения
+static void pixel_resize(PixelImage* image, void* params) {
+    ResizeParams* resize = (ResizeParams*)params;
+    PixelImage* resized = resample_pixels(image, resize->width, resize->height, resize->method);
+    if (!resized) {
+        log_error("Cannot resize image to %dx%d\n", resize->width, resize->height);
+        return;
+    }
+
+    buffer_pool_release(image->buffer);
+    *image = *resized;
+    free(resized);
+}
+
+// Негатив для целочисленных форматов
+static void pixel_negative(PixelImage* image, void* params) {
+    int planes = pixel_format_is_planar(image->format) ? 3 : 1;
+    int values = image->width * (planes == 3 ? 1 : 3);
+
+    for (int p = 0; p < planes; p++) {
+        for (int y = 0; y < image->height; y++) {
+            if (pixel_format_channel_bytes(image->format) == 1) {
+                uint8_t* row = pixel_image_row(image, p, y);
+                for (int i = 0; i < values; i++) row[i] = (uint8_t)(255 - row[i]);
+            } else {
+                uint16_t* row = (uint16_t*)pixel_image_row(image, p, y);
+                for (int i = 0; i < values; i++) row[i] = (uint16_t)(65535 - row[i]);
+            }
+        }
+    }
+}
+
+// Градации серого для целочисленных форматов (веса как в color_luminance)
+static void pixel_grayscale(PixelImage* image, void* params) {
+    for (int y = 0; y < image->height; y++) {
+        switch (image->format) {
+            case PIXEL_FORMAT_BGR_U8: {
+                uint8_t* row = pixel_image_row(image, 0, y);
+                for (int x = 0; x < image->width; x++) {
+                    uint8_t* px = row + 3 * x;
+                    uint8_t gray = (uint8_t)((114 * px[0] + 587 * px[1] + 299 * px[2] + 500) / 1000);
+                    px[0] = px[1] = px[2] = gray;
+                }
+                break;
+            }
+            case PIXEL_FORMAT_RGB_U16: {
+                uint16_t* row = (uint16_t*)pixel_image_row(image, 0, y);
+                for (int x = 0; x < image->width; x++) {
+                    uint16_t* px = row + 3 * x;
+                    uint16_t gray = (uint16_t)((299u * px[0] + 587u * px[1] + 114u * px[2] + 500) / 1000);
+                    px[0] = px[1] = px[2] = gray;
+                }
+                break;
+            }
+            case PIXEL_FORMAT_PLANAR_U8: {
+                uint8_t* r = pixel_image_row(image, 0, y);
+                uint8_t* g = pixel_image_row(image, 1, y);
+                uint8_t* b = pixel_image_row(image, 2, y);
+                for (int x = 0; x < image->width; x++) {
+                    r[x] = g[x] = b[x] = (uint8_t)((299 * r[x] + 587 * g[x] + 114 * b[x] + 500) / 1000);
+                }
+                break;
+            }
+            case PIXEL_FORMAT_PLANAR_U16: {
+                uint16_t* r = (uint16_t*)pixel_image_row(image, 0, y);
+                uint16_t* g = (uint16_t*)pixel_image_row(image, 1, y);
+                uint16_t* b = (uint16_t*)pixel_image_row(image, 2, y);
+                for (int x = 0; x < image->width; x++) {
+                    r[x] = g[x] = b[x] = (uint16_t)((299u * r[x] + 587u * g[x] + 114u * b[x] + 500) / 1000);
+                }
+                break;
+            }
+            default:
+                return;
+        }
+    }
+}
+
+// Описание поточечных фильтров для слияния в пайплайне
+static const float grayscale_matrix[3][4] = {
+    {0.299f, 0.587f, 0.114f, 0.0f},
+    {0.299f, 0.587f, 0.114f, 0.0f},
+    {0.299f, 0.587f, 0.114f, 0.0f}
+};
+
+static const float negative_matrix[3][4] = {
+    {-1.0f,  0.0f,  0.0f, 1.0f},
+    { 0.0f, -1.0f,  0.0f, 1.0f},
+    { 0.0f,  0.0f, -1.0f, 1.0f}
+};
+
+static void point_matrix(PointOp* op, const float matrix[3][4]) {
+    op->type = POINT_OP_MATRIX;
+    memcpy(op->matrix, matrix, sizeof(op->matrix));
+    op->intensity = 0.0f;
+}
+
+static bool point_grayscale(const void* params, PointOp* op) {
+    point_matrix(op, grayscale_matrix);
+    return true;
+}
+
+static bool point_negative(const void* params, PointOp* op) {
+    point_matrix(op, negative_matrix);
+    return true;
+}
+
+static bool point_sepia(const void* params, PointOp* op) {
+    point_matrix(op, sepia_matrix);
+    return true;
+}
+
+static bool point_vignette(const void* params, PointOp* op) {
+    const VignetteParams* vignette = (const VignetteParams*)params;
+    float intensity = vignette ? vignette->intensity : 0.8f;
+
+    op->type = POINT_OP_VIGNETTE;
+    memset(op->matrix, 0, sizeof(op->matrix));
+    op->intensity = intensity < 0 ? 0 : (intensity > 1 ? 1 : intensity);
+    return true;
+}
+
+#define FORMATS_INTEGER (PIXEL_FORMAT_MASK_ALL & ~PIXEL_FORMAT_MASK(PIXEL_FORMAT_RGB_F32))
+
+static const FilterTraits filter_traits[] = {
+    { filter_crop,           NULL,                NULL,               PIXEL_FORMAT_MASK_ALL, pixel_crop,      NULL,            NULL,                NULL },
+    { filter_resize,         NULL,                NULL,               FORMATS_INTEGER,       pixel_resize,    NULL,            NULL,                NULL },
+    { filter_grayscale,      band_grayscale,      NULL,               FORMATS_INTEGER,       pixel_grayscale, point_grayscale, NULL,                margins_point },
+    { filter_negative,       band_negative,       NULL,               FORMATS_INTEGER,       pixel_negative,  point_negative,  NULL,                margins_point },
+    { filter_sepia,          band_sepia,          NULL,               0,                     NULL,            point_sepia,     NULL,                margins_point },
+    { filter_vignette,       band_vignette,       NULL,               0,                     NULL,            point_vignette,  NULL,                NULL },
+    { filter_sharpening,     band_sharpening,     halo_matrix,        0,                     NULL,            NULL,            pass_sharpening,     margins_matrix },
+    { filter_edge_detection, band_edge_detection, halo_matrix,        0,                     NULL,            NULL,            pass_edge_detection, margins_matrix },
+    { filter_emboss,         band_emboss,         halo_matrix,        0,                     NULL,            NULL,            pass_emboss,         margins_matrix },
+    { filter_convolve,       band_convolve,       halo_convolve,      0,                     NULL,            NULL,            pass_convolve,       margins_convolve },
+    { filter_median,         band_median,         halo_median,        0,                     NULL,            NULL,            pass_median,         margins_median },
+    { filter_gaussian_blur,  band_gaussian_blur,  halo_gaussian_blur, 0,                     NULL,            NULL,            pass_gaussian_blur,  margins_gaussian_blur },
+    { filter_box_blur,       band_box_blur,       halo_box_blur,      0,                     NULL,            NULL,            pass_box_blur,       margins_box_blur },
+};
+
+const FilterTraits* filter_get_traits(FilterFunc function) {
+    for (size_t i = 0; i < sizeof(filter_traits) / sizeof(filter_traits[0]); i++) {
+        if (filter_traits[i].function == function) {
+            return &filter_traits[i];
+        }
+    }
+    return NULL;
+}
+
+bool filter_supports_format(FilterFunc function, PixelFormat format) {
+    if (format == PIXEL_FORMAT_RGB_F32) {
+        return true;
+    }
+
+    const FilterTraits* traits = filter_get_traits(function);
+    return traits && traits->pixel && (traits->formats & PIXEL_FORMAT_MASK(format));
 }
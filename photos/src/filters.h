@@ -2,13 +2,37 @@
 #define FILTERS_H
 
 #include "image.h"
+#include "pixel_image.h"
+#include "resample.h"
+
+// Тип функции фильтра
+typedef void (*FilterFunc)(Image*, void*);
+
+// Тип функции фильтра для изображений в формате PixelImage
+typedef void (*PixelFilterFunc)(PixelImage*, void*);
+
+// Проход фильтра из src в dst того же размера: вычисляются строки [y0, y1)
+// приемника, источник только читается (за краями кадра повторяются крайние
+// пиксели). Разные диапазоны строк можно считать одновременно. Возвращает
+// false при нехватке памяти - тогда приемник заполнен не полностью.
+typedef bool (*FilterPassFunc)(const Image* src, Image* dst, int y0, int y1, const void* params);
 
 // Структуры параметров для фильтров
+// Обрезка: область width x height с левым верхним углом (x, y); выходящая
+// за изображение часть отбрасывается
 typedef struct {
     int width;
     int height;
+    int x;
+    int y;
 } CropParams;
 
+typedef struct {
+    int width;
+    int height;
+    ResampleMethod method;
+} ResizeParams;
+
 typedef struct {
     float threshold;
 } EdgeParams;
@@ -21,30 +45,157 @@ typedef struct {
     float sigma;
 } BlurParams;
 
+typedef struct {
+    int radius;
+} BoxBlurParams;
+
 typedef struct {
     float intensity;
 } VignetteParams;
 
+// Ядро свертки произвольного нечетного размера (веса по строкам). Если сумма
+// весов не равна нулю, результат делится на нее, как в apply_matrix_filter.
+// Параметры выделяются одним блоком: sizeof(ConvParams) + веса.
+#define CONV_MAX_SIZE 63
+typedef struct {
+    int width;
+    int height;
+    float weights[];
+} ConvParams;
+
 // Базовые фильтры
 void filter_crop(Image* image, void* params);
+void filter_resize(Image* image, void* params);
 void filter_grayscale(Image* image, void* params);
 void filter_negative(Image* image, void* params);
 void filter_sharpening(Image* image, void* params);
 void filter_edge_detection(Image* image, void* params);
 void filter_median(Image* image, void* params);
 void filter_gaussian_blur(Image* image, void* params);
+void filter_box_blur(Image* image, void* params);
+void filter_emboss(Image* image, void* params);
+void filter_convolve(Image* image, void* params);
 
 // Дополнительные фильтры
 void filter_sepia(Image* image, void* params);
 void filter_vignette(Image* image, void* params);
 
-// Вспомогательные функции
+// Вспомогательные функции. Фильтры с окрестностью записывают результат в
+// буфер из пула и обмениваются с ним данными, копия источника не создается.
 void apply_matrix_filter(Image* image, float kernel[3][3], float divisor);
 void apply_gaussian_blur(Image* image, float sigma);
 Color get_median_color(Color* colors, int count);
 
-// Утилиты фильтров
-void filter_box_blur(Image* image, int radius);
-void filter_emboss(Image* image);
+// Те же фильтры как проходы из src в dst (строки [y0, y1) приемника)
+bool matrix_filter_rows(const Image* src, Image* dst, int y0, int y1,
+                        float kernel[3][3], float divisor);
+
+// Известные ядра 3x3: внутренняя часть строки специализирована при компиляции
+// (без нулевых весов и проверок границ), результат совпадает с matrix_filter_rows
+typedef enum {
+    KERNEL3X3_SHARPEN,
+    KERNEL3X3_LAPLACIAN,
+    KERNEL3X3_EMBOSS
+} Kernel3x3;
+
+bool kernel3x3_rows(const Image* src, Image* dst, int y0, int y1, Kernel3x3 kernel);
+
+// Способ свертки ядром ConvParams
+typedef enum {
+    CONV_METHOD_DIRECT,     // прямая сумма по ненулевым весам
+    CONV_METHOD_SEPARABLE,  // ядро ранга 1: два одномерных прохода
+    CONV_METHOD_FFT         // произведение спектров по плиткам (fft.h)
+} ConvolutionMethod;
+
+// Самый быстрый способ по оценке времени для кадра frame_width x frame_height;
+// row и column заполняются, как в convolution_factorize
+ConvolutionMethod convolution_method(const ConvParams* kernel, int frame_width, int frame_height,
+                                     float* row, float* column);
+
+// Свертка ядром ConvParams способом convolution_method
+bool convolution_rows(const Image* src, Image* dst, int y0, int y1, const ConvParams* kernel);
+
+// Свертка заданным способом (нераскладываемое ядро при CONV_METHOD_SEPARABLE
+// считается прямо); для замеров и сравнения способов
+bool convolution_rows_method(const Image* src, Image* dst, int y0, int y1, const ConvParams* kernel,
+                             ConvolutionMethod method);
+
+// Разложение ядра ранга 1: kernel = column * row (с учетом нормировки).
+// row - width весов, column - height. Возвращает false, если ядро не раскладывается.
+bool convolution_factorize(const ConvParams* kernel, float* row, float* column);
+bool gaussian_blur_rows(const Image* src, Image* dst, int y0, int y1, float sigma);
+
+// Вертикальная свертка ядром из taps строк: out[y] = sum(window[y + k] * kernel[k]),
+// y = 0..rows-1, по count float в строке (окно - rows + taps - 1 строк)
+void convolve_vertical(const float* const* window, const float* kernel, int taps,
+                       float* const* out, int rows, int count);
+
+// Гауссово размытие тремя расширенными боксами: стоимость на пиксель не зависит
+// от σ. Фильтр размытия выбирает его начиная с GAUSSIAN_BOX_MIN_SIGMA (порог и
+// погрешность относительно точного ядра - bench/bench.c blur).
+#define GAUSSIAN_BOX_MIN_SIGMA 20.0f
+bool gaussian_box_rows(const Image* src, Image* dst, int y0, int y1, float sigma);
+
+// Размытие квадратным окном (2r+1)x(2r+1) со скользящими суммами
+bool box_blur_rows(const Image* src, Image* dst, int y0, int y1, int radius);
+
+// Медианный фильтр: сети сортировки для окон до MEDIAN_NETWORK_MAX_WINDOW,
+// скользящие гистограммы для больших окон (порог по bench/bench.c median)
+#define MEDIAN_NETWORK_MAX_WINDOW 3
+void apply_median_network(Image* image, int window);
+void apply_median_histogram(Image* image, int window);
+bool median_network_rows(const Image* src, Image* dst, int y0, int y1, int window);
+bool median_histogram_rows(const Image* src, Image* dst, int y0, int y1, int window);
+
+// Поточечная операция: аффинное преобразование цвета или виньетка
+typedef enum {
+    POINT_OP_MATRIX,
+    POINT_OP_VIGNETTE
+} PointOpType;
+
+typedef struct {
+    PointOpType type;
+    float matrix[3][4];   // out = M * (r, g, b, 1) для POINT_OP_MATRIX
+    float intensity;      // для POINT_OP_VIGNETTE
+} PointOp;
+
+// Область обрезки внутри изображения width x height; false, если она пуста
+bool crop_clip(const CropParams* crop, int width, int height, ImageRegion* region);
+
+// Свойства фильтра для параллельного исполнителя пайплайна.
+// band обрабатывает полосу строк без вывода сообщений; halo возвращает
+// число строк контекста сверху и снизу, нужных фильтру (NULL - поточечный).
+// formats - маска форматов PixelImage, которые pixel обрабатывает без
+// преобразования в Color (RGB_F32 поддерживается всеми фильтрами через function).
+// point описывает поточечный фильтр как PointOp (NULL - фильтр не поточечный).
+// pass - проход из src в dst для фильтров с окрестностью: пайплайн держит два
+// буфера кадра и после прохода меняет их местами.
+// margins - поля контекста по x и y для фильтров, результат которых не зависит
+// от положения в кадре (NULL - зависит или меняет размер): через такие фильтры
+// обрезка переносится в чтение файла (pipeline_plan_region).
+typedef struct {
+    FilterFunc function;
+    FilterFunc band;
+    int (*halo)(const void* params);
+    unsigned formats;
+    PixelFilterFunc pixel;
+    bool (*point)(const void* params, PointOp* op);
+    FilterPassFunc pass;
+    void (*margins)(const void* params, int* margin_x, int* margin_y);
+} FilterTraits;
+
+// Свойства фильтра или NULL для неизвестных фильтров
+const FilterTraits* filter_get_traits(FilterFunc function);
+
+// Может ли фильтр работать с изображением в формате format без преобразования
+bool filter_supports_format(FilterFunc function, PixelFormat format);
+
+// Слияние цепочки поточечных операций: соседние матрицы перемножаются, пока
+// промежуточный результат гарантированно остается в [0, 1]. Возвращает число
+// операций в out (не больше count).
+int point_ops_fuse(const PointOp* ops, int count, PointOp* out);
+
+// Применение цепочки операций за один проход по изображению (или полосе кадра)
+void apply_point_ops(Image* image, const PointOp* ops, int count);
 
 #endif // FILTERS_H
\ No newline at end of file
@@ -1,29 +1,45 @@
 #include "image.h"
+#include "buffer_pool.h"
+#include "resample.h"
+#include "log.h"
+#include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <assert.h>
 #include <stdio.h>
 
-Image* image_create(int width, int height) {
+// Создание изображения; буфер пикселей берется из пула, zero - обнулить пиксели
+static Image* image_allocate(int width, int height, bool zero) {
     if (width <= 0 || height <= 0) {
-        fprintf(stderr, "Error: Invalid image dimensions %dx%d\n", width, height);
+        log_error("Invalid image dimensions %dx%d\n", width, height);
+        return NULL;
+    }
+
+    // Число пикселей хранится в int: размеры из заголовка (например, сжатого
+    // RLE файла) могут его переполнить
+    if ((long long)width * height > INT_MAX ||
+        (unsigned long long)width * height > SIZE_MAX / sizeof(Color)) {
+        log_error("Image is too large (%dx%d)\n", width, height);
         return NULL;
     }
 
     Image* image = (Image*)malloc(sizeof(Image));
     if (!image) {
-        fprintf(stderr, "Error: Memory allocation failed for image structure\n");
+        log_error("Memory allocation failed for image structure\n");
         return NULL;
     }
 
     image->width = width;
     image->height = height;
     image->capacity = width * height;
+    image->frame_y = 0;
+    image->frame_height = height;
 
-    image->data = (Color*)calloc(image->capacity, sizeof(Color));
+    image->data = (Color*)buffer_pool_acquire(sizeof(Color) * (size_t)image->capacity, zero);
     if (!image->data) {
-        fprintf(stderr, "Error: Memory allocation failed for image data\n");
+        log_error("Memory allocation failed for image data\n");
         free(image);
         return NULL;
     }
@@ -31,9 +47,17 @@ Image* image_create(int width, int height) {
     return image;
 }
 
+Image* image_create(int width, int height) {
+    return image_allocate(width, height, true);
+}
+
+Image* image_create_scratch(int width, int height) {
+    return image_allocate(width, height, false);
+}
+
 void image_destroy(Image* image) {
     if (image) {
-        free(image->data);
+        buffer_pool_release(image->data);
         free(image);
     }
 }
@@ -43,7 +67,7 @@ Image* image_copy(const Image* src) {
         return NULL;
     }
 
-    Image* dst = image_create(src->width, src->height);
+    Image* dst = image_create_scratch(src->width, src->height);
     if (!dst) {
         return NULL;
     }
@@ -52,6 +76,20 @@ Image* image_copy(const Image* src) {
     return dst;
 }
 
+void image_swap_data(Image* a, Image* b) {
+    if (!a || !b) {
+        return;
+    }
+
+    Color* data = a->data;
+    a->data = b->data;
+    b->data = data;
+
+    int capacity = a->capacity;
+    a->capacity = b->capacity;
+    b->capacity = capacity;
+}
+
 Color image_get_pixel(const Image* image, int x, int y) {
     if (!image || !image_is_valid_coord(image, x, y)) {
         return color_create(0, 0, 0);
@@ -77,32 +115,7 @@ void image_resize(Image* image, int new_width, int new_height) {
         return;
     }
 
-    Color* new_data = (Color*)calloc(new_width * new_height, sizeof(Color));
-    if (!new_data) {
-        return;
-    }
-
-    // Простое масштабирование (ближайший сосед)
-    float scale_x = (float)image->width / new_width;
-    float scale_y = (float)image->height / new_height;
-
-    for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            int src_x = (int)(x * scale_x);
-            int src_y = (int)(y * scale_y);
-
-            if (src_x >= image->width) src_x = image->width - 1;
-            if (src_y >= image->height) src_y = image->height - 1;
-
-            new_data[y * new_width + x] = image_get_pixel(image, src_x, src_y);
-        }
-    }
-
-    free(image->data);
-    image->data = new_data;
-    image->width = new_width;
-    image->height = new_height;
-    image->capacity = new_width * new_height;
+    image_resample(image, new_width, new_height, RESAMPLE_BICUBIC);
 }
 
 void image_fill(Image* image, Color color) {
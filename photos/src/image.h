@@ -16,15 +16,34 @@ typedef struct {
     int width;
     int height;
     int capacity;
+    // Положение в полном кадре (если изображение - полоса строк кадра)
+    int frame_y;
+    int frame_height;
 } Image;
 
-// Создание и уничтожение изображения
+// Прямоугольная область изображения
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} ImageRegion;
+
+// Создание и уничтожение изображения (буферы пикселей берутся из пула и
+// возвращаются в него, см. buffer_pool.h)
 Image* image_create(int width, int height);
 void image_destroy(Image* image);
 
+// Изображение с неинициализированными пикселями - для временных копий и
+// приемников, которые будут полностью перезаписаны
+Image* image_create_scratch(int width, int height);
+
 // Копирование изображения
 Image* image_copy(const Image* src);
 
+// Обмен буферами пикселей двух изображений одинакового размера
+void image_swap_data(Image* a, Image* b);
+
 // Получение и установка пикселей
 Color image_get_pixel(const Image* image, int x, int y);
 void image_set_pixel(Image* image, int x, int y, Color color);
@@ -32,7 +51,7 @@ void image_set_pixel(Image* image, int x, int y, Color color);
 // Проверка границ
 bool image_is_valid_coord(const Image* image, int x, int y);
 
-// Изменение размера
+// Изменение размера бикубическим фильтром (другие фильтры - resample.h)
 void image_resize(Image* image, int new_width, int new_height);
 
 // Вспомогательные функции для работы с цветом
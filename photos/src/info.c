@@ -0,0 +1,181 @@
+#include "info.h"
+#include "batch.h"
+#include "bmp.h"
+#include "threadpool.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Заголовки одного файла (без палитры: в отчет попадает только ее размер)
+typedef struct {
+    bool ok;
+    int width;
+    int height;
+    int bits_per_pixel;
+    bool top_down;
+    uint32_t compression;
+    uint32_t header_size;
+    int palette_size;
+    uint64_t file_bytes;
+} InfoEntry;
+
+typedef struct {
+    const BatchFiles* files;
+    InfoEntry* entries;
+} InfoJob;
+
+// Итоги обзора
+typedef struct {
+    int files;
+    int failed;
+    double megapixels;
+    uint64_t file_bytes;
+    uint64_t memory_bytes;
+    uint64_t peak_memory_bytes;   // наибольший буфер одного файла
+} InfoTotals;
+
+// Память буфера Color для обработки файла в памяти
+static uint64_t info_memory_bytes(const InfoEntry* entry) {
+    return (uint64_t)entry->width * (uint64_t)entry->height * sizeof(Color);
+}
+
+static double info_megapixels(const InfoEntry* entry) {
+    return (double)entry->width * entry->height / 1e6;
+}
+
+static void info_task(void* context, int index) {
+    InfoJob* job = (InfoJob*)context;
+    InfoEntry* entry = &job->entries[index];
+
+    BMPFile* file = bmp_open(job->files->paths[index]);
+    if (!file) {
+        return;
+    }
+
+    const BMPLayout* layout = bmp_file_layout(file);
+    entry->width = layout->width;
+    entry->height = layout->height;
+    entry->bits_per_pixel = layout->bits_per_pixel;
+    entry->top_down = layout->top_down;
+    entry->compression = layout->compression;
+    entry->header_size = layout->header_size;
+    entry->palette_size = layout->palette_size;
+    entry->file_bytes = bmp_file_size(file);
+    entry->ok = true;
+    bmp_close(file);
+}
+
+static void info_print_text(const BatchFiles* files, const InfoEntry* entries,
+                            const InfoTotals* totals) {
+    printf("  %-11s %4s %-14s %-6s %10s %10s %10s  %s\n",
+           "size", "bits", "compression", "header", "MP", "file MB", "memory MB", "path");
+    for (int i = 0; i < files->count; i++) {
+        const InfoEntry* entry = &entries[i];
+        if (!entry->ok) {
+            printf("  %-11s %4s %-14s %-6s %10s %10s %10s  %s\n",
+                   "-", "-", "error", "-", "-", "-", "-", files->paths[i]);
+            continue;
+        }
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", entry->width, entry->height);
+        printf("  %-11s %4d %-14s %-6s %10.2f %10.1f %10.1f  %s\n", size, entry->bits_per_pixel,
+               bmp_compression_name(entry->compression), bmp_header_name(entry->header_size),
+               info_megapixels(entry), entry->file_bytes / 1048576.0,
+               info_memory_bytes(entry) / 1048576.0, files->paths[i]);
+    }
+
+    printf("\n📋 Файлов: %d (не разобрано: %d), %.2f Мп, на диске %.1f МБ\n",
+           totals->files, totals->failed, totals->megapixels, totals->file_bytes / 1048576.0);
+    printf("   Память для обработки в памяти: всего %.1f МБ, на один файл до %.1f МБ\n",
+           totals->memory_bytes / 1048576.0, totals->peak_memory_bytes / 1048576.0);
+}
+
+static void info_print_json(const char* input, const BatchFiles* files, const InfoEntry* entries,
+                            const InfoTotals* totals, int workers, double elapsed) {
+    printf("{\n  \"input\": ");
+    stats_print_json_string(stdout, input);
+    printf(",\n  \"workers\": %d,\n  \"scan_ms\": %.3f,\n  \"files\": [", workers, elapsed * 1e3);
+
+    for (int i = 0; i < files->count; i++) {
+        const InfoEntry* entry = &entries[i];
+        printf(i > 0 ? ",\n    {\"path\": " : "\n    {\"path\": ");
+        stats_print_json_string(stdout, files->paths[i]);
+        if (!entry->ok) {
+            printf(", \"ok\": false}");
+            continue;
+        }
+
+        printf(", \"ok\": true, \"width\": %d, \"height\": %d, \"bits_per_pixel\": %d, "
+               "\"compression\": \"%s\", \"header\": \"%s\", \"top_down\": %s, \"palette_size\": %d, "
+               "\"file_bytes\": %llu, \"megapixels\": %.3f, \"memory_bytes\": %llu}",
+               entry->width, entry->height, entry->bits_per_pixel,
+               bmp_compression_name(entry->compression), bmp_header_name(entry->header_size),
+               entry->top_down ? "true" : "false", entry->palette_size,
+               (unsigned long long)entry->file_bytes, info_megapixels(entry),
+               (unsigned long long)info_memory_bytes(entry));
+    }
+
+    printf("\n  ],\n  \"total\": {\"files\": %d, \"failed\": %d, \"megapixels\": %.3f, "
+           "\"file_bytes\": %llu, \"memory_bytes\": %llu, \"peak_memory_bytes\": %llu}\n}\n",
+           totals->files, totals->failed, totals->megapixels,
+           (unsigned long long)totals->file_bytes, (unsigned long long)totals->memory_bytes,
+           (unsigned long long)totals->peak_memory_bytes);
+}
+
+bool info_scan(const char* input, int worker_count, StatsFormat format) {
+    BatchFiles files;
+    if (!batch_collect_tree(input, &files)) {
+        return false;
+    }
+
+    InfoEntry* entries = (InfoEntry*)calloc(files.count > 0 ? files.count : 1, sizeof(InfoEntry));
+    ThreadPool* pool = worker_count == 1 ? NULL : threadpool_create(worker_count);
+    if (!entries) {
+        log_error("Memory allocation failed for file info\n");
+        threadpool_destroy(pool);
+        batch_free_files(&files);
+        return false;
+    }
+
+    // Проба - открытие и разбор заголовков, поэтому задачи короткие и
+    // ограничены ожиданием диска: потоки перекрывают это ожидание
+    int workers = threadpool_get_size(pool);
+    if (workers > files.count) workers = files.count > 0 ? files.count : 1;
+    log_info("🔍 Обзор BMP: %s (%d файлов, потоков: %d)\n\n", input, files.count, workers);
+
+    InfoJob job = { &files, entries };
+    double start = stats_wall_time();
+    threadpool_run(pool, info_task, &job, files.count);
+    double elapsed = stats_wall_time() - start;
+
+    InfoTotals totals = { .files = files.count };
+    for (int i = 0; i < files.count; i++) {
+        const InfoEntry* entry = &entries[i];
+        if (!entry->ok) {
+            totals.failed++;
+            continue;
+        }
+
+        uint64_t memory = info_memory_bytes(entry);
+        totals.megapixels += info_megapixels(entry);
+        totals.file_bytes += entry->file_bytes;
+        totals.memory_bytes += memory;
+        if (memory > totals.peak_memory_bytes) {
+            totals.peak_memory_bytes = memory;
+        }
+    }
+
+    if (format == STATS_FORMAT_JSON) {
+        info_print_json(input, &files, entries, &totals, workers, elapsed);
+    } else {
+        info_print_text(&files, entries, &totals);
+        log_info("   Заголовки прочитаны за %.1f мс\n", elapsed * 1e3);
+    }
+
+    bool ok = totals.failed == 0;
+    free(entries);
+    threadpool_destroy(pool);
+    batch_free_files(&files);
+    return ok;
+}
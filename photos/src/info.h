@@ -0,0 +1,16 @@
+#ifndef INFO_H
+#define INFO_H
+
+#include "stats.h"
+
+// Обзор BMP перед пакетной обработкой (--info). Файлы каталога вместе с
+// подкаталогами, шаблона или списка пробуются параллельно (bmp_open: только
+// заголовки, пиксели не читаются). Для каждого файла выводятся размеры,
+// разрядность, сжатие, заголовок и оценка стоимости обработки: мегапиксели,
+// объем чтения и память буфера Color при обработке в памяти. Итоги (сумма и
+// наибольшая память на файл) помогают выбрать число потоков -batch.
+// Возвращает false, если список файлов не получен или хотя бы один файл не
+// удалось разобрать.
+bool info_scan(const char* input, int worker_count, StatsFormat format);
+
+#endif // INFO_H
@@ -0,0 +1,56 @@
+#include "log.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+static LogLevel log_level = LOG_LEVEL_INFO;
+
+void log_set_level(LogLevel level) {
+    log_level = level;
+}
+
+LogLevel log_get_level(void) {
+    return log_level;
+}
+
+bool log_enabled(LogLevel level) {
+    return level <= log_level;
+}
+
+// Сообщение одним вызовом vfprintf, чтобы строки разных потоков не смешивались
+static void log_write(LogLevel level, FILE* out, const char* prefix, const char* format, va_list list) {
+    if (level > log_level) {
+        return;
+    }
+
+    char message[1024];
+    vsnprintf(message, sizeof(message), format, list);
+    fprintf(out, "%s%s", prefix, message);
+}
+
+void log_error(const char* format, ...) {
+    va_list list;
+    va_start(list, format);
+    log_write(LOG_LEVEL_ERROR, stderr, "Error: ", format, list);
+    va_end(list);
+}
+
+void log_warning(const char* format, ...) {
+    va_list list;
+    va_start(list, format);
+    log_write(LOG_LEVEL_WARNING, stderr, "Warning: ", format, list);
+    va_end(list);
+}
+
+void log_info(const char* format, ...) {
+    va_list list;
+    va_start(list, format);
+    log_write(LOG_LEVEL_INFO, stdout, "", format, list);
+    va_end(list);
+}
+
+void log_debug(const char* format, ...) {
+    va_list list;
+    va_start(list, format);
+    log_write(LOG_LEVEL_DEBUG, stdout, "", format, list);
+    va_end(list);
+}
@@ -0,0 +1,39 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+
+// Журнал сообщений с уровнями. Ошибки и предупреждения выводятся в stderr,
+// сообщения о ходе обработки и отладочные - в stdout. Сообщения ниже текущего
+// уровня отбрасываются до форматирования, поэтому в тихом режиме фильтры и
+// пайплайн не обращаются к stdio.
+
+typedef enum {
+    LOG_LEVEL_ERROR = 0,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_INFO,       // по умолчанию
+    LOG_LEVEL_DEBUG
+} LogLevel;
+
+// Уровень задается до начала обработки (например, по -q) и не меняется, пока
+// работают потоки
+void log_set_level(LogLevel level);
+LogLevel log_get_level(void);
+
+// Будет ли выведено сообщение уровня level (для подготовки дорогих сообщений)
+bool log_enabled(LogLevel level);
+
+#if defined(__GNUC__)
+#define LOG_FORMAT(index) __attribute__((format(printf, index, index + 1)))
+#else
+#define LOG_FORMAT(index)
+#endif
+
+// log_error и log_warning добавляют префикс "Error: " и "Warning: ";
+// о причине ошибки вызывающий сообщает кодом возврата
+void log_error(const char* format, ...) LOG_FORMAT(1);
+void log_warning(const char* format, ...) LOG_FORMAT(1);
+void log_info(const char* format, ...) LOG_FORMAT(1);
+void log_debug(const char* format, ...) LOG_FORMAT(1);
+
+#endif // LOG_H
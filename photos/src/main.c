@@ -5,15 +5,283 @@
 #include "bmp.h"
 #include "cli.h"
 #include "pipeline.h"
+#include "batch.h"
+#include "stats.h"
+#include "log.h"
+#include "pyramid.h"
+#include "info.h"
 
+// Замеры одного запуска для отчета --stats
+typedef struct {
+    const char* mode;     // memory, pixels или stream
+    int width;
+    int height;
+    StageStats decode;
+    StageStats pipeline;
+    StageStats pyramid;   // уменьшение и фильтры уровней (-pyramid), без записи
+    StageStats encode;
+} RunStats;
 
-int main(int argc, char** argv) {
-    printf("╔══════════════════════════════════════════════════════════╗\n");
-    printf("║                 ImageCraft - Лабораторная работа №1     ║\n");
-    printf("║                 ФПМ, Лабораторная работа                ║\n");
-    printf("╚══════════════════════════════════════════════════════════╝\n");
-    printf("\n");
+static void print_run_stats(const CLIArgs* args, const RunStats* run) {
+    if (args->stats == STATS_FORMAT_NONE) {
+        return;
+    }
+
+    StageStats total = {0};
+    stage_stats_add(&total, &run->decode);
+    stage_stats_add(&total, &run->pipeline);
+    stage_stats_add(&total, &run->pyramid);
+    stage_stats_add(&total, &run->encode);
+    // Пиксели итога - размер кадра, а не сумма по этапам
+    total.pixels = (long long)run->width * run->height;
+
+    if (args->stats == STATS_FORMAT_JSON) {
+        printf("{\n  \"input\": ");
+        stats_print_json_string(stdout, args->input_file);
+        printf(",\n  \"output\": ");
+        stats_print_json_string(stdout, args->output_file);
+        printf(",\n  \"mode\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n",
+               run->mode, run->width, run->height);
+        printf("  \"stages\": [\n    ");
+        stage_stats_print(stdout, STATS_FORMAT_JSON, "decode", &run->decode);
+        printf(",\n    ");
+        stage_stats_print(stdout, STATS_FORMAT_JSON, "pipeline", &run->pipeline);
+        if (args->level_pipeline) {
+            printf(",\n    ");
+            stage_stats_print(stdout, STATS_FORMAT_JSON, "pyramid", &run->pyramid);
+        }
+        printf(",\n    ");
+        stage_stats_print(stdout, STATS_FORMAT_JSON, "encode", &run->encode);
+        printf("\n  ],\n  \"filters\": [");
+        pipeline_print_stats(args->pipeline, stdout, STATS_FORMAT_JSON);
+        if (args->level_pipeline) {
+            printf("\n  ],\n  \"level_filters\": [");
+            pipeline_print_stats(args->level_pipeline, stdout, STATS_FORMAT_JSON);
+        }
+        printf("\n  ],\n  \"total\": ");
+        stage_stats_print(stdout, STATS_FORMAT_JSON, "total", &total);
+        printf("\n}\n");
+        return;
+    }
+
+    printf("📊 Статистика (%d x %d, %.2f Мп, режим %s):\n", run->width, run->height,
+           run->width * (double)run->height * 1e-6, run->mode);
+    stage_stats_print_header(stdout);
+    stage_stats_print(stdout, STATS_FORMAT_TEXT, "decode", &run->decode);
+    pipeline_print_stats(args->pipeline, stdout, STATS_FORMAT_TEXT);
+    stage_stats_print(stdout, STATS_FORMAT_TEXT, "pipeline", &run->pipeline);
+    if (args->level_pipeline) {
+        pipeline_print_stats(args->level_pipeline, stdout, STATS_FORMAT_TEXT);
+        stage_stats_print(stdout, STATS_FORMAT_TEXT, "pyramid", &run->pyramid);
+    }
+    stage_stats_print(stdout, STATS_FORMAT_TEXT, "encode", &run->encode);
+    stage_stats_print(stdout, STATS_FORMAT_TEXT, "total", &total);
+}
+
+// Область файла, которую достаточно прочитать: обрезка из пайплайна
+// переносится в чтение (NULL - читается все изображение)
+static const ImageRegion* plan_read_region(const CLIArgs* args, const BMPFile* input, ImageRegion* region) {
+    int width = bmp_file_layout(input)->width;
+    int height = bmp_file_layout(input)->height;
+    if (!pipeline_plan_region(args->pipeline, width, height, region)) {
+        return NULL;
+    }
+
+    log_info("✂️  Читается только область %d x %d с угла (%d, %d) из %d x %d\n",
+             region->width, region->height, region->x, region->y, width, height);
+    return region;
+}
+
+// Контекст записи уровней пирамиды
+typedef struct {
+    const CLIArgs* args;
+    RunStats* run;
+} PyramidWriter;
+
+// Уровень 0 записывается в выходной файл, остальные - по шаблону -pyramid
+static bool write_pyramid_level(void* context, int level, const Image* image) {
+    PyramidWriter* writer = (PyramidWriter*)context;
+    const char* output = writer->args->output_file;
+    char path[1024];
+    if (level > 0) {
+        if (!pyramid_level_path(writer->args->pyramid_pattern, level, path, sizeof(path))) {
+            fprintf(stderr, "❌ ОШИБКА: Слишком длинное имя файла уровня %d\n", level);
+            return false;
+        }
+        output = path;
+    }
+
+    log_info("💾 Сохранение уровня %d (%d x %d): %s\n", level, image->width, image->height, output);
+    StageTimer timer;
+    stage_timer_start(&timer);
+    bool saved = bmp_write(output, image, writer->args->output_bits);
+    stage_timer_stop(&timer, &writer->run->encode, (long long)image->width * image->height);
+    if (!saved) {
+        fprintf(stderr, "❌ ОШИБКА: Не удалось сохранить изображение в '%s'\n", output);
+    }
+    return saved;
+}
+
+// Запись результата и уровней пирамиды: уровни строятся из уже прочитанного и
+// отфильтрованного изображения, буфер image используется для уровней
+static bool save_pyramid(const CLIArgs* args, Image* image, RunStats* run) {
+    int levels = pyramid_level_limit(image->width, image->height, args->pyramid_levels);
+    if (levels < args->pyramid_levels) {
+        log_warning("Image %dx%d has only %d pyramid level(s) below full size\n",
+                    image->width, image->height, levels);
+    }
+
+    long long pixels = 0;
+    for (int level = 1; level <= levels; level++) {
+        int width = 0;
+        int height = 0;
+        pyramid_level_size(image->width, image->height, level, &width, &height);
+        pixels += (long long)width * height;
+    }
+
+    log_info("\n🔺 Построение пирамиды: уровней после исходного - %d (%s)\n", levels,
+             resample_method_name(args->pyramid_method));
+    PyramidWriter writer = { args, run };
+    StageStats encode = run->encode;
+    StageTimer timer;
+    stage_timer_start(&timer);
+    bool ok = pyramid_build(image, levels, args->pyramid_method, args->level_pipeline,
+                            write_pyramid_level, &writer);
+    stage_timer_stop(&timer, &run->pyramid, pixels);
+
+    // Запись уровней учтена в этапе encode
+    run->pyramid.wall_seconds -= run->encode.wall_seconds - encode.wall_seconds;
+    run->pyramid.cpu_seconds -= run->encode.cpu_seconds - encode.cpu_seconds;
+    return ok;
+}
+
+// Обработка в компактном формате хранения: преобразование в Color выполняется
+// только для участков пайплайна, которые не поддерживают формат
+static int process_pixels(const CLIArgs* args, BMPFile* input) {
+    RunStats run = { .mode = "pixels" };
+    StageTimer timer;
+
+    log_info("📁 Чтение изображения: %s (формат %s)\n", args->input_file, pixel_format_name(args->format));
+    ImageRegion region;
+    const ImageRegion* read_region = plan_read_region(args, input, &region);
+    stage_timer_start(&timer);
+    PixelImage* image = bmp_file_read_pixels(input, args->format, read_region);
+    stage_timer_stop(&timer, &run.decode, image ? (long long)image->width * image->height : 0);
+    if (!image) {
+        fprintf(stderr, "❌ ОШИБКА: Не удалось прочитать изображение из '%s'\n", args->input_file);
+        return EXIT_FAILURE;
+    }
+
+    log_info("✅ Изображение загружено: %d x %d пикселей\n", image->width, image->height);
+    run.width = image->width;
+    run.height = image->height;
+
+    if (args->pipeline->count > 0) {
+        log_info("\n🔧 Применение фильтров...\n");
+        stage_timer_start(&timer);
+        bool applied = pipeline_apply_pixels(args->pipeline, &image);
+        stage_timer_stop(&timer, &run.pipeline, (long long)run.width * run.height);
+        if (!applied) {
+            fprintf(stderr, "❌ ОШИБКА: Не удалось применить фильтры\n");
+            pixel_image_destroy(image);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Пирамида строится в Color: уровни считаются из уже уменьшенных уровней
+    if (args->level_pipeline) {
+        Image* frame = pixel_image_to_image(image);
+        pixel_image_destroy(image);
+        bool saved = frame && save_pyramid(args, frame, &run);
+        image_destroy(frame);
+        if (!saved) {
+            return EXIT_FAILURE;
+        }
+
+        print_run_stats(args, &run);
+        log_info("\n🎉 УСПЕХ! Обработка завершена.\n");
+        log_info("   Результаты сохранены в указанные файлы.\n\n");
+        return EXIT_SUCCESS;
+    }
+
+    log_info("💾 Сохранение изображения: %s\n", args->output_file);
+    stage_timer_start(&timer);
+    bool saved = bmp_write_pixels(args->output_file, image, args->output_bits);
+    stage_timer_stop(&timer, &run.encode, (long long)image->width * image->height);
+    pixel_image_destroy(image);
+
+    if (!saved) {
+        fprintf(stderr, "❌ ОШИБКА: Не удалось сохранить изображение в '%s'\n", args->output_file);
+        return EXIT_FAILURE;
+    }
+
+    print_run_stats(args, &run);
+    log_info("\n🎉 УСПЕХ! Обработка завершена.\n");
+    log_info("   Результат сохранен в указанный файл.\n\n");
+    return EXIT_SUCCESS;
+}
 
+static bool read_stream_rows(void* context, int y, int count, Color* rows) {
+    return bmp_row_reader_read((BMPRowReader*)context, y, count, rows);
+}
+
+static bool write_stream_rows(void* context, int y, int count, const Color* rows) {
+    return bmp_row_writer_write((BMPRowWriter*)context, y, count, rows);
+}
+
+// Потоковая обработка: изображение целиком в памяти не хранится. Открытый
+// файл input переходит к читателю строк.
+static int process_stream(const CLIArgs* args, BMPFile* input) {
+    log_info("📁 Потоковое чтение изображения: %s\n", args->input_file);
+
+    RunStats run = { .mode = "stream" };
+    StageTimer timer;
+    int width = 0;
+    int height = 0;
+    stage_timer_start(&timer);
+    BMPRowReader* reader = bmp_row_reader_open_file(input, &width, &height);
+    stage_timer_stop(&timer, &run.decode, 0);
+    if (!reader) {
+        fprintf(stderr, "❌ ОШИБКА: Не удалось прочитать изображение из '%s'\n", args->input_file);
+        return EXIT_FAILURE;
+    }
+
+    log_info("✅ Размер изображения: %d x %d пикселей\n", width, height);
+
+    BMPRowWriter* writer = bmp_row_writer_open(args->output_file, width, height, args->output_bits);
+    if (!writer) {
+        fprintf(stderr, "❌ ОШИБКА: Не удалось сохранить изображение в '%s'\n", args->output_file);
+        bmp_row_reader_close(reader);
+        return EXIT_FAILURE;
+    }
+
+    // Чтение и запись строк идут вместе с фильтрами и входят в этап pipeline;
+    // decode и encode - открытие входного файла и завершение записи
+    log_info("💾 Запись изображения по мере обработки: %s\n", args->output_file);
+    run.width = width;
+    run.height = height;
+    stage_timer_start(&timer);
+    bool ok = pipeline_apply_stream(args->pipeline, width, height,
+                                    read_stream_rows, reader, write_stream_rows, writer);
+    stage_timer_stop(&timer, &run.pipeline, (long long)width * height);
+    stage_timer_start(&timer);
+    ok = bmp_row_writer_close(writer) && ok;
+    stage_timer_stop(&timer, &run.encode, 0);
+    bmp_row_reader_close(reader);
+
+    if (!ok) {
+        fprintf(stderr, "❌ ОШИБКА: Потоковая обработка не завершена\n");
+        return EXIT_FAILURE;
+    }
+
+    print_run_stats(args, &run);
+
+    log_info("\n🎉 УСПЕХ! Обработка завершена.\n");
+    log_info("   Результат сохранен в указанный файл.\n\n");
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
     // Парсинг аргументов командной строки
     CLIArgs* args = cli_parse_args(argc, argv);
     if (!args) {
@@ -21,6 +289,13 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
+    // Уровень журнала (-q, -v) известен только после разбора аргументов
+    log_info("╔══════════════════════════════════════════════════════════╗\n");
+    log_info("║                 ImageCraft - Лабораторная работа №1     ║\n");
+    log_info("║                 ФПМ, Лабораторная работа                ║\n");
+    log_info("╚══════════════════════════════════════════════════════════╝\n");
+    log_info("\n");
+
     // Вывод справки, если запрошено
     if (args->show_help) {
         cli_print_help();
@@ -35,17 +310,92 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
-    // Проверка формата входного файла
-    if (!bmp_is_valid_format(args->input_file)) {
+    // Обзор заголовков перед планированием пакетной обработки
+    if (args->info) {
+        StatsFormat format = args->stats == STATS_FORMAT_JSON ? STATS_FORMAT_JSON : STATS_FORMAT_TEXT;
+        bool ok = info_scan(args->input_file, args->pipeline->thread_count, format);
+        cli_free_args(args);
+        if (!ok) {
+            fprintf(stderr, "❌ ОШИБКА: Обзор завершен с ошибками\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Пакетная обработка: один пайплайн для всех файлов
+    if (args->batch) {
+        BatchFiles files;
+        if (!batch_collect_files(args->input_file, &files)) {
+            fprintf(stderr, "❌ ОШИБКА: Не удалось получить список файлов из '%s'\n", args->input_file);
+            cli_free_args(args);
+            return EXIT_FAILURE;
+        }
+
+        log_info("📁 Пакетная обработка: %s -> %s\n", args->input_file, args->output_file);
+        if (args->stats != STATS_FORMAT_NONE) {
+            log_info("ℹ️  В пакетном режиме параметр --stats не используется, время каждого\n");
+            log_info("   файла выводится в отчете пакетной обработки\n");
+        }
+        bool ok = batch_process(args->pipeline, &files, args->output_file,
+                                args->pipeline->thread_count, args->output_bits);
+        batch_free_files(&files);
+        cli_free_args(args);
+
+        if (!ok) {
+            fprintf(stderr, "❌ ОШИБКА: Не все файлы обработаны\n");
+            return EXIT_FAILURE;
+        }
+
+        log_info("\n🎉 УСПЕХ! Обработка завершена.\n\n");
+        return EXIT_SUCCESS;
+    }
+
+    // Проба входного файла: заголовки разбираются один раз, и тот же
+    // открытый файл затем читается без повторного открытия
+    BMPFile* input = bmp_open(args->input_file);
+    if (!input) {
         fprintf(stderr, "❌ ОШИБКА: Файл '%s' не является валидным BMP файлом\n", args->input_file);
-        fprintf(stderr, "   Поддерживаются только 24-битные BMP без сжатия\n");
+        fprintf(stderr, "   Поддерживаются BMP 1, 4, 8, 16, 24 и 32 бита (в том числе RLE и BI_BITFIELDS)\n");
         cli_free_args(args);
         return EXIT_FAILURE;
     }
 
+    // Потоковый режим возможен, если все фильтры обрабатывают полосы строк
+    if (args->stream && args->level_pipeline) {
+        log_info("⚠️  Пирамида строится по изображению целиком, параметр -stream не используется\n");
+    } else if (args->stream) {
+        const char* blocking_filter = NULL;
+        if (pipeline_can_stream(args->pipeline, &blocking_filter)) {
+            if (args->format != PIXEL_FORMAT_RGB_F32) {
+                log_info("ℹ️  В потоковом режиме параметр -format не используется\n");
+            }
+            int status = process_stream(args, input);
+            cli_free_args(args);
+            return status;
+        }
+        log_info("⚠️  Фильтр %s не поддерживает потоковый режим, изображение загружается целиком\n",
+               blocking_filter);
+    }
+
+    // Компактные форматы хранения обрабатываются отдельной веткой
+    if (args->format != PIXEL_FORMAT_RGB_F32) {
+        int status = process_pixels(args, input);
+        bmp_close(input);
+        cli_free_args(args);
+        return status;
+    }
+
     // Чтение изображения
-    printf("📁 Чтение изображения: %s\n", args->input_file);
-    Image* image = bmp_read(args->input_file);
+    RunStats run = { .mode = "memory" };
+    StageTimer timer;
+
+    log_info("📁 Чтение изображения: %s\n", args->input_file);
+    ImageRegion region;
+    const ImageRegion* read_region = plan_read_region(args, input, &region);
+    stage_timer_start(&timer);
+    Image* image = bmp_file_read(input, read_region);
+    stage_timer_stop(&timer, &run.decode, image ? (long long)image->width * image->height : 0);
+    bmp_close(input);
     if (!image) {
         fprintf(stderr, "❌ ОШИБКА: Не удалось прочитать изображение из '%s'\n", args->input_file);
         fprintf(stderr, "   Проверьте наличие файла и его формат\n");
@@ -53,19 +403,42 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
-    printf("✅ Изображение загружено: %d x %d пикселей\n", image->width, image->height);
+    log_info("✅ Изображение загружено: %d x %d пикселей\n", image->width, image->height);
+    run.width = image->width;
+    run.height = image->height;
 
     // Применение фильтров
     if (args->pipeline->count > 0) {
-        printf("\n🔧 Применение фильтров...\n");
+        log_info("\n🔧 Применение фильтров...\n");
+        stage_timer_start(&timer);
         pipeline_apply(args->pipeline, image);
+        stage_timer_stop(&timer, &run.pipeline, (long long)run.width * run.height);
     } else {
-        printf("\nℹ️  Фильтры не указаны, сохраняю исходное изображение\n");
+        log_info("\nℹ️  Фильтры не указаны, сохраняю исходное изображение\n");
+    }
+
+    // Сохранение изображения и уровней пирамиды
+    if (args->level_pipeline) {
+        bool saved = save_pyramid(args, image, &run);
+        image_destroy(image);
+        if (saved) {
+            print_run_stats(args, &run);
+        }
+        cli_free_args(args);
+        if (!saved) {
+            return EXIT_FAILURE;
+        }
+
+        log_info("\n🎉 УСПЕХ! Обработка завершена.\n");
+        log_info("   Результаты сохранены в указанные файлы.\n\n");
+        return EXIT_SUCCESS;
     }
 
-    // Сохранение изображения
-    printf("💾 Сохранение изображения: %s\n", args->output_file);
-    if (!bmp_write(args->output_file, image)) {
+    log_info("💾 Сохранение изображения: %s\n", args->output_file);
+    stage_timer_start(&timer);
+    bool saved = bmp_write(args->output_file, image, args->output_bits);
+    stage_timer_stop(&timer, &run.encode, (long long)image->width * image->height);
+    if (!saved) {
         fprintf(stderr, "❌ ОШИБКА: Не удалось сохранить изображение в '%s'\n", args->output_file);
         fprintf(stderr, "   Проверьте права доступа и свободное место на диске\n");
         image_destroy(image);
@@ -75,10 +448,11 @@ int main(int argc, char** argv) {
 
     // Очистка
     image_destroy(image);
+    print_run_stats(args, &run);
     cli_free_args(args);
 
-    printf("\n🎉 УСПЕХ! Обработка завершена.\n");
-    printf("   Результат сохранен в указанный файл.\n\n");
+    log_info("\n🎉 УСПЕХ! Обработка завершена.\n");
+    log_info("   Результат сохранен в указанный файл.\n\n");
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,132 @@
+#include "mapped_file.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct MappedFile {
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+#ifdef _WIN32
+
+MappedFile* mapped_file_open(const char* filename) {
+    if (!filename) {
+        return NULL;
+    }
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 ||
+        (unsigned long long)size.QuadPart > (size_t)-1) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    const uint8_t* data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MappedFile* mapped = data ? (MappedFile*)malloc(sizeof(MappedFile)) : NULL;
+    if (!mapped) {
+        if (data) UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    mapped->data = data;
+    mapped->size = (size_t)size.QuadPart;
+    mapped->file = file;
+    mapped->mapping = mapping;
+    return mapped;
+}
+
+void mapped_file_close(MappedFile* file) {
+    if (!file) {
+        return;
+    }
+
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->file);
+    free(file);
+}
+
+#else
+
+MappedFile* mapped_file_open(const char* filename) {
+    if (!filename) {
+        return NULL;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)info.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение держит файл открытым, дескриптор больше не нужен
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Пиксели читаются последовательно: ядро может читать страницы заранее
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    MappedFile* mapped = (MappedFile*)malloc(sizeof(MappedFile));
+    if (!mapped) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    mapped->data = (const uint8_t*)data;
+    mapped->size = size;
+    return mapped;
+}
+
+void mapped_file_close(MappedFile* file) {
+    if (!file) {
+        return;
+    }
+
+    munmap((void*)file->data, file->size);
+    free(file);
+}
+
+#endif
+
+const uint8_t* mapped_file_data(const MappedFile* file) {
+    return file ? file->data : NULL;
+}
+
+size_t mapped_file_size(const MappedFile* file) {
+    return file ? file->size : 0;
+}
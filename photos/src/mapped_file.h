@@ -0,0 +1,19 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Файл, отображенный в память только для чтения
+typedef struct MappedFile MappedFile;
+
+// Отображение файла целиком. Возвращает NULL без сообщений об ошибке, если файл
+// не удается отобразить (нет файла, пустой файл, не обычный файл) - вызывающий
+// код может перейти к чтению через stdio.
+MappedFile* mapped_file_open(const char* filename);
+void mapped_file_close(MappedFile* file);
+
+const uint8_t* mapped_file_data(const MappedFile* file);
+size_t mapped_file_size(const MappedFile* file);
+
+#endif // MAPPED_FILE_H
@@ -1,14 +1,52 @@
 #include "pipeline.h"
+#include "log.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// Минимальная высота полосы при параллельной обработке
+#define PIPELINE_MIN_BAND_ROWS 16
+
+// Задание на обработку поточечного фильтра по полосам (на месте)
+typedef struct {
+    const FilterNode* node;
+    Image* image;
+    int band_rows;
+} BandJob;
+
+// Задание на проход фильтра с окрестностью: все полосы читают общий источник
+// и пишут свои строки приемника
+typedef struct {
+    const FilterNode* node;
+    const Image* src;
+    Image* dst;
+    int band_rows;
+    char* failed;      // флаг ошибки для каждой полосы
+} PassJob;
+
+// Наибольшая длина сливаемой цепочки поточечных фильтров
+#define PIPELINE_MAX_FUSED 32
+
+// Минимальная высота полосы потоковой обработки; полоса также не меньше
+// 4 x суммарной окрестности, чтобы пересчет строк запаса был не больше 50%
+#define PIPELINE_STREAM_MIN_BAND_ROWS 64
+
+// Задание на однопроходное применение слитой цепочки поточечных фильтров
+typedef struct {
+    Image* image;
+    const PointOp* ops;
+    int count;
+    int band_rows;
+} FusedJob;
+
 FilterPipeline* pipeline_create(void) {
     FilterPipeline* pipeline = (FilterPipeline*)malloc(sizeof(FilterPipeline));
     if (pipeline) {
         pipeline->head = NULL;
         pipeline->tail = NULL;
         pipeline->count = 0;
+        pipeline->thread_count = 0;
+        pipeline->pool = NULL;
     }
     return pipeline;
 }
@@ -19,6 +57,7 @@ void pipeline_destroy(FilterPipeline* pipeline) {
     }
 
     pipeline_clear(pipeline);
+    threadpool_destroy(pipeline->pool);
     free(pipeline);
 }
 
@@ -27,18 +66,21 @@ void pipeline_add_filter(FilterPipeline* pipeline,
                         void* params,
                         const char* name) {
     if (!pipeline || !function) {
-        fprintf(stderr, "Error: Cannot add filter to pipeline (NULL parameters)\n");
+        log_error("Cannot add filter to pipeline (NULL parameters)\n");
         return;
     }
 
     FilterNode* node = (FilterNode*)malloc(sizeof(FilterNode));
     if (!node) {
-        fprintf(stderr, "Error: Memory allocation failed for filter node\n");
+        log_error("Memory allocation failed for filter node\n");
         return;
     }
 
     node->function = function;
     node->params = params;
+    node->traits = filter_get_traits(function);
+    memset(&node->stats, 0, sizeof(node->stats));
+    node->measured_count = 1;
     node->next = NULL;
 
     // Копируем имя фильтра
@@ -58,41 +100,610 @@ void pipeline_add_filter(FilterPipeline* pipeline,
     }
 
     pipeline->count++;
-    printf("Added filter: %s\n", node->name);
+    log_debug("Added filter: %s\n", node->name);
+}
+
+// Обработка одной полосы строк [y0, y1) прямо на участке исходного буфера
+static void pipeline_band_task(void* context, int index) {
+    BandJob* job = (BandJob*)context;
+    Image* image = job->image;
+    int width = image->width;
+    int y0 = index * job->band_rows;
+    int y1 = y0 + job->band_rows;
+    if (y1 > image->height) y1 = image->height;
+
+    Image view = *image;
+    view.data = image->data + (size_t)y0 * width;
+    view.height = y1 - y0;
+    view.capacity = width * view.height;
+    view.frame_y = image->frame_y + y0;
+    job->node->traits->band(&view, job->node->params);
+}
+
+// Параллельное применение поточечного фильтра по полосам. Возвращает false,
+// если фильтр нужно выполнить обычным способом.
+static bool pipeline_apply_banded(FilterPipeline* pipeline, const FilterNode* node,
+                                  Image* image, int filter_index) {
+    int threads = threadpool_get_size(pipeline->pool);
+    if (!node->traits || !node->traits->band || threads < 2 ||
+        (node->traits->halo && node->traits->halo(node->params) > 0)) {
+        return false;
+    }
+
+    BandJob job = { node, image, 0 };
+    job.band_rows = (image->height + threads * 4 - 1) / (threads * 4);
+    if (job.band_rows < PIPELINE_MIN_BAND_ROWS) job.band_rows = PIPELINE_MIN_BAND_ROWS;
+
+    int band_count = (image->height + job.band_rows - 1) / job.band_rows;
+    if (band_count < 2) {
+        return false;
+    }
+
+    log_info("Filter %d/%d: %s (%d bands, %d threads)\n",
+           filter_index, pipeline->count, node->name, band_count, threads);
+
+    threadpool_run(pipeline->pool, pipeline_band_task, &job, band_count);
+    return true;
+}
+
+static void pipeline_pass_task(void* context, int index) {
+    PassJob* job = (PassJob*)context;
+    int y0 = index * job->band_rows;
+    int y1 = y0 + job->band_rows;
+    if (y1 > job->src->height) y1 = job->src->height;
+
+    if (!job->node->traits->pass(job->src, job->dst, y0, y1, job->node->params)) {
+        job->failed[index] = 1;
+    }
+}
+
+// Второй буфер кадра для проходов src -> dst. Создается при первом проходе и
+// пересоздается, только если изображение стало больше.
+static Image* pipeline_back_buffer(Image** back, const Image* image) {
+    size_t pixels = (size_t)image->width * image->height;
+    if (*back && (size_t)(*back)->capacity < pixels) {
+        image_destroy(*back);
+        *back = NULL;
+    }
+
+    if (!*back) {
+        *back = image_create_scratch(image->width, image->height);
+        if (!*back) {
+            return NULL;
+        }
+    }
+
+    (*back)->width = image->width;
+    (*back)->height = image->height;
+    (*back)->frame_y = image->frame_y;
+    (*back)->frame_height = image->frame_height;
+    return *back;
+}
+
+// Проход фильтра с окрестностью из изображения во второй буфер (по полосам на
+// потоках пула), после чего буферы меняются местами. Копия кадра не нужна.
+// Возвращает false, если у фильтра нет прохода или он не выполнен - тогда
+// изображение не изменено. В bands записывается число полос.
+static bool pipeline_apply_pass(ThreadPool* pool, const FilterNode* node,
+                                Image* image, Image** back, int* bands) {
+    if (!node->traits || !node->traits->pass) {
+        return false;
+    }
+
+    Image* dst = pipeline_back_buffer(back, image);
+    if (!dst) {
+        return false;
+    }
+
+    int threads = threadpool_get_size(pool);
+    PassJob job = { node, image, dst, image->height, NULL };
+    if (threads > 1) {
+        // Для фильтров с окрестностью полосы крупнее, чем для поточечных
+        job.band_rows = (image->height + threads * 2 - 1) / (threads * 2);
+        if (job.band_rows < PIPELINE_MIN_BAND_ROWS) job.band_rows = PIPELINE_MIN_BAND_ROWS;
+    }
+
+    int band_count = (image->height + job.band_rows - 1) / job.band_rows;
+    job.failed = (char*)calloc(band_count, 1);
+    if (!job.failed) {
+        return false;
+    }
+
+    threadpool_run(pool, pipeline_pass_task, &job, band_count);
+
+    bool ok = true;
+    for (int i = 0; i < band_count; i++) {
+        if (job.failed[i]) ok = false;
+    }
+    free(job.failed);
+
+    if (ok) {
+        image_swap_data(image, dst);
+    }
+    if (bands) {
+        *bands = band_count;
+    }
+    return ok;
+}
+
+static void pipeline_prepare_pool(FilterPipeline* pipeline) {
+    if (!pipeline->pool && pipeline->thread_count != 1) {
+        pipeline->pool = threadpool_create(pipeline->thread_count);
+    }
+}
+
+static void pipeline_apply_node(FilterPipeline* pipeline, const FilterNode* node,
+                                Image* image, Image** back, int filter_index) {
+    int bands = 0;
+    if (pipeline_apply_pass(pipeline->pool, node, image, back, &bands)) {
+        if (bands > 1) {
+            log_info("Filter %d/%d: %s (%d bands, %d threads)\n", filter_index, pipeline->count,
+                   node->name, bands, threadpool_get_size(pipeline->pool));
+        } else {
+            log_info("Filter %d/%d: %s\n", filter_index, pipeline->count, node->name);
+        }
+        return;
+    }
+
+    if (pipeline_apply_banded(pipeline, node, image, filter_index)) {
+        return;
+    }
+
+    log_info("Filter %d/%d: %s\n", filter_index, pipeline->count, node->name);
+
+    // Применяем фильтр
+    if (node->function) {
+        node->function(image, node->params);
+    } else {
+        log_warning("Filter function is NULL for %s\n", node->name);
+    }
+}
+
+// Сбор подряд идущих поточечных фильтров, начиная с node. В end записывается
+// первый узел после цепочки.
+static int pipeline_collect_point_ops(FilterNode* node, PointOp* ops, FilterNode** end) {
+    int count = 0;
+
+    while (node && count < PIPELINE_MAX_FUSED && node->traits && node->traits->point &&
+           node->traits->point(node->params, &ops[count])) {
+        count++;
+        node = node->next;
+    }
+
+    *end = node;
+    return count;
+}
+
+static void pipeline_fused_task(void* context, int index) {
+    FusedJob* job = (FusedJob*)context;
+    Image* image = job->image;
+    int y0 = index * job->band_rows;
+    int y1 = y0 + job->band_rows;
+    if (y1 > image->height) y1 = image->height;
+
+    Image view = *image;
+    view.data = image->data + (size_t)y0 * image->width;
+    view.height = y1 - y0;
+    view.capacity = image->width * view.height;
+    view.frame_y = image->frame_y + y0;
+    apply_point_ops(&view, job->ops, job->count);
+}
+
+// Слияние цепочки из двух и более поточечных фильтров, начиная с node:
+// вся цепочка применяется за один проход по памяти. Возвращает первый
+// необработанный узел или node, если сливать нечего.
+static FilterNode* pipeline_apply_fused(FilterPipeline* pipeline, FilterNode* node,
+                                        Image* image, int* filter_index) {
+    PointOp ops[PIPELINE_MAX_FUSED];
+    PointOp fused[PIPELINE_MAX_FUSED];
+    FilterNode* end = NULL;
+    int count = pipeline_collect_point_ops(node, ops, &end);
+
+    if (count < 2) {
+        return node;
+    }
+
+    int fused_count = point_ops_fuse(ops, count, fused);
+
+    if (log_enabled(LOG_LEVEL_INFO)) {
+        char names[256];
+        size_t length = 0;
+        names[0] = '\0';
+        for (FilterNode* current = node; current != end; current = current->next) {
+            int written = snprintf(names + length, sizeof(names) - length, " %s", current->name);
+            if (written < 0 || (size_t)written >= sizeof(names) - length) {
+                break;
+            }
+            length += (size_t)written;
+        }
+        log_info("Filters %d-%d/%d:%s (fused into one pass, %d stage(s))\n", *filter_index,
+                 *filter_index + count - 1, pipeline->count, names, fused_count);
+    }
+
+    int threads = threadpool_get_size(pipeline->pool);
+    FusedJob job = { image, fused, fused_count, 0 };
+    job.band_rows = (image->height + threads * 4 - 1) / (threads * 4);
+    if (job.band_rows < PIPELINE_MIN_BAND_ROWS) job.band_rows = PIPELINE_MIN_BAND_ROWS;
+
+    int band_count = (image->height + job.band_rows - 1) / job.band_rows;
+    threadpool_run(pipeline->pool, pipeline_fused_task, &job, band_count);
+
+    *filter_index += count;
+    return end;
+}
+
+// Замер шага пайплайна от node до end (слитая цепочка замеряется целиком)
+static void pipeline_record_stats(FilterNode* node, const FilterNode* end,
+                                  StageTimer* timer, long long pixels) {
+    stage_timer_stop(timer, &node->stats, pixels);
+
+    node->measured_count = 0;
+    for (FilterNode* current = node; current != end; current = current->next) {
+        if (current != node) {
+            current->measured_count = 0;
+        }
+        node->measured_count++;
+    }
+}
+
+// Один шаг пайплайна: слитая цепочка поточечных фильтров или отдельный фильтр.
+// back - второй буфер кадра для проходов фильтров с окрестностью.
+static FilterNode* pipeline_apply_step(FilterPipeline* pipeline, FilterNode* node,
+                                       Image* image, Image** back, int* filter_index) {
+    long long pixels = (long long)image->width * image->height;
+    StageTimer timer;
+    stage_timer_start(&timer);
+
+    FilterNode* next = pipeline_apply_fused(pipeline, node, image, filter_index);
+    if (next == node) {
+        pipeline_apply_node(pipeline, node, image, back, (*filter_index)++);
+        next = node->next;
+    }
+
+    pipeline_record_stats(node, next, &timer, pixels);
+    return next;
+}
+
+static bool pipeline_node_supports(const FilterNode* node, PixelFormat format) {
+    return node->traits && node->traits->pixel &&
+           (node->traits->formats & PIXEL_FORMAT_MASK(format));
 }
 
 void pipeline_apply(FilterPipeline* pipeline, Image* image) {
     if (!pipeline || !image) {
-        fprintf(stderr, "Error: Cannot apply pipeline (NULL parameters)\n");
+        log_error("Cannot apply pipeline (NULL parameters)\n");
         return;
     }
 
     if (pipeline->count == 0) {
-        printf("No filters to apply\n");
+        log_info("No filters to apply\n");
         return;
     }
 
-    printf("\nApplying %d filter(s):\n", pipeline->count);
-    printf("========================================\n");
+    log_info("\nApplying %d filter(s):\n", pipeline->count);
+    log_info("========================================\n");
+
+    pipeline_prepare_pool(pipeline);
 
     FilterNode* current = pipeline->head;
+    Image* back = NULL;
     int filter_index = 1;
 
     while (current) {
-        printf("Filter %d/%d: %s\n", filter_index++, pipeline->count, current->name);
+        current = pipeline_apply_step(pipeline, current, image, &back, &filter_index);
+    }
+    image_destroy(back);
 
-        // Применяем фильтр
-        if (current->function) {
-            current->function(image, current->params);
-        } else {
-            fprintf(stderr, "Warning: Filter function is NULL for %s\n", current->name);
+    log_info("========================================\n");
+    log_info("All filters applied successfully\n\n");
+}
+
+bool pipeline_apply_pixels(FilterPipeline* pipeline, PixelImage** image_ptr) {
+    if (!pipeline || !image_ptr || !*image_ptr) {
+        log_error("Cannot apply pipeline (NULL parameters)\n");
+        return false;
+    }
+
+    PixelImage* image = *image_ptr;
+    PixelFormat format = image->format;
+
+    if (pipeline->count == 0) {
+        log_info("No filters to apply\n");
+        return true;
+    }
+
+    log_info("\nApplying %d filter(s) in %s format:\n", pipeline->count, pixel_format_name(format));
+    log_info("========================================\n");
+
+    pipeline_prepare_pool(pipeline);
+
+    FilterNode* current = pipeline->head;
+    Image* back = NULL;
+    int filter_index = 1;
+
+    while (current) {
+        if (pipeline_node_supports(current, format)) {
+            log_info("Filter %d/%d: %s (%s)\n", filter_index++, pipeline->count,
+                   current->name, pixel_format_name(format));
+            // Пиксели считаются по входу: crop и resize меняют размер кадра
+            long long pixels = (long long)image->width * image->height;
+            StageTimer timer;
+            stage_timer_start(&timer);
+            current->traits->pixel(image, current->params);
+            pipeline_record_stats(current, current->next, &timer, pixels);
+            current = current->next;
+            continue;
+        }
+
+        // Фильтры без поддержки формата выполняются над Color одним участком:
+        // преобразование происходит только на границах участка
+        Image* work = pixel_image_to_image(image);
+        pixel_image_destroy(image);
+        *image_ptr = NULL;
+        if (!work) {
+            image_destroy(back);
+            return false;
+        }
+
+        while (current && !pipeline_node_supports(current, format)) {
+            current = pipeline_apply_step(pipeline, current, work, &back, &filter_index);
+        }
+
+        image = pixel_image_from_image(work, format);
+        image_destroy(work);
+        if (!image) {
+            image_destroy(back);
+            return false;
+        }
+        *image_ptr = image;
+    }
+    image_destroy(back);
+
+    log_info("========================================\n");
+    log_info("All filters applied successfully\n\n");
+    return true;
+}
+
+void pipeline_apply_serial(const FilterPipeline* pipeline, Image* image) {
+    if (!pipeline || !image) {
+        return;
+    }
+
+    FilterNode* node = pipeline->head;
+    Image* back = NULL;
+    while (node) {
+        PointOp ops[PIPELINE_MAX_FUSED];
+        FilterNode* end = NULL;
+        int count = pipeline_collect_point_ops(node, ops, &end);
+
+        if (count >= 2) {
+            PointOp fused[PIPELINE_MAX_FUSED];
+            apply_point_ops(image, fused, point_ops_fuse(ops, count, fused));
+            node = end;
+            continue;
+        }
+
+        // Проход и полосная реализация фильтра не печатают сообщений
+        if (!pipeline_apply_pass(NULL, node, image, &back, NULL)) {
+            if (node->traits && node->traits->band) {
+                node->traits->band(image, node->params);
+            } else if (node->function) {
+                node->function(image, node->params);
+            }
+        }
+        node = node->next;
+    }
+    image_destroy(back);
+}
+
+bool pipeline_can_stream(const FilterPipeline* pipeline, const char** blocking_filter) {
+    if (!pipeline) {
+        return false;
+    }
+
+    for (const FilterNode* node = pipeline->head; node; node = node->next) {
+        if (!node->traits || !node->traits->band) {
+            if (blocking_filter) {
+                *blocking_filter = node->name;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// Задание на потоковую обработку: очередная группа полос, по одной на поток
+typedef struct {
+    FilterPipeline* pipeline;
+    Image** tiles;
+} StreamJob;
+
+// Вся цепочка фильтров над одной полосой с запасом строк
+static void pipeline_stream_task(void* context, int index) {
+    StreamJob* job = (StreamJob*)context;
+    pipeline_apply_serial(job->pipeline, job->tiles[index]);
+}
+
+bool pipeline_apply_stream(FilterPipeline* pipeline, int width, int height,
+                           RowReadFunc read, void* read_context,
+                           RowWriteFunc write, void* write_context) {
+    if (!pipeline || !read || !write || width <= 0 || height <= 0) {
+        log_error("Cannot apply pipeline (NULL parameters)\n");
+        return false;
+    }
+
+    const char* blocking_filter = NULL;
+    if (!pipeline_can_stream(pipeline, &blocking_filter)) {
+        log_error("Filter %s cannot be applied in streaming mode\n",
+                blocking_filter ? blocking_filter : "?");
+        return false;
+    }
+
+    // Каждая полоса обрабатывается всей цепочкой сразу, поэтому ей нужен запас
+    // строк, равный сумме окрестностей всех фильтров
+    int halo = 0;
+    for (const FilterNode* node = pipeline->head; node; node = node->next) {
+        halo += node->traits->halo ? node->traits->halo(node->params) : 0;
+    }
+
+    int band_rows = 4 * halo;
+    if (band_rows < PIPELINE_STREAM_MIN_BAND_ROWS) band_rows = PIPELINE_STREAM_MIN_BAND_ROWS;
+    if (band_rows > height) band_rows = height;
+    int band_count = (height + band_rows - 1) / band_rows;
+
+    int tile_rows = band_rows + 2 * halo;
+    if (tile_rows > height) tile_rows = height;
+
+    pipeline_prepare_pool(pipeline);
+    int threads = threadpool_get_size(pipeline->pool);
+    if (threads > band_count) threads = band_count;
+
+    log_info("\nStreaming %d filter(s): %d bands of %d rows (+%d context rows), %d threads\n",
+           pipeline->count, band_count, band_rows, 2 * halo, threads);
+    log_info("========================================\n");
+
+    Image** tiles = (Image**)calloc(threads, sizeof(Image*));
+    bool ok = tiles != NULL;
+    for (int i = 0; ok && i < threads; i++) {
+        tiles[i] = image_create(width, tile_rows);
+        ok = tiles[i] != NULL;
+    }
+
+    // Полосы обрабатываются группами по числу потоков; чтение и запись идут
+    // в вызывающем потоке по порядку строк
+    StreamJob job = { pipeline, tiles };
+    for (int first = 0; ok && first < band_count; first += threads) {
+        int group = band_count - first < threads ? band_count - first : threads;
+
+        for (int i = 0; ok && i < group; i++) {
+            int y0 = (first + i) * band_rows;
+            int y1 = y0 + band_rows < height ? y0 + band_rows : height;
+            int top = y0 - halo > 0 ? y0 - halo : 0;
+            int bottom = y1 + halo < height ? y1 + halo : height;
+
+            // Проходы подменяют буфер полосы приемником ее текущей высоты, и
+            // после короткой крайней полосы буфера может не хватить на полную
+            if ((size_t)tiles[i]->capacity < (size_t)width * (bottom - top)) {
+                image_destroy(tiles[i]);
+                tiles[i] = image_create_scratch(width, tile_rows);
+                ok = tiles[i] != NULL;
+                if (!ok) {
+                    break;
+                }
+            }
+
+            tiles[i]->height = bottom - top;
+            tiles[i]->frame_y = top;
+            tiles[i]->frame_height = height;
+            ok = read(read_context, top, bottom - top, tiles[i]->data);
         }
 
-        current = current->next;
+        if (ok) {
+            threadpool_run(pipeline->pool, pipeline_stream_task, &job, group);
+        }
+
+        for (int i = 0; ok && i < group; i++) {
+            int y0 = (first + i) * band_rows;
+            int y1 = y0 + band_rows < height ? y0 + band_rows : height;
+            ok = write(write_context, y0, y1 - y0,
+                       tiles[i]->data + (size_t)(y0 - tiles[i]->frame_y) * width);
+        }
     }
 
-    printf("========================================\n");
-    printf("All filters applied successfully\n\n");
+    for (int i = 0; tiles && i < threads; i++) {
+        image_destroy(tiles[i]);
+    }
+    free(tiles);
+
+    log_info("========================================\n");
+    if (ok) {
+        log_info("All filters applied successfully\n\n");
+    } else {
+        log_error("Streaming pipeline failed\n");
+    }
+    return ok;
+}
+
+bool pipeline_plan_region(FilterPipeline* pipeline, int width, int height, ImageRegion* region) {
+    if (!pipeline || !region) {
+        return false;
+    }
+
+    int margin_x = 0;
+    int margin_y = 0;
+    for (FilterNode* node = pipeline->head; node; node = node->next) {
+        if (node->function == filter_crop) {
+            CropParams* crop = (CropParams*)node->params;
+            ImageRegion area;
+            if (!crop_clip(crop, width, height, &area)) {
+                return false;
+            }
+
+            // Поля накапливаются: каждому фильтру нужен контекст вокруг
+            // области, которую читает следующий
+            int left = area.x > margin_x ? area.x - margin_x : 0;
+            int top = area.y > margin_y ? area.y - margin_y : 0;
+            int right = width - area.x - area.width > margin_x ? area.x + area.width + margin_x : width;
+            int bottom = height - area.y - area.height > margin_y ? area.y + area.height + margin_y : height;
+            if (left == 0 && top == 0 && right == width && bottom == height) {
+                return false;
+            }
+
+            region->x = left;
+            region->y = top;
+            region->width = right - left;
+            region->height = bottom - top;
+            crop->x = area.x - left;
+            crop->y = area.y - top;
+            crop->width = area.width;
+            crop->height = area.height;
+            return true;
+        }
+
+        if (!node->traits || !node->traits->margins) {
+            return false;
+        }
+
+        int filter_x = 0;
+        int filter_y = 0;
+        node->traits->margins(node->params, &filter_x, &filter_y);
+        margin_x += filter_x;
+        margin_y += filter_y;
+    }
+    return false;
+}
+
+void pipeline_print_stats(const FilterPipeline* pipeline, FILE* out, StatsFormat format) {
+    if (!pipeline || format == STATS_FORMAT_NONE) {
+        return;
+    }
+
+    bool first = true;
+    for (const FilterNode* node = pipeline->head; node; node = node->next) {
+        if (node->measured_count == 0 || node->stats.runs == 0) {
+            continue;
+        }
+
+        // Имя слитой цепочки - имена фильтров через '+'
+        char name[256];
+        size_t length = 0;
+        name[0] = '\0';
+        const FilterNode* current = node;
+        for (int i = 0; i < node->measured_count && current; i++, current = current->next) {
+            int written = snprintf(name + length, sizeof(name) - length, "%s%s",
+                                   i > 0 ? "+" : "", current->name);
+            if (written < 0 || (size_t)written >= sizeof(name) - length) {
+                break;
+            }
+            length += (size_t)written;
+        }
+
+        if (format == STATS_FORMAT_JSON) {
+            fprintf(out, "%s\n    ", first ? "" : ",");
+        }
+        stage_stats_print(out, format, name, &node->stats);
+        first = false;
+    }
 }
 
 void pipeline_clear(FilterPipeline* pipeline) {
@@ -124,6 +735,18 @@ void pipeline_clear(FilterPipeline* pipeline) {
     pipeline->count = 0;
 }
 
+void pipeline_set_threads(FilterPipeline* pipeline, int thread_count) {
+    if (!pipeline || thread_count < 0) {
+        return;
+    }
+
+    if (pipeline->thread_count != thread_count) {
+        threadpool_destroy(pipeline->pool);
+        pipeline->pool = NULL;
+        pipeline->thread_count = thread_count;
+    }
+}
+
 int pipeline_get_count(const FilterPipeline* pipeline) {
     return pipeline ? pipeline->count : 0;
 }
@@ -3,15 +3,18 @@
 
 #include "image.h"
 #include "filters.h"
-
-// Тип функции фильтра
-typedef void (*FilterFunc)(Image*, void*);
+#include "threadpool.h"
+#include "stats.h"
 
 // Структура для представления фильтра в пайплайне
 typedef struct FilterNode {
     FilterFunc function;
     void* params;
     char* name;
+    const FilterTraits* traits; // NULL - фильтр выполняется целиком
+    StageStats stats;           // замеры применений фильтра
+    int measured_count;         // узлов в замере stats: больше 1 - слитая цепочка
+                                // с этого узла, 0 - узел замерен в цепочке раньше
     struct FilterNode* next;
 } FilterNode;
 
@@ -20,6 +23,8 @@ typedef struct {
     FilterNode* head;
     FilterNode* tail;
     int count;
+    int thread_count;  // 0 - по числу ядер
+    ThreadPool* pool;  // создается при первом применении
 } FilterPipeline;
 
 // Создание и уничтожение пайплайна
@@ -35,6 +40,47 @@ void pipeline_add_filter(FilterPipeline* pipeline,
 // Применение пайплайна к изображению
 void pipeline_apply(FilterPipeline* pipeline, Image* image);
 
+// Применение всех фильтров без вывода сообщений и без пула потоков. Пайплайн
+// не изменяется, поэтому функцию можно вызывать одновременно из нескольких
+// потоков для разных изображений.
+void pipeline_apply_serial(const FilterPipeline* pipeline, Image* image);
+
+// Количество потоков для обработки полос (0 - по числу ядер, 1 - последовательно)
+void pipeline_set_threads(FilterPipeline* pipeline, int thread_count);
+
+// Применение пайплайна к изображению в формате PixelImage. Фильтры, не
+// поддерживающие формат, выполняются над Color; изображение может быть заменено.
+bool pipeline_apply_pixels(FilterPipeline* pipeline, PixelImage** image);
+
+// Источник строк для потоковой обработки: заполняет rows строками y..y+count-1
+typedef bool (*RowReadFunc)(void* context, int y, int count, Color* rows);
+// Приемник готовых строк y..y+count-1 (вызывается по порядку строк)
+typedef bool (*RowWriteFunc)(void* context, int y, int count, const Color* rows);
+
+// Возможна ли потоковая обработка (все фильтры умеют работать с полосами).
+// Иначе в blocking_filter записывается имя первого неподходящего фильтра.
+bool pipeline_can_stream(const FilterPipeline* pipeline, const char** blocking_filter);
+
+// Потоковое применение пайплайна к изображению width x height: полосы строк
+// читаются из read, проходят всю цепочку и сразу отдаются в write. Память -
+// несколько полос с запасом строк для окрестностей фильтров, а не все изображение.
+bool pipeline_apply_stream(FilterPipeline* pipeline, int width, int height,
+                           RowReadFunc read, void* read_context,
+                           RowWriteFunc write, void* write_context);
+
+// Перенос обрезки в чтение файла. Если перед первой обрезкой стоят только
+// фильтры, не зависящие от положения в кадре (FilterTraits.margins), в region
+// записывается часть изображения width x height, которую достаточно прочитать:
+// область обрезки с полями контекста этих фильтров. Параметры обрезки
+// переводятся в координаты region, поэтому результат пайплайна не меняется
+// (с точностью до округления), а фильтры обрабатывают только эту часть.
+// Возвращает false, если переносить нечего; пайплайн тогда не изменяется.
+bool pipeline_plan_region(FilterPipeline* pipeline, int width, int height, ImageRegion* region);
+
+// Замеры фильтров (по одной строке на замер; слитые цепочки - одной строкой).
+// Потоковый режим и pipeline_apply_serial фильтры по отдельности не замеряют.
+void pipeline_print_stats(const FilterPipeline* pipeline, FILE* out, StatsFormat format);
+
 // Очистка пайплайна
 void pipeline_clear(FilterPipeline* pipeline);
 
@@ -0,0 +1,377 @@
+#include "pixel_image.h"
+#include "simd.h"
+#include "buffer_pool.h"
+#include "log.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static const char* pixel_format_names[PIXEL_FORMAT_COUNT] = {
+    "f32", "u8", "u16", "planar8", "planar16"
+};
+
+bool pixel_format_is_planar(PixelFormat format) {
+    return format == PIXEL_FORMAT_PLANAR_U8 || format == PIXEL_FORMAT_PLANAR_U16;
+}
+
+int pixel_format_channel_bytes(PixelFormat format) {
+    switch (format) {
+        case PIXEL_FORMAT_RGB_F32:    return (int)sizeof(float);
+        case PIXEL_FORMAT_RGB_U16:
+        case PIXEL_FORMAT_PLANAR_U16: return 2;
+        default:                      return 1;
+    }
+}
+
+int pixel_format_pixel_bytes(PixelFormat format) {
+    return pixel_format_channel_bytes(format) * 3;
+}
+
+const char* pixel_format_name(PixelFormat format) {
+    return format < PIXEL_FORMAT_COUNT ? pixel_format_names[format] : "unknown";
+}
+
+bool pixel_format_parse(const char* name, PixelFormat* format) {
+    if (!name || !format) {
+        return false;
+    }
+
+    for (int i = 0; i < PIXEL_FORMAT_COUNT; i++) {
+        if (strcmp(name, pixel_format_names[i]) == 0) {
+            *format = (PixelFormat)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+PixelImage* pixel_image_create(int width, int height, PixelFormat format) {
+    if (width <= 0 || height <= 0 || format >= PIXEL_FORMAT_COUNT) {
+        log_error("Invalid pixel image %dx%d (format %d)\n", width, height, format);
+        return NULL;
+    }
+
+    // Размеры из заголовка файла произвольны: строка и весь буфер должны
+    // помещаться в ptrdiff_t, иначе адресная арифметика переполнится
+    size_t planes = pixel_format_is_planar(format) ? 3 : 1;
+    size_t pixel_bytes = (size_t)pixel_format_channel_bytes(format) * (planes == 3 ? 1 : 3);
+    if ((size_t)width > ((size_t)PTRDIFF_MAX - 15) / pixel_bytes) {
+        log_error("Pixel image is too large (%dx%d)\n", width, height);
+        return NULL;
+    }
+
+    // Строки выравниваются по 16 байт, чтобы векторные циклы не пересекали строки
+    size_t stride = ((size_t)width * pixel_bytes + 15) & ~(size_t)15;
+    if ((size_t)height > (size_t)PTRDIFF_MAX / stride / planes) {
+        log_error("Pixel image is too large (%dx%d)\n", width, height);
+        return NULL;
+    }
+
+    PixelImage* image = (PixelImage*)calloc(1, sizeof(PixelImage));
+    if (!image) {
+        log_error("Memory allocation failed for pixel image structure\n");
+        return NULL;
+    }
+
+    image->format = format;
+    image->width = width;
+    image->height = height;
+    image->stride = (ptrdiff_t)stride;
+    image->buffer_size = stride * (size_t)height * planes;
+    image->buffer = (uint8_t*)buffer_pool_acquire(image->buffer_size, true);
+    if (!image->buffer) {
+        log_error("Memory allocation failed for pixel image data\n");
+        free(image);
+        return NULL;
+    }
+
+    for (size_t p = 0; p < planes; p++) {
+        image->planes[p] = image->buffer + stride * (size_t)height * p;
+    }
+
+    return image;
+}
+
+void pixel_image_destroy(PixelImage* image) {
+    if (image) {
+        buffer_pool_release(image->buffer);
+        free(image);
+    }
+}
+
+uint8_t* pixel_image_row(const PixelImage* image, int plane, int y) {
+    return image->planes[plane] + image->stride * y;
+}
+
+// Квантование как в bmp_write: усечение после умножения на 255
+static uint8_t quantize_u8(float value) {
+    if (value < 0.0f) value = 0.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (uint8_t)(value * 255);
+}
+
+static uint16_t quantize_u16(float value) {
+    if (value < 0.0f) value = 0.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (uint16_t)(value * 65535.0f + 0.5f);
+}
+
+void pixel_image_read_row_f32(const PixelImage* image, int y, Color* colors) {
+    int width = image->width;
+
+    switch (image->format) {
+        case PIXEL_FORMAT_RGB_F32:
+            memcpy(colors, pixel_image_row(image, 0, y), sizeof(Color) * width);
+            break;
+
+        case PIXEL_FORMAT_BGR_U8:
+            simd_kernels()->bgr8_to_color(pixel_image_row(image, 0, y), colors, width);
+            break;
+
+        case PIXEL_FORMAT_RGB_U16: {
+            const uint16_t* row = (const uint16_t*)pixel_image_row(image, 0, y);
+            for (int x = 0; x < width; x++) {
+                colors[x] = color_create(row[3 * (size_t)x] / 65535.0f,
+                                         row[3 * (size_t)x + 1] / 65535.0f,
+                                         row[3 * (size_t)x + 2] / 65535.0f);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_PLANAR_U8: {
+            const uint8_t* r = pixel_image_row(image, 0, y);
+            const uint8_t* g = pixel_image_row(image, 1, y);
+            const uint8_t* b = pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                colors[x] = color_create(r[x] / 255.0f, g[x] / 255.0f, b[x] / 255.0f);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_PLANAR_U16: {
+            const uint16_t* r = (const uint16_t*)pixel_image_row(image, 0, y);
+            const uint16_t* g = (const uint16_t*)pixel_image_row(image, 1, y);
+            const uint16_t* b = (const uint16_t*)pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                colors[x] = color_create(r[x] / 65535.0f, g[x] / 65535.0f, b[x] / 65535.0f);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void pixel_image_write_row_f32(PixelImage* image, int y, const Color* colors) {
+    int width = image->width;
+
+    switch (image->format) {
+        case PIXEL_FORMAT_RGB_F32:
+            memcpy(pixel_image_row(image, 0, y), colors, sizeof(Color) * width);
+            break;
+
+        case PIXEL_FORMAT_BGR_U8: {
+            uint8_t* row = pixel_image_row(image, 0, y);
+            for (int x = 0; x < width; x++) {
+                row[3 * (size_t)x] = quantize_u8(colors[x].b);
+                row[3 * (size_t)x + 1] = quantize_u8(colors[x].g);
+                row[3 * (size_t)x + 2] = quantize_u8(colors[x].r);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_RGB_U16: {
+            uint16_t* row = (uint16_t*)pixel_image_row(image, 0, y);
+            for (int x = 0; x < width; x++) {
+                row[3 * (size_t)x] = quantize_u16(colors[x].r);
+                row[3 * (size_t)x + 1] = quantize_u16(colors[x].g);
+                row[3 * (size_t)x + 2] = quantize_u16(colors[x].b);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_PLANAR_U8: {
+            uint8_t* r = pixel_image_row(image, 0, y);
+            uint8_t* g = pixel_image_row(image, 1, y);
+            uint8_t* b = pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                r[x] = quantize_u8(colors[x].r);
+                g[x] = quantize_u8(colors[x].g);
+                b[x] = quantize_u8(colors[x].b);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_PLANAR_U16: {
+            uint16_t* r = (uint16_t*)pixel_image_row(image, 0, y);
+            uint16_t* g = (uint16_t*)pixel_image_row(image, 1, y);
+            uint16_t* b = (uint16_t*)pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                r[x] = quantize_u16(colors[x].r);
+                g[x] = quantize_u16(colors[x].g);
+                b[x] = quantize_u16(colors[x].b);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void pixel_image_read_row_bgr8(const PixelImage* image, int y, uint8_t* bgr) {
+    int width = image->width;
+
+    switch (image->format) {
+        case PIXEL_FORMAT_BGR_U8:
+            memcpy(bgr, pixel_image_row(image, 0, y), (size_t)width * 3);
+            break;
+
+        case PIXEL_FORMAT_PLANAR_U8: {
+            const uint8_t* r = pixel_image_row(image, 0, y);
+            const uint8_t* g = pixel_image_row(image, 1, y);
+            const uint8_t* b = pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                bgr[3 * (size_t)x] = b[x];
+                bgr[3 * (size_t)x + 1] = g[x];
+                bgr[3 * (size_t)x + 2] = r[x];
+            }
+            break;
+        }
+
+        default: {
+            // Остальные форматы квантуются так же, как Image в bmp_write
+            const Color* colors = (const Color*)pixel_image_row(image, 0, y);
+            Color* temp = NULL;
+            if (image->format != PIXEL_FORMAT_RGB_F32) {
+                temp = (Color*)malloc(sizeof(Color) * width);
+                if (!temp) {
+                    memset(bgr, 0, (size_t)width * 3);
+                    return;
+                }
+                pixel_image_read_row_f32(image, y, temp);
+                colors = temp;
+            }
+            simd_kernels()->color_to_bgr8(colors, bgr, width);
+            free(temp);
+            break;
+        }
+    }
+}
+
+void pixel_image_write_row_bgr8(PixelImage* image, int y, const uint8_t* bgr) {
+    int width = image->width;
+
+    switch (image->format) {
+        case PIXEL_FORMAT_BGR_U8:
+            memcpy(pixel_image_row(image, 0, y), bgr, (size_t)width * 3);
+            break;
+
+        case PIXEL_FORMAT_PLANAR_U8: {
+            uint8_t* r = pixel_image_row(image, 0, y);
+            uint8_t* g = pixel_image_row(image, 1, y);
+            uint8_t* b = pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                b[x] = bgr[3 * (size_t)x];
+                g[x] = bgr[3 * (size_t)x + 1];
+                r[x] = bgr[3 * (size_t)x + 2];
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_RGB_U16: {
+            uint16_t* row = (uint16_t*)pixel_image_row(image, 0, y);
+            for (int x = 0; x < width; x++) {
+                row[3 * (size_t)x] = (uint16_t)(bgr[3 * (size_t)x + 2] * 257);
+                row[3 * (size_t)x + 1] = (uint16_t)(bgr[3 * (size_t)x + 1] * 257);
+                row[3 * (size_t)x + 2] = (uint16_t)(bgr[3 * (size_t)x] * 257);
+            }
+            break;
+        }
+
+        case PIXEL_FORMAT_PLANAR_U16: {
+            uint16_t* r = (uint16_t*)pixel_image_row(image, 0, y);
+            uint16_t* g = (uint16_t*)pixel_image_row(image, 1, y);
+            uint16_t* b = (uint16_t*)pixel_image_row(image, 2, y);
+            for (int x = 0; x < width; x++) {
+                b[x] = (uint16_t)(bgr[3 * (size_t)x] * 257);
+                g[x] = (uint16_t)(bgr[3 * (size_t)x + 1] * 257);
+                r[x] = (uint16_t)(bgr[3 * (size_t)x + 2] * 257);
+            }
+            break;
+        }
+
+        default: {
+            simd_kernels()->bgr8_to_color(bgr, (Color*)pixel_image_row(image, 0, y), width);
+            break;
+        }
+    }
+}
+
+PixelImage* pixel_image_from_image(const Image* src, PixelFormat format) {
+    if (!src) {
+        return NULL;
+    }
+
+    PixelImage* dst = pixel_image_create(src->width, src->height, format);
+    if (!dst) {
+        return NULL;
+    }
+
+    for (int y = 0; y < src->height; y++) {
+        pixel_image_write_row_f32(dst, y, src->data + (size_t)y * src->width);
+    }
+    return dst;
+}
+
+Image* pixel_image_to_image(const PixelImage* src) {
+    if (!src) {
+        return NULL;
+    }
+
+    Image* dst = image_create_scratch(src->width, src->height);
+    if (!dst) {
+        return NULL;
+    }
+
+    for (int y = 0; y < src->height; y++) {
+        pixel_image_read_row_f32(src, y, dst->data + (size_t)y * src->width);
+    }
+    return dst;
+}
+
+PixelImage* pixel_image_convert(const PixelImage* src, PixelFormat format) {
+    if (!src) {
+        return NULL;
+    }
+
+    PixelImage* dst = pixel_image_create(src->width, src->height, format);
+    if (!dst) {
+        return NULL;
+    }
+
+    // 8-битный BGR (в том числе отображенный BMP) переносится без перехода через float
+    if (src->format == PIXEL_FORMAT_BGR_U8) {
+        for (int y = 0; y < src->height; y++) {
+            pixel_image_write_row_bgr8(dst, y, pixel_image_row(src, 0, y));
+        }
+        return dst;
+    }
+
+    Color* row = (Color*)malloc(sizeof(Color) * src->width);
+    if (!row) {
+        log_error("Memory allocation failed for format conversion\n");
+        pixel_image_destroy(dst);
+        return NULL;
+    }
+
+    for (int y = 0; y < src->height; y++) {
+        pixel_image_read_row_f32(src, y, row);
+        pixel_image_write_row_f32(dst, y, row);
+    }
+
+    free(row);
+    return dst;
+}
@@ -0,0 +1,57 @@
+#ifndef PIXEL_IMAGE_H
+#define PIXEL_IMAGE_H
+
+#include "image.h"
+#include <stddef.h>
+
+// Форматы хранения пикселей
+typedef enum {
+    PIXEL_FORMAT_RGB_F32 = 0,   // Color {r,g,b}, 12 байт на пиксель (как в Image)
+    PIXEL_FORMAT_BGR_U8,        // чередующиеся 8-битные каналы в порядке BMP
+    PIXEL_FORMAT_RGB_U16,       // чередующиеся 16-битные каналы
+    PIXEL_FORMAT_PLANAR_U8,     // отдельные 8-битные плоскости R, G, B
+    PIXEL_FORMAT_PLANAR_U16,    // отдельные 16-битные плоскости R, G, B
+    PIXEL_FORMAT_COUNT
+} PixelFormat;
+
+#define PIXEL_FORMAT_MASK(format) (1u << (format))
+#define PIXEL_FORMAT_MASK_ALL ((1u << PIXEL_FORMAT_COUNT) - 1)
+
+// Изображение в произвольном формате хранения
+typedef struct {
+    PixelFormat format;
+    int width;
+    int height;
+    ptrdiff_t stride;     // байт между строками одной плоскости (< 0 у представлений
+                          // BMP, хранящих строки снизу вверх)
+    uint8_t* planes[3];   // для чередующихся форматов используется только planes[0]
+    uint8_t* buffer;      // выделенная память (NULL, если память не принадлежит изображению)
+    size_t buffer_size;
+} PixelImage;
+
+// Создание и уничтожение
+PixelImage* pixel_image_create(int width, int height, PixelFormat format);
+void pixel_image_destroy(PixelImage* image);
+
+// Свойства форматов
+bool pixel_format_is_planar(PixelFormat format);
+int pixel_format_channel_bytes(PixelFormat format);
+int pixel_format_pixel_bytes(PixelFormat format);
+const char* pixel_format_name(PixelFormat format);
+bool pixel_format_parse(const char* name, PixelFormat* format);
+
+// Указатель на строку y плоскости plane
+uint8_t* pixel_image_row(const PixelImage* image, int plane, int y);
+
+// Построчное преобразование в/из 8-битного BGR (порядок BMP) и Color
+void pixel_image_read_row_bgr8(const PixelImage* image, int y, uint8_t* bgr);
+void pixel_image_write_row_bgr8(PixelImage* image, int y, const uint8_t* bgr);
+void pixel_image_read_row_f32(const PixelImage* image, int y, Color* colors);
+void pixel_image_write_row_f32(PixelImage* image, int y, const Color* colors);
+
+// Преобразование целых изображений (на границах пайплайна)
+PixelImage* pixel_image_from_image(const Image* src, PixelFormat format);
+Image* pixel_image_to_image(const PixelImage* src);
+PixelImage* pixel_image_convert(const PixelImage* src, PixelFormat format);
+
+#endif // PIXEL_IMAGE_H
@@ -0,0 +1,143 @@
+#include "pyramid.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static int pyramid_half(int size) {
+    return size > 1 ? size / 2 : 1;
+}
+
+void pyramid_level_size(int width, int height, int level, int* level_width, int* level_height) {
+    for (int i = 0; i < level; i++) {
+        width = pyramid_half(width);
+        height = pyramid_half(height);
+    }
+    *level_width = width;
+    *level_height = height;
+}
+
+int pyramid_level_limit(int width, int height, int levels) {
+    int limit = 0;
+    while (limit < levels && (width > 1 || height > 1)) {
+        width = pyramid_half(width);
+        height = pyramid_half(height);
+        limit++;
+    }
+    return limit;
+}
+
+bool pyramid_pattern_valid(const char* pattern) {
+    if (!pattern) {
+        return false;
+    }
+
+    int conversions = 0;
+    for (const char* p = pattern; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+
+        // Ширина не больше двух цифр (в том числе с ведущим нулем)
+        int digits = 0;
+        while (isdigit((unsigned char)*p) && digits < 2) {
+            p++;
+            digits++;
+        }
+        if (*p != 'd') {
+            return false;
+        }
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+bool pyramid_level_path(const char* pattern, int level, char* path, size_t size) {
+    int length = snprintf(path, size, pattern, level);
+    return length >= 0 && (size_t)length < size;
+}
+
+// Копия уровня для фильтров уровня: буфер копии используется повторно, пока
+// уровень в него помещается (фильтры изменения размера могут его заменить)
+static bool pyramid_copy_level(Image** work, const Image* level) {
+    int pixels = level->width * level->height;
+    if (!*work || (*work)->capacity < pixels) {
+        image_destroy(*work);
+        *work = image_create_scratch(level->width, level->height);
+        if (!*work) {
+            return false;
+        }
+    }
+
+    (*work)->width = level->width;
+    (*work)->height = level->height;
+    (*work)->frame_y = 0;
+    (*work)->frame_height = level->height;
+    memcpy((*work)->data, level->data, sizeof(Color) * (size_t)pixels);
+    return true;
+}
+
+static bool pyramid_emit(const Image* level, int index, FilterPipeline* level_pipeline,
+                         Image** work, PyramidLevelFunc emit, void* context) {
+    if (!level_pipeline || level_pipeline->count == 0) {
+        return emit(context, index, level);
+    }
+
+    if (!pyramid_copy_level(work, level)) {
+        log_error("Memory allocation failed for pyramid level\n");
+        return false;
+    }
+    pipeline_apply(level_pipeline, *work);
+    return emit(context, index, *work);
+}
+
+bool pyramid_build(Image* base, int levels, ResampleMethod method,
+                   FilterPipeline* level_pipeline, PyramidLevelFunc emit, void* context) {
+    if (!base || !emit || levels < 0 || levels > PYRAMID_MAX_LEVELS) {
+        log_error("Invalid parameters for pyramid_build\n");
+        return false;
+    }
+
+    Image* work = NULL;
+    if (!pyramid_emit(base, 0, level_pipeline, &work, emit, context)) {
+        image_destroy(work);
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    pyramid_level_size(base->width, base->height, 1, &width, &height);
+
+    // Второй буфер - размера первого уровня, следующие уровни помещаются в
+    // буфер через один
+    Image* spare = levels > 0 ? image_create_scratch(width, height) : NULL;
+    if (levels > 0 && !spare) {
+        image_destroy(work);
+        return false;
+    }
+
+    Image* current = base;
+    bool ok = true;
+    for (int level = 1; ok && level <= levels; level++) {
+        Image* next = current == base ? spare : base;
+        pyramid_level_size(current->width, current->height, 1, &width, &height);
+        next->width = width;
+        next->height = height;
+        next->frame_y = 0;
+        next->frame_height = height;
+
+        log_debug("Pyramid level %d: %dx%d\n", level, width, height);
+        ok = resample_image_into(current, next, method) &&
+             pyramid_emit(next, level, level_pipeline, &work, emit, context);
+        current = next;
+    }
+
+    image_destroy(spare);
+    image_destroy(work);
+    return ok;
+}
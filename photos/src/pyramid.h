@@ -0,0 +1,42 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "pipeline.h"
+#include "resample.h"
+
+// Пирамида уменьшенных копий (mip-уровни). Уровень 0 - исходное изображение,
+// уровень k + 1 получается из уровня k уменьшением вдвое по каждой оси (не
+// меньше 1 пикселя), поэтому все уровни вместе стоят около трети одного
+// уменьшения исходника вдвое, а чтение и общие фильтры выполняются один раз.
+// Уровни строятся в двух буферах по очереди: буфер уровня k повторно
+// используется для уровня k + 2.
+
+// Наибольшее число уровней после исходного
+#define PYRAMID_MAX_LEVELS 16
+
+// Размер уровня level для исходника width x height
+void pyramid_level_size(int width, int height, int level, int* level_width, int* level_height);
+
+// Сколько уровней после исходного имеет смысл строить (до 1x1), не больше levels
+int pyramid_level_limit(int width, int height, int levels);
+
+// Шаблон имени файла уровня: ровно одно %d (допускается ширина: %02d),
+// знак процента записывается как %%
+bool pyramid_pattern_valid(const char* pattern);
+
+// Имя файла уровня по шаблону; false, если не помещается в size
+bool pyramid_level_path(const char* pattern, int level, char* path, size_t size);
+
+// Получатель готового уровня (например, запись в файл). Изображение только
+// читается: из него строится следующий уровень.
+typedef bool (*PyramidLevelFunc)(void* context, int level, const Image* image);
+
+// Построение уровней 0..levels из base. Если level_pipeline не пуст, каждый
+// уровень перед передачей в emit обрабатывается им в отдельной копии (следующий
+// уровень строится из необработанного). Буфер base занимают уровни начиная
+// со второго, поэтому после вызова его пиксели и размер не сохраняются.
+// Возвращает false при ошибке или отказе emit.
+bool pyramid_build(Image* base, int levels, ResampleMethod method,
+                   FilterPipeline* level_pipeline, PyramidLevelFunc emit, void* context);
+
+#endif // PYRAMID_H
@@ -0,0 +1,478 @@
+#include "resample.h"
+#include "buffer_pool.h"
+#include "simd.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Ядро фильтра и его радиус при масштабе 1
+typedef struct {
+    const char* name;
+    double (*kernel)(double x);
+    double support;
+} ResampleFilter;
+
+static double kernel_nearest(double x) {
+    return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+static double kernel_bilinear(double x) {
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+static double kernel_bicubic(double x) {
+    const double a = -0.5;
+    x = fabs(x);
+    if (x < 1.0) {
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    }
+    if (x < 2.0) {
+        return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    }
+    return 0.0;
+}
+
+static double sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= M_PI;
+    return sin(x) / x;
+}
+
+static double kernel_lanczos3(double x) {
+    return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+static const ResampleFilter resample_filters[] = {
+    { "nearest",  kernel_nearest,  0.5 },
+    { "bilinear", kernel_bilinear, 1.0 },
+    { "bicubic",  kernel_bicubic,  2.0 },
+    { "lanczos3", kernel_lanczos3, 3.0 },
+};
+
+bool resample_method_parse(const char* name, ResampleMethod* method) {
+    if (!name || !method) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(resample_filters) / sizeof(resample_filters[0]); i++) {
+        if (strcmp(name, resample_filters[i].name) == 0) {
+            *method = (ResampleMethod)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* resample_method_name(ResampleMethod method) {
+    if ((unsigned)method >= sizeof(resample_filters) / sizeof(resample_filters[0])) {
+        return "unknown";
+    }
+    return resample_filters[method].name;
+}
+
+// Таблица весов одной оси: для пикселя приемника i - первый пиксель источника
+// first[i] и taps весов подряд. Окно сдвинуто внутрь источника, поэтому число
+// весов у всех пикселей одинаково (недостающие веса нулевые).
+typedef struct {
+    int taps;
+    int* first;
+    float* weights;
+} ResampleTable;
+
+static void resample_table_free(ResampleTable* table) {
+    free(table->first);
+    free(table->weights);
+}
+
+// source_size пикселей источника занимают source_extent единиц исходной
+// сетки (меньше source_size после усреднения блоками с неполным последним блоком)
+static bool resample_table_build(ResampleTable* table, int source_size, double source_extent,
+                                 int target_size, ResampleMethod method) {
+    const ResampleFilter* filter = &resample_filters[method];
+    double scale = source_extent / target_size;
+    // Ближайший сосед не сглаживает: ядро не растягивается
+    double filter_scale = (scale > 1.0 && method != RESAMPLE_NEAREST) ? scale : 1.0;
+    double support = filter->support * filter_scale;
+
+    int taps = method == RESAMPLE_NEAREST ? 1 : (int)ceil(support) * 2 + 1;
+    if (taps > source_size) taps = source_size;
+
+    table->taps = taps;
+    table->first = (int*)malloc(sizeof(int) * target_size);
+    table->weights = (float*)calloc((size_t)target_size * taps, sizeof(float));
+    if (!table->first || !table->weights) {
+        resample_table_free(table);
+        return false;
+    }
+
+    double weights[2 * 64 + 1];
+    double* w = (size_t)taps <= sizeof(weights) / sizeof(weights[0]) ?
+        weights : (double*)malloc(sizeof(double) * taps);
+    if (!w) {
+        resample_table_free(table);
+        return false;
+    }
+
+    for (int i = 0; i < target_size; i++) {
+        double center = (i + 0.5) * scale;
+        int x0 = (int)floor(center - support + 0.5);
+        int x1 = (int)floor(center + support + 0.5);
+        if (x0 < 0) x0 = 0;
+        if (x1 > source_size) x1 = source_size;
+        if (x1 - x0 > taps) x1 = x0 + taps;
+        if (x1 <= x0) {
+            // Приемник больше источника у самого края: ближайший пиксель
+            x0 = center < source_size ? (int)center : source_size - 1;
+            x1 = x0 + 1;
+        }
+
+        double sum = 0.0;
+        for (int x = x0; x < x1; x++) {
+            w[x - x0] = filter->kernel((x - center + 0.5) / filter_scale);
+            sum += w[x - x0];
+        }
+
+        // Окно taps весов внутри источника; веса нормируются на сумму
+        int first = x0 + taps > source_size ? source_size - taps : x0;
+        float* row = table->weights + (size_t)i * taps;
+        for (int x = x0; x < x1; x++) {
+            row[x - first] = (float)(sum != 0.0 ? w[x - x0] / sum : (x == x0 ? 1.0 : 0.0));
+        }
+        table->first[i] = first;
+    }
+
+    if (w != weights) {
+        free(w);
+    }
+    return true;
+}
+
+// Усреднение блоками block_x x block_y (последние блоки могут быть неполными)
+static Image* resample_box_reduce(const Image* src, int block_x, int block_y) {
+    int width = (src->width + block_x - 1) / block_x;
+    int height = (src->height + block_y - 1) / block_y;
+    Image* dst = image_create_scratch(width, height);
+    float* sums = (float*)buffer_pool_acquire(sizeof(float) * 3 * (size_t)src->width, false);
+    const float** rows = (const float**)malloc(sizeof(float*) * block_y);
+    float* ones = (float*)malloc(sizeof(float) * block_y);
+    if (!dst || !sums || !rows || !ones) {
+        image_destroy(dst);
+        buffer_pool_release(sums);
+        free(rows);
+        free(ones);
+        return NULL;
+    }
+
+    for (int k = 0; k < block_y; k++) {
+        ones[k] = 1.0f;
+    }
+
+    const SimdKernels* simd = simd_kernels();
+    for (int y = 0; y < height; y++) {
+        int y0 = y * block_y;
+        int y1 = y0 + block_y < src->height ? y0 + block_y : src->height;
+
+        // Сумма строк блока (векторным ядром свертки с единичными весами),
+        // затем сумма столбцов блока
+        for (int sy = y0; sy < y1; sy++) {
+            rows[sy - y0] = (const float*)(src->data + (size_t)sy * src->width);
+        }
+        simd->accumulate_rows(rows, ones, y1 - y0, sums, 0, 3 * src->width);
+
+        Color* out = dst->data + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int x0 = x * block_x;
+            int x1 = x0 + block_x < src->width ? x0 + block_x : src->width;
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            for (int sx = x0; sx < x1; sx++) {
+                r += sums[3 * sx];
+                g += sums[3 * sx + 1];
+                b += sums[3 * sx + 2];
+            }
+            float norm = 1.0f / ((x1 - x0) * (y1 - y0));
+            out[x].r = r * norm;
+            out[x].g = g * norm;
+            out[x].b = b * norm;
+        }
+    }
+
+    buffer_pool_release(sums);
+    free(rows);
+    free(ones);
+    return dst;
+}
+
+// Усреднение блоками целочисленного PixelImage: суммы столбцов копятся в
+// целых числах прямо по строкам источника, в Color переводятся только средние
+static Image* resample_box_reduce_pixels(const PixelImage* src, int block_x, int block_y) {
+    int width = (src->width + block_x - 1) / block_x;
+    int height = (src->height + block_y - 1) / block_y;
+    int planes = pixel_format_is_planar(src->format) ? 3 : 1;
+    int values = planes == 3 ? src->width : 3 * src->width;     // значений в строке плоскости
+    bool wide = pixel_format_channel_bytes(src->format) == 2;
+    float scale = wide ? 1.0f / 65535.0f : 1.0f / 255.0f;
+    // Порядок каналов: BMP хранит B, G, R
+    int channel_r = src->format == PIXEL_FORMAT_BGR_U8 ? 2 : 0;
+    const SimdKernels* simd = simd_kernels();
+
+    Image* dst = image_create_scratch(width, height);
+    uint32_t* sums = (uint32_t*)buffer_pool_acquire(sizeof(uint32_t) * (size_t)values * planes, false);
+    const uint8_t** rows = (const uint8_t**)malloc(sizeof(uint8_t*) * block_y);
+    if (!dst || !sums || !rows) {
+        image_destroy(dst);
+        buffer_pool_release(sums);
+        free(rows);
+        return NULL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        int y0 = y * block_y;
+        int y1 = y0 + block_y < src->height ? y0 + block_y : src->height;
+
+        // Сумма строк блока по каждой плоскости (16-битных строк в блоке
+        // не больше 65537: суммы помещаются в 32 бита)
+        for (int p = 0; p < planes; p++) {
+            for (int sy = y0; sy < y1; sy++) {
+                rows[sy - y0] = pixel_image_row(src, p, sy);
+            }
+            if (wide) {
+                simd->sum_rows_u16((const uint16_t* const*)rows, y1 - y0, sums + (size_t)p * values, values);
+            } else {
+                simd->sum_rows_u8(rows, y1 - y0, sums + (size_t)p * values, values);
+            }
+        }
+        Color* out = dst->data + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int x0 = x * block_x;
+            int x1 = x0 + block_x < src->width ? x0 + block_x : src->width;
+            uint64_t channel[3] = {0, 0, 0};
+            for (int sx = x0; sx < x1; sx++) {
+                for (int c = 0; c < 3; c++) {
+                    channel[c] += planes == 3 ? sums[(size_t)c * values + sx] : sums[3 * sx + c];
+                }
+            }
+            float norm = scale / ((x1 - x0) * (y1 - y0));
+            out[x].r = channel[channel_r] * norm;
+            out[x].g = channel[1] * norm;
+            out[x].b = channel[2 - channel_r] * norm;
+        }
+    }
+
+    buffer_pool_release(sums);
+    free(rows);
+    return dst;
+}
+
+static void resample_horizontal(const Image* src, Image* dst, const ResampleTable* table, bool clamp) {
+    const SimdKernels* simd = simd_kernels();
+    for (int y = 0; y < dst->height; y++) {
+        simd->resample_row(src->data + (size_t)y * src->width, dst->data + (size_t)y * dst->width,
+                           dst->width, table->first, table->weights, table->taps, clamp);
+    }
+}
+
+static bool resample_vertical(const Image* src, Image* dst, const ResampleTable* table, bool clamp) {
+    const SimdKernels* simd = simd_kernels();
+    void (*rows_kernel)(const float* const*, const float*, int, float*, int, int) =
+        clamp ? simd->convolve_rows : simd->accumulate_rows;
+
+    const float** rows = (const float**)malloc(sizeof(float*) * table->taps);
+    if (!rows) {
+        return false;
+    }
+
+    for (int y = 0; y < dst->height; y++) {
+        for (int k = 0; k < table->taps; k++) {
+            rows[k] = (const float*)(src->data + (size_t)(table->first[y] + k) * src->width);
+        }
+        rows_kernel(rows, table->weights + (size_t)y * table->taps, table->taps,
+                    (float*)(dst->data + (size_t)y * dst->width), 0, 3 * dst->width);
+    }
+
+    free(rows);
+    return true;
+}
+
+// Блок усреднения по оси: наибольший, после которого масштаб не меньше box_gap
+static int resample_block(int source_size, int target_size, ResampleMethod method, double box_gap) {
+    if (method == RESAMPLE_NEAREST || box_gap <= 0.0) {
+        return 1;
+    }
+
+    int block = (int)((double)source_size / target_size / box_gap);
+    return block > 1 ? block : 1;
+}
+
+static bool resample_valid(int new_width, int new_height, ResampleMethod method) {
+    if (new_width <= 0 || new_height <= 0 ||
+        (unsigned)method >= sizeof(resample_filters) / sizeof(resample_filters[0])) {
+        log_error("Invalid parameters for resample_image\n");
+        return false;
+    }
+    return true;
+}
+
+// Проходы фильтра над source - изображением width x height, усредненным
+// блоками block_x x block_y (или исходным при блоках 1) - в приемник dst
+static bool resample_passes(const Image* source, int width, int height, int block_x, int block_y,
+                            Image* dst, ResampleMethod method) {
+    int new_width = dst->width;
+    int new_height = dst->height;
+    // Ось, размер которой не меняется, пропускается
+    bool scale_x = source->width != new_width;
+    bool scale_y = source->height != new_height;
+
+    ResampleTable columns = {0};
+    ResampleTable rows = {0};
+    if ((scale_x && !resample_table_build(&columns, source->width, (double)width / block_x,
+                                          new_width, method)) ||
+        (scale_y && !resample_table_build(&rows, source->height, (double)height / block_y,
+                                          new_height, method))) {
+        resample_table_free(&columns);
+        log_error("Memory allocation failed for resampling\n");
+        return false;
+    }
+
+    Image* middle = NULL;
+    bool ok = true;
+
+    if (ok && scale_x && scale_y) {
+        // Порядок проходов с меньшим числом умножений
+        double cost_hv = (double)source->height * new_width * columns.taps +
+                         (double)new_height * new_width * rows.taps;
+        double cost_vh = (double)new_height * source->width * rows.taps +
+                         (double)new_height * new_width * columns.taps;
+        if (cost_hv <= cost_vh) {
+            middle = image_create_scratch(new_width, source->height);
+            ok = middle != NULL;
+            if (ok) {
+                resample_horizontal(source, middle, &columns, false);
+                ok = resample_vertical(middle, dst, &rows, true);
+            }
+        } else {
+            middle = image_create_scratch(source->width, new_height);
+            ok = middle != NULL && resample_vertical(source, middle, &rows, false);
+            if (ok) {
+                resample_horizontal(middle, dst, &columns, true);
+            }
+        }
+    } else if (ok && scale_x) {
+        resample_horizontal(source, dst, &columns, true);
+    } else if (ok && scale_y) {
+        ok = resample_vertical(source, dst, &rows, true);
+    } else if (ok) {
+        memcpy(dst->data, source->data, sizeof(Color) * (size_t)new_width * new_height);
+    }
+
+    image_destroy(middle);
+    resample_table_free(&columns);
+    resample_table_free(&rows);
+
+    if (!ok) {
+        log_error("Memory allocation failed for resampling\n");
+    }
+    return ok;
+}
+
+static bool resample_into_gap(const Image* src, Image* dst, ResampleMethod method, double box_gap) {
+    int block_x = resample_block(src->width, dst->width, method, box_gap);
+    int block_y = resample_block(src->height, dst->height, method, box_gap);
+    if (block_x == 1 && block_y == 1) {
+        return resample_passes(src, src->width, src->height, 1, 1, dst, method);
+    }
+
+    Image* reduced = resample_box_reduce(src, block_x, block_y);
+    if (!reduced) {
+        return false;
+    }
+
+    bool ok = resample_passes(reduced, src->width, src->height, block_x, block_y, dst, method);
+    image_destroy(reduced);
+    return ok;
+}
+
+Image* resample_image_gap(const Image* src, int new_width, int new_height, ResampleMethod method,
+                          double box_gap) {
+    if (!src || !resample_valid(new_width, new_height, method)) {
+        return NULL;
+    }
+
+    Image* dst = image_create_scratch(new_width, new_height);
+    if (!dst) {
+        log_error("Memory allocation failed for resampling\n");
+        return NULL;
+    }
+
+    if (!resample_into_gap(src, dst, method, box_gap)) {
+        image_destroy(dst);
+        return NULL;
+    }
+    return dst;
+}
+
+bool resample_image_into(const Image* src, Image* dst, ResampleMethod method) {
+    if (!src || !dst || src->data == dst->data || !resample_valid(dst->width, dst->height, method) ||
+        dst->capacity < dst->width * dst->height) {
+        log_error("Invalid parameters for resample_image_into\n");
+        return false;
+    }
+    return resample_into_gap(src, dst, method, RESAMPLE_BOX_GAP);
+}
+
+Image* resample_image(const Image* src, int new_width, int new_height, ResampleMethod method) {
+    return resample_image_gap(src, new_width, new_height, method, RESAMPLE_BOX_GAP);
+}
+
+bool image_resample(Image* image, int new_width, int new_height, ResampleMethod method) {
+    Image* resized = resample_image(image, new_width, new_height, method);
+    if (!resized) {
+        return false;
+    }
+
+    buffer_pool_release(image->data);
+    image->data = resized->data;
+    image->width = resized->width;
+    image->height = resized->height;
+    image->capacity = resized->capacity;
+    image->frame_y = 0;
+    image->frame_height = resized->height;
+    free(resized);
+    return true;
+}
+
+PixelImage* resample_pixels(const PixelImage* src, int new_width, int new_height, ResampleMethod method) {
+    if (!src || !resample_valid(new_width, new_height, method)) {
+        return NULL;
+    }
+
+    int block_x = resample_block(src->width, new_width, method, RESAMPLE_BOX_GAP);
+    int block_y = resample_block(src->height, new_height, method, RESAMPLE_BOX_GAP);
+    bool reduce = (block_x > 1 || block_y > 1) && src->format != PIXEL_FORMAT_RGB_F32;
+
+    Image* source = reduce ? resample_box_reduce_pixels(src, block_x, block_y) : pixel_image_to_image(src);
+    if (!source) {
+        return NULL;
+    }
+
+    Image* dst = image_create_scratch(new_width, new_height);
+    bool ok = dst && (reduce ?
+        resample_passes(source, src->width, src->height, block_x, block_y, dst, method) :
+        resample_into_gap(source, dst, method, RESAMPLE_BOX_GAP));
+    image_destroy(source);
+    if (!ok) {
+        image_destroy(dst);
+        return NULL;
+    }
+
+    PixelImage* result = pixel_image_from_image(dst, src->format);
+    image_destroy(dst);
+    return result;
+}
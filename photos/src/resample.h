@@ -0,0 +1,49 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include "image.h"
+#include "pixel_image.h"
+#include <stdbool.h>
+
+// Изменение размера изображения разделимыми фильтрами: таблицы весов для
+// столбцов и строк приемника считаются один раз, затем выполняются
+// горизонтальный и вертикальный проходы (в более дешевом порядке). При
+// уменьшении ядро растягивается на масштаб, поэтому каждый пиксель источника
+// учитывается (без наложения частот).
+
+typedef enum {
+    RESAMPLE_NEAREST,     // ближайший сосед
+    RESAMPLE_BILINEAR,    // треугольное ядро, радиус 1
+    RESAMPLE_BICUBIC,     // кубическое ядро Кейса (a = -0.5), радиус 2
+    RESAMPLE_LANCZOS3     // sinc(x) * sinc(x / 3), радиус 3
+} ResampleMethod;
+
+// Разбор имени способа: nearest, bilinear, bicubic или lanczos3
+bool resample_method_parse(const char* name, ResampleMethod* method);
+const char* resample_method_name(ResampleMethod method);
+
+// При уменьшении больше чем в RESAMPLE_BOX_GAP раз источник сначала
+// усредняется блоками целого размера так, чтобы оставшийся масштаб был не
+// меньше RESAMPLE_BOX_GAP: стоимость почти не зависит от степени уменьшения,
+// отличие от точного результата - bench/bench.c resize
+#define RESAMPLE_BOX_GAP 3.0
+
+// Новое изображение new_width x new_height (NULL при ошибке)
+Image* resample_image(const Image* src, int new_width, int new_height, ResampleMethod method);
+
+// То же с заданным порогом усреднения блоками (0 - без усреднения)
+Image* resample_image_gap(const Image* src, int new_width, int new_height, ResampleMethod method,
+                          double box_gap);
+
+// Пересчет src в приемник dst размера dst->width x dst->height без выделения
+// кадра (буфер dst может быть больше, например от предыдущего уровня пирамиды)
+bool resample_image_into(const Image* src, Image* dst, ResampleMethod method);
+
+// Замена пикселей изображения результатом resample_image
+bool image_resample(Image* image, int new_width, int new_height, ResampleMethod method);
+
+// То же для PixelImage в формате источника: целочисленные форматы усредняются
+// блоками без преобразования всего источника в Color (миниатюры больших снимков)
+PixelImage* resample_pixels(const PixelImage* src, int new_width, int new_height, ResampleMethod method);
+
+#endif // RESAMPLE_H
@@ -0,0 +1,911 @@
+#include "simd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+static float clamp_unit(float value) {
+    if (value < 0.0f) return 0.0f;
+    if (value > 1.0f) return 1.0f;
+    return value;
+}
+
+// ---------------------------------------------------------------------------
+// Скалярные ядра (эталон и запасной вариант). Порядок операций совпадает с
+// исходными фильтрами, поэтому результат побитово одинаков.
+// ---------------------------------------------------------------------------
+
+static void scalar_grayscale(Color* pixels, int count) {
+    for (int i = 0; i < count; i++) {
+        float luminance = clamp_unit(color_luminance(pixels[i]));
+        pixels[i].r = luminance;
+        pixels[i].g = luminance;
+        pixels[i].b = luminance;
+    }
+}
+
+static void scalar_negative(Color* pixels, int count) {
+    for (int i = 0; i < count; i++) {
+        pixels[i].r = clamp_unit(1.0f - pixels[i].r);
+        pixels[i].g = clamp_unit(1.0f - pixels[i].g);
+        pixels[i].b = clamp_unit(1.0f - pixels[i].b);
+    }
+}
+
+static void scalar_color_matrix(Color* pixels, int count, const float m[3][4]) {
+    for (int i = 0; i < count; i++) {
+        Color c = pixels[i];
+        pixels[i].r = clamp_unit(c.r * m[0][0] + c.g * m[0][1] + c.b * m[0][2] + m[0][3]);
+        pixels[i].g = clamp_unit(c.r * m[1][0] + c.g * m[1][1] + c.b * m[1][2] + m[1][3]);
+        pixels[i].b = clamp_unit(c.r * m[2][0] + c.g * m[2][1] + c.b * m[2][2] + m[2][3]);
+    }
+}
+
+static float vignette_factor(float dx, const VignetteRow* row) {
+    float distance = sqrtf(dx * dx + row->dy * row->dy);
+    float factor = 1.0f - (distance / row->max_distance) * row->intensity;
+    return factor < 0.0f ? 0.0f : factor;
+}
+
+static void scalar_vignette_from(Color* pixels, int start, int count, const VignetteRow* row) {
+    for (int x = start; x < count; x++) {
+        float factor = vignette_factor(x - row->center_x, row);
+        pixels[x].r = clamp_unit(pixels[x].r * factor);
+        pixels[x].g = clamp_unit(pixels[x].g * factor);
+        pixels[x].b = clamp_unit(pixels[x].b * factor);
+    }
+}
+
+static void scalar_vignette(Color* pixels, int count, const VignetteRow* row) {
+    scalar_vignette_from(pixels, 0, count, row);
+}
+
+// Ширина полосы скалярной свертки (float): накопитель остается в L1
+#define CONVOLVE_STRIP 64
+
+// clamp - ограничить результат [0, 1] (без него - для промежуточных проходов)
+static void scalar_weighted_rows(const float* const* rows, const float* weights, int taps,
+                                 float* out, int start, int end, bool clamp) {
+    float sums[CONVOLVE_STRIP];
+
+    for (int x0 = start; x0 < end; x0 += CONVOLVE_STRIP) {
+        int n = end - x0 < CONVOLVE_STRIP ? end - x0 : CONVOLVE_STRIP;
+        for (int i = 0; i < n; i++) {
+            sums[i] = 0.0f;
+        }
+        for (int k = 0; k < taps; k++) {
+            const float* row = rows[k] + x0;
+            float weight = weights[k];
+            for (int i = 0; i < n; i++) {
+                sums[i] += row[i] * weight;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            out[x0 + i] = clamp ? clamp_unit(sums[i]) : sums[i];
+        }
+    }
+}
+
+static void scalar_convolve_rows(const float* const* rows, const float* weights, int taps,
+                                 float* out, int start, int end) {
+    scalar_weighted_rows(rows, weights, taps, out, start, end, true);
+}
+
+static void scalar_accumulate_rows(const float* const* rows, const float* weights, int taps,
+                                   float* out, int start, int end) {
+    scalar_weighted_rows(rows, weights, taps, out, start, end, false);
+}
+
+static void scalar_butterfly_rows(float* a, float* b, float wr, float wi, int count) {
+    for (int i = 0; i < 2 * count; i += 2) {
+        float re = b[i] * wr - b[i + 1] * wi;
+        float im = b[i + 1] * wr + b[i] * wi;
+        b[i] = a[i] - re;
+        b[i + 1] = a[i + 1] - im;
+        a[i] += re;
+        a[i + 1] += im;
+    }
+}
+
+static void scalar_resample_row(const Color* src, Color* dst, int count, const int* first,
+                                const float* weights, int taps, bool clamp) {
+    for (int i = 0; i < count; i++) {
+        const Color* p = src + first[i];
+        const float* w = weights + (size_t)i * taps;
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            r += p[k].r * w[k];
+            g += p[k].g * w[k];
+            b += p[k].b * w[k];
+        }
+        dst[i].r = clamp ? clamp_unit(r) : r;
+        dst[i].g = clamp ? clamp_unit(g) : g;
+        dst[i].b = clamp ? clamp_unit(b) : b;
+    }
+}
+
+static void scalar_sum_rows_u8(const uint8_t* const* rows, int taps, uint32_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += rows[k][i];
+        }
+        out[i] = sum;
+    }
+}
+
+static void scalar_sum_rows_u16(const uint16_t* const* rows, int taps, uint32_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += rows[k][i];
+        }
+        out[i] = sum;
+    }
+}
+
+// BGR8 -> Color: деление на 255 как в исходном bmp_read
+static void scalar_bgr8_to_color(const uint8_t* bgr, Color* pixels, int count) {
+    for (int i = 0; i < count; i++) {
+        pixels[i].r = bgr[3 * i + 2] / 255.0f;
+        pixels[i].g = bgr[3 * i + 1] / 255.0f;
+        pixels[i].b = bgr[3 * i] / 255.0f;
+    }
+}
+
+// Color -> BGR8: ограничение [0, 1] и усечение после умножения на 255
+static uint8_t quantize_unit(float value) {
+    if (!(value > 0.0f)) return 0;
+    if (value > 1.0f) value = 1.0f;
+    return (uint8_t)(value * 255);
+}
+
+static void scalar_color_to_bgr8(const Color* pixels, uint8_t* bgr, int count) {
+    for (int i = 0; i < count; i++) {
+        bgr[3 * i] = quantize_unit(pixels[i].b);
+        bgr[3 * i + 1] = quantize_unit(pixels[i].g);
+        bgr[3 * i + 2] = quantize_unit(pixels[i].r);
+    }
+}
+
+// BGRX8 (32-битный BMP) -> Color, четвертый байт не используется
+static void scalar_bgrx8_to_color(const uint8_t* bgrx, Color* pixels, int count) {
+    for (int i = 0; i < count; i++) {
+        pixels[i].r = bgrx[4 * i + 2] / 255.0f;
+        pixels[i].g = bgrx[4 * i + 1] / 255.0f;
+        pixels[i].b = bgrx[4 * i] / 255.0f;
+    }
+}
+
+static void scalar_color_to_bgrx8(const Color* pixels, uint8_t* bgrx, int count) {
+    for (int i = 0; i < count; i++) {
+        bgrx[4 * i] = quantize_unit(pixels[i].b);
+        bgrx[4 * i + 1] = quantize_unit(pixels[i].g);
+        bgrx[4 * i + 2] = quantize_unit(pixels[i].r);
+        bgrx[4 * i + 3] = 255;
+    }
+}
+
+static const SimdKernels scalar_kernels = {
+    SIMD_LEVEL_SCALAR,
+    scalar_grayscale,
+    scalar_negative,
+    scalar_color_matrix,
+    scalar_vignette,
+    scalar_convolve_rows,
+    scalar_accumulate_rows,
+    scalar_butterfly_rows,
+    scalar_resample_row,
+    scalar_sum_rows_u8,
+    scalar_sum_rows_u16,
+    scalar_bgr8_to_color,
+    scalar_color_to_bgr8,
+    scalar_bgrx8_to_color,
+    scalar_color_to_bgrx8
+};
+
+#ifdef SIMD_X86
+
+// ---------------------------------------------------------------------------
+// SSE2: четыре пикселя (12 float) за итерацию. Массив Color {r,g,b}
+// разбирается на векторы R, G, B перестановками и собирается обратно.
+// ---------------------------------------------------------------------------
+
+#define SSE_ATTR __attribute__((target("sse2")))
+
+static inline SSE_ATTR void sse_deinterleave_regs(__m128 v0, __m128 v1, __m128 v2,
+                                                  __m128* r, __m128* g, __m128* b) {
+    // v0 = r0 g0 b0 r1, v1 = g1 b1 r2 g2, v2 = b2 r3 g3 b3
+    __m128 t = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2));
+    *r = _mm_shuffle_ps(v0, t, _MM_SHUFFLE(2, 0, 3, 0));
+
+    __m128 g01 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1));
+    __m128 g23 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3));
+    *g = _mm_shuffle_ps(g01, g23, _MM_SHUFFLE(2, 0, 2, 0));
+
+    __m128 b01 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));
+    __m128 b23 = _mm_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 0, 0));
+    *b = _mm_shuffle_ps(b01, b23, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline SSE_ATTR void sse_deinterleave(const float* p, __m128* r, __m128* g, __m128* b) {
+    sse_deinterleave_regs(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), r, g, b);
+}
+
+static inline SSE_ATTR void sse_interleave_regs(__m128 r, __m128 g, __m128 b,
+                                                __m128* v0, __m128* v1, __m128* v2) {
+    __m128 rg0 = _mm_shuffle_ps(r, g, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 br0 = _mm_shuffle_ps(b, r, _MM_SHUFFLE(1, 1, 0, 0));
+    *v0 = _mm_shuffle_ps(rg0, br0, _MM_SHUFFLE(2, 0, 2, 0));
+
+    __m128 gb1 = _mm_shuffle_ps(g, b, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 rg2 = _mm_shuffle_ps(r, g, _MM_SHUFFLE(2, 2, 2, 2));
+    *v1 = _mm_shuffle_ps(gb1, rg2, _MM_SHUFFLE(2, 0, 2, 0));
+
+    __m128 br3 = _mm_shuffle_ps(b, r, _MM_SHUFFLE(3, 3, 2, 2));
+    __m128 gb3 = _mm_shuffle_ps(g, b, _MM_SHUFFLE(3, 3, 3, 3));
+    *v2 = _mm_shuffle_ps(br3, gb3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline SSE_ATTR void sse_interleave(float* p, __m128 r, __m128 g, __m128 b) {
+    __m128 v0, v1, v2;
+    sse_interleave_regs(r, g, b, &v0, &v1, &v2);
+    _mm_storeu_ps(p, v0);
+    _mm_storeu_ps(p + 4, v1);
+    _mm_storeu_ps(p + 8, v2);
+}
+
+static inline SSE_ATTR __m128 sse_clamp(__m128 v) {
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+static SSE_ATTR void sse_grayscale(Color* pixels, int count) {
+    const __m128 kr = _mm_set1_ps(0.299f);
+    const __m128 kg = _mm_set1_ps(0.587f);
+    const __m128 kb = _mm_set1_ps(0.114f);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 r, g, b;
+        sse_deinterleave((float*)(pixels + i), &r, &g, &b);
+        __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(kr, r), _mm_mul_ps(kg, g)), _mm_mul_ps(kb, b));
+        y = sse_clamp(y);
+        sse_interleave((float*)(pixels + i), y, y, y);
+    }
+
+    scalar_grayscale(pixels + i, count - i);
+}
+
+static SSE_ATTR void sse_negative(Color* pixels, int count) {
+    // Канал не важен, поэтому массив обрабатывается как поток float
+    float* values = (float*)pixels;
+    int total = count * 3;
+    const __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
+
+    for (; i + 4 <= total; i += 4) {
+        __m128 v = _mm_loadu_ps(values + i);
+        _mm_storeu_ps(values + i, sse_clamp(_mm_sub_ps(one, v)));
+    }
+
+    for (; i < total; i++) {
+        values[i] = clamp_unit(1.0f - values[i]);
+    }
+}
+
+static SSE_ATTR void sse_color_matrix(Color* pixels, int count, const float m[3][4]) {
+    __m128 k[3][4];
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+            k[row][col] = _mm_set1_ps(m[row][col]);
+        }
+    }
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 r, g, b, out[3];
+        sse_deinterleave((float*)(pixels + i), &r, &g, &b);
+        for (int row = 0; row < 3; row++) {
+            __m128 v = _mm_add_ps(_mm_mul_ps(r, k[row][0]), _mm_mul_ps(g, k[row][1]));
+            v = _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(b, k[row][2])), k[row][3]);
+            out[row] = sse_clamp(v);
+        }
+        sse_interleave((float*)(pixels + i), out[0], out[1], out[2]);
+    }
+
+    scalar_color_matrix(pixels + i, count - i, m);
+}
+
+static SSE_ATTR void sse_vignette(Color* pixels, int count, const VignetteRow* row) {
+    const __m128 center_x = _mm_set1_ps(row->center_x);
+    const __m128 dy2 = _mm_set1_ps(row->dy * row->dy);
+    const __m128 max_distance = _mm_set1_ps(row->max_distance);
+    const __m128 intensity = _mm_set1_ps(row->intensity);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 xs = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    int x = 0;
+
+    for (; x + 4 <= count; x += 4) {
+        __m128 dx = _mm_sub_ps(xs, center_x);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2));
+        __m128 factor = _mm_sub_ps(one, _mm_mul_ps(_mm_div_ps(distance, max_distance), intensity));
+        factor = _mm_max_ps(factor, _mm_setzero_ps());
+
+        __m128 r, g, b;
+        sse_deinterleave((float*)(pixels + x), &r, &g, &b);
+        sse_interleave((float*)(pixels + x),
+                       sse_clamp(_mm_mul_ps(r, factor)),
+                       sse_clamp(_mm_mul_ps(g, factor)),
+                       sse_clamp(_mm_mul_ps(b, factor)));
+
+        xs = _mm_add_ps(xs, _mm_set1_ps(4.0f));
+    }
+
+    scalar_vignette_from(pixels, x, count, row);
+}
+
+// Четыре пикселя BGR8 (12 байт) расширяются до 12 float в порядке файла;
+// перестановка каналов B<->R делается теми же перестановками, что и разбор Color.
+static SSE_ATTR void sse_bgr8_to_color(const uint8_t* bgr, Color* pixels, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        const uint8_t* p = bgr + 3 * i;
+        int32_t tail;
+        memcpy(&tail, p + 8, sizeof(tail));
+        __m128i bytes = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)p), _mm_cvtsi32_si128(tail));
+
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        __m128 v0 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale);
+        __m128 v1 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale);
+        __m128 v2 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale);
+
+        __m128 b, g, r;
+        sse_deinterleave_regs(v0, v1, v2, &b, &g, &r);
+        sse_interleave((float*)(pixels + i), r, g, b);
+    }
+
+    scalar_bgr8_to_color(bgr + 3 * i, pixels + i, count - i);
+}
+
+// Полоса из 16 float (четыре регистра) на все строки окна, затем по 4 float.
+// Умножение и сложение раздельны (без FMA), суммы совпадают со скалярными.
+static inline SSE_ATTR __m128 sse_clamp_if(__m128 v, bool clamp) {
+    return clamp ? sse_clamp(v) : v;
+}
+
+static SSE_ATTR void sse_weighted_rows(const float* const* rows, const float* weights, int taps,
+                                       float* out, int start, int end, bool clamp) {
+    int x = start;
+
+    for (; x + 16 <= end; x += 16) {
+        __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+        __m128 s2 = _mm_setzero_ps(), s3 = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            const float* row = rows[k] + x;
+            __m128 weight = _mm_set1_ps(weights[k]);
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(row), weight));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(row + 4), weight));
+            s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(row + 8), weight));
+            s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(row + 12), weight));
+        }
+        _mm_storeu_ps(out + x, sse_clamp_if(s0, clamp));
+        _mm_storeu_ps(out + x + 4, sse_clamp_if(s1, clamp));
+        _mm_storeu_ps(out + x + 8, sse_clamp_if(s2, clamp));
+        _mm_storeu_ps(out + x + 12, sse_clamp_if(s3, clamp));
+    }
+
+    for (; x + 4 <= end; x += 4) {
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + x), _mm_set1_ps(weights[k])));
+        }
+        _mm_storeu_ps(out + x, sse_clamp_if(sum, clamp));
+    }
+
+    scalar_weighted_rows(rows, weights, taps, out, x, end, clamp);
+}
+
+static SSE_ATTR void sse_convolve_rows(const float* const* rows, const float* weights, int taps,
+                                       float* out, int start, int end) {
+    sse_weighted_rows(rows, weights, taps, out, start, end, true);
+}
+
+static SSE_ATTR void sse_accumulate_rows(const float* const* rows, const float* weights, int taps,
+                                         float* out, int start, int end) {
+    sse_weighted_rows(rows, weights, taps, out, start, end, false);
+}
+
+// Комплексное умножение на w: (re, im) * wr + (im, re) * (-wi, wi); b[i] * -wi
+// равно -(b[i] * wi), поэтому результат совпадает со скалярным
+static SSE_ATTR void sse_butterfly_rows(float* a, float* b, float wr, float wi, int count) {
+    const __m128 real = _mm_set1_ps(wr);
+    const __m128 imag = _mm_setr_ps(-wi, wi, -wi, wi);
+    int i = 0;
+
+    for (; i + 4 <= 2 * count; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + i);
+        __m128 swapped = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 t = _mm_add_ps(_mm_mul_ps(vb, real), _mm_mul_ps(swapped, imag));
+        __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(b + i, _mm_sub_ps(va, t));
+        _mm_storeu_ps(a + i, _mm_add_ps(va, t));
+    }
+
+    scalar_butterfly_rows(a + i, b + i, wr, wi, count - i / 2);
+}
+
+// Пиксель приемника в одном регистре (r, g, b, 0): три float читаются двумя
+// загрузками, чтобы не выйти за конец буфера
+static SSE_ATTR void sse_resample_row(const Color* src, Color* dst, int count, const int* first,
+                                      const float* weights, int taps, bool clamp) {
+    for (int i = 0; i < count; i++) {
+        const float* p = (const float*)(src + first[i]);
+        const float* w = weights + (size_t)i * taps;
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++, p += 3) {
+            __m128 rg = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p));
+            __m128 pixel = _mm_movelh_ps(rg, _mm_load_ss(p + 2));
+            sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(w[k])));
+        }
+        sum = sse_clamp_if(sum, clamp);
+
+        float* out = (float*)(dst + i);
+        _mm_storel_epi64((__m128i*)out, _mm_castps_si128(sum));
+        _mm_store_ss(out + 2, _mm_movehl_ps(sum, sum));
+    }
+}
+
+// Суммы 8-битных значений копятся в 16-битных полосах регистров (до 257
+// строк без переполнения), затем расширяются до 32 бит распаковкой с нулем
+#define SUM_ROWS_U16_MAX 257
+
+static SSE_ATTR void sse_sum_rows_u8(const uint8_t* const* rows, int taps, uint32_t* out, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i s0 = zero, s1 = zero, s2 = zero, s3 = zero;
+        for (int k0 = 0; k0 < taps; k0 += SUM_ROWS_U16_MAX) {
+            int k1 = k0 + SUM_ROWS_U16_MAX < taps ? k0 + SUM_ROWS_U16_MAX : taps;
+            __m128i low = zero, high = zero;
+            for (int k = k0; k < k1; k++) {
+                __m128i bytes = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+                low = _mm_add_epi16(low, _mm_unpacklo_epi8(bytes, zero));
+                high = _mm_add_epi16(high, _mm_unpackhi_epi8(bytes, zero));
+            }
+            s0 = _mm_add_epi32(s0, _mm_unpacklo_epi16(low, zero));
+            s1 = _mm_add_epi32(s1, _mm_unpackhi_epi16(low, zero));
+            s2 = _mm_add_epi32(s2, _mm_unpacklo_epi16(high, zero));
+            s3 = _mm_add_epi32(s3, _mm_unpackhi_epi16(high, zero));
+        }
+        __m128i* p = (__m128i*)(out + i);
+        _mm_storeu_si128(p, s0);
+        _mm_storeu_si128(p + 1, s1);
+        _mm_storeu_si128(p + 2, s2);
+        _mm_storeu_si128(p + 3, s3);
+    }
+
+    for (; i < count; i++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += rows[k][i];
+        }
+        out[i] = sum;
+    }
+}
+
+static SSE_ATTR void sse_sum_rows_u16(const uint16_t* const* rows, int taps, uint32_t* out, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i s0 = zero, s1 = zero;
+        for (int k = 0; k < taps; k++) {
+            __m128i values = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+            s0 = _mm_add_epi32(s0, _mm_unpacklo_epi16(values, zero));
+            s1 = _mm_add_epi32(s1, _mm_unpackhi_epi16(values, zero));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), s0);
+        _mm_storeu_si128((__m128i*)(out + i + 4), s1);
+    }
+
+    for (; i < count; i++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += rows[k][i];
+        }
+        out[i] = sum;
+    }
+}
+
+static SSE_ATTR void sse_color_to_bgr8(const Color* pixels, uint8_t* bgr, int count) {
+    const __m128 scale = _mm_set1_ps(255.0f);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 r, g, b;
+        sse_deinterleave((const float*)(pixels + i), &r, &g, &b);
+
+        // max(NaN, 0) дает 0, как и скалярный вариант
+        __m128 v0, v1, v2;
+        sse_interleave_regs(sse_clamp(b), sse_clamp(g), sse_clamp(r), &v0, &v1, &v2);
+        __m128i i0 = _mm_cvttps_epi32(_mm_mul_ps(v0, scale));
+        __m128i i1 = _mm_cvttps_epi32(_mm_mul_ps(v1, scale));
+        __m128i i2 = _mm_cvttps_epi32(_mm_mul_ps(v2, scale));
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i2));
+
+        uint8_t* p = bgr + 3 * i;
+        int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+        _mm_storel_epi64((__m128i*)p, bytes);
+        memcpy(p + 8, &tail, sizeof(tail));
+    }
+
+    scalar_color_to_bgr8(pixels + i, bgr + 3 * i, count - i);
+}
+
+// Четыре пикселя BGRX8 - одна загрузка по 16 байт; после транспонирования
+// регистры пикселей становятся регистрами каналов B, G, R, X
+static SSE_ATTR void sse_bgrx8_to_color(const uint8_t* bgrx, Color* pixels, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(bgrx + 4 * i));
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        __m128 b = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale);
+        __m128 g = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale);
+        __m128 r = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale);
+        __m128 x = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale);
+
+        _MM_TRANSPOSE4_PS(b, g, r, x);
+        sse_interleave((float*)(pixels + i), r, g, b);
+    }
+
+    scalar_bgrx8_to_color(bgrx + 4 * i, pixels + i, count - i);
+}
+
+static SSE_ATTR void sse_color_to_bgrx8(const Color* pixels, uint8_t* bgrx, int count) {
+    const __m128 scale = _mm_set1_ps(255.0f);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 r, g, b;
+        sse_deinterleave((const float*)(pixels + i), &r, &g, &b);
+
+        __m128 p0 = _mm_mul_ps(sse_clamp(b), scale);
+        __m128 p1 = _mm_mul_ps(sse_clamp(g), scale);
+        __m128 p2 = _mm_mul_ps(sse_clamp(r), scale);
+        __m128 p3 = scale;
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(_mm_cvttps_epi32(p0), _mm_cvttps_epi32(p1)),
+                                         _mm_packs_epi32(_mm_cvttps_epi32(p2), _mm_cvttps_epi32(p3)));
+        _mm_storeu_si128((__m128i*)(bgrx + 4 * i), bytes);
+    }
+
+    scalar_color_to_bgrx8(pixels + i, bgrx + 4 * i, count - i);
+}
+
+static const SimdKernels sse2_kernels = {
+    SIMD_LEVEL_SSE2,
+    sse_grayscale,
+    sse_negative,
+    sse_color_matrix,
+    sse_vignette,
+    sse_convolve_rows,
+    sse_accumulate_rows,
+    sse_butterfly_rows,
+    sse_resample_row,
+    sse_sum_rows_u8,
+    sse_sum_rows_u16,
+    sse_bgr8_to_color,
+    sse_color_to_bgr8,
+    sse_bgrx8_to_color,
+    sse_color_to_bgrx8
+};
+
+// ---------------------------------------------------------------------------
+// AVX2: восемь пикселей за итерацию. Каждая 128-битная половина регистра
+// содержит четыре пикселя, поэтому перестановки те же, что и в SSE2.
+// ---------------------------------------------------------------------------
+
+#define AVX_ATTR __attribute__((target("avx2")))
+
+static inline AVX_ATTR __m256 avx_load_halves(const float* low, const float* high) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+static inline AVX_ATTR void avx_store_halves(float* low, float* high, __m256 v) {
+    _mm_storeu_ps(low, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(high, _mm256_extractf128_ps(v, 1));
+}
+
+static inline AVX_ATTR void avx_deinterleave(const float* p, __m256* r, __m256* g, __m256* b) {
+    __m256 v0 = avx_load_halves(p, p + 12);
+    __m256 v1 = avx_load_halves(p + 4, p + 16);
+    __m256 v2 = avx_load_halves(p + 8, p + 20);
+
+    __m256 t = _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2));
+    *r = _mm256_shuffle_ps(v0, t, _MM_SHUFFLE(2, 0, 3, 0));
+
+    __m256 g01 = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1));
+    __m256 g23 = _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3));
+    *g = _mm256_shuffle_ps(g01, g23, _MM_SHUFFLE(2, 0, 2, 0));
+
+    __m256 b01 = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));
+    __m256 b23 = _mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 0, 0));
+    *b = _mm256_shuffle_ps(b01, b23, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline AVX_ATTR void avx_interleave(float* p, __m256 r, __m256 g, __m256 b) {
+    __m256 rg0 = _mm256_shuffle_ps(r, g, _MM_SHUFFLE(0, 0, 0, 0));
+    __m256 br0 = _mm256_shuffle_ps(b, r, _MM_SHUFFLE(1, 1, 0, 0));
+    avx_store_halves(p, p + 12, _mm256_shuffle_ps(rg0, br0, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    __m256 gb1 = _mm256_shuffle_ps(g, b, _MM_SHUFFLE(1, 1, 1, 1));
+    __m256 rg2 = _mm256_shuffle_ps(r, g, _MM_SHUFFLE(2, 2, 2, 2));
+    avx_store_halves(p + 4, p + 16, _mm256_shuffle_ps(gb1, rg2, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    __m256 br3 = _mm256_shuffle_ps(b, r, _MM_SHUFFLE(3, 3, 2, 2));
+    __m256 gb3 = _mm256_shuffle_ps(g, b, _MM_SHUFFLE(3, 3, 3, 3));
+    avx_store_halves(p + 8, p + 20, _mm256_shuffle_ps(br3, gb3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static inline AVX_ATTR __m256 avx_clamp(__m256 v) {
+    return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+static AVX_ATTR void avx_grayscale(Color* pixels, int count) {
+    const __m256 kr = _mm256_set1_ps(0.299f);
+    const __m256 kg = _mm256_set1_ps(0.587f);
+    const __m256 kb = _mm256_set1_ps(0.114f);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 r, g, b;
+        avx_deinterleave((float*)(pixels + i), &r, &g, &b);
+        __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(kr, r), _mm256_mul_ps(kg, g)),
+                                 _mm256_mul_ps(kb, b));
+        y = avx_clamp(y);
+        avx_interleave((float*)(pixels + i), y, y, y);
+    }
+
+    sse_grayscale(pixels + i, count - i);
+}
+
+static AVX_ATTR void avx_negative(Color* pixels, int count) {
+    float* values = (float*)pixels;
+    int total = count * 3;
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+
+    for (; i + 8 <= total; i += 8) {
+        __m256 v = _mm256_loadu_ps(values + i);
+        _mm256_storeu_ps(values + i, avx_clamp(_mm256_sub_ps(one, v)));
+    }
+
+    for (; i < total; i++) {
+        values[i] = clamp_unit(1.0f - values[i]);
+    }
+}
+
+static AVX_ATTR void avx_color_matrix(Color* pixels, int count, const float m[3][4]) {
+    __m256 k[3][4];
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+            k[row][col] = _mm256_set1_ps(m[row][col]);
+        }
+    }
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 r, g, b, out[3];
+        avx_deinterleave((float*)(pixels + i), &r, &g, &b);
+        for (int row = 0; row < 3; row++) {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(r, k[row][0]), _mm256_mul_ps(g, k[row][1]));
+            v = _mm256_add_ps(_mm256_add_ps(v, _mm256_mul_ps(b, k[row][2])), k[row][3]);
+            out[row] = avx_clamp(v);
+        }
+        avx_interleave((float*)(pixels + i), out[0], out[1], out[2]);
+    }
+
+    // Хвост в SSE-кодировке: без сброса верхних половин регистров процессор
+    // платит за переход между AVX и SSE (компилятор не ставит vzeroupper
+    // перед хвостовым вызовом)
+    _mm256_zeroupper();
+    sse_color_matrix(pixels + i, count - i, m);
+}
+
+static AVX_ATTR void avx_vignette(Color* pixels, int count, const VignetteRow* row) {
+    const __m256 center_x = _mm256_set1_ps(row->center_x);
+    const __m256 dy2 = _mm256_set1_ps(row->dy * row->dy);
+    const __m256 max_distance = _mm256_set1_ps(row->max_distance);
+    const __m256 intensity = _mm256_set1_ps(row->intensity);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 xs = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    int x = 0;
+
+    for (; x + 8 <= count; x += 8) {
+        __m256 dx = _mm256_sub_ps(xs, center_x);
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), dy2));
+        __m256 factor = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_div_ps(distance, max_distance), intensity));
+        factor = _mm256_max_ps(factor, _mm256_setzero_ps());
+
+        __m256 r, g, b;
+        avx_deinterleave((float*)(pixels + x), &r, &g, &b);
+        avx_interleave((float*)(pixels + x),
+                       avx_clamp(_mm256_mul_ps(r, factor)),
+                       avx_clamp(_mm256_mul_ps(g, factor)),
+                       avx_clamp(_mm256_mul_ps(b, factor)));
+
+        xs = _mm256_add_ps(xs, _mm256_set1_ps(8.0f));
+    }
+
+    scalar_vignette_from(pixels, x, count, row);
+}
+
+static inline AVX_ATTR __m256 avx_clamp_if(__m256 v, bool clamp) {
+    return clamp ? avx_clamp(v) : v;
+}
+
+static AVX_ATTR void avx_weighted_rows(const float* const* rows, const float* weights, int taps,
+                                       float* out, int start, int end, bool clamp) {
+    int x = start;
+
+    for (; x + 32 <= end; x += 32) {
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++) {
+            const float* row = rows[k] + x;
+            __m256 weight = _mm256_set1_ps(weights[k]);
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(row), weight));
+            s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(row + 8), weight));
+            s2 = _mm256_add_ps(s2, _mm256_mul_ps(_mm256_loadu_ps(row + 16), weight));
+            s3 = _mm256_add_ps(s3, _mm256_mul_ps(_mm256_loadu_ps(row + 24), weight));
+        }
+        _mm256_storeu_ps(out + x, avx_clamp_if(s0, clamp));
+        _mm256_storeu_ps(out + x + 8, avx_clamp_if(s1, clamp));
+        _mm256_storeu_ps(out + x + 16, avx_clamp_if(s2, clamp));
+        _mm256_storeu_ps(out + x + 24, avx_clamp_if(s3, clamp));
+    }
+
+    _mm256_zeroupper();
+    sse_weighted_rows(rows, weights, taps, out, x, end, clamp);
+}
+
+static AVX_ATTR void avx_convolve_rows(const float* const* rows, const float* weights, int taps,
+                                       float* out, int start, int end) {
+    avx_weighted_rows(rows, weights, taps, out, start, end, true);
+}
+
+static AVX_ATTR void avx_accumulate_rows(const float* const* rows, const float* weights, int taps,
+                                         float* out, int start, int end) {
+    avx_weighted_rows(rows, weights, taps, out, start, end, false);
+}
+
+static AVX_ATTR void avx_butterfly_rows(float* a, float* b, float wr, float wi, int count) {
+    const __m256 real = _mm256_set1_ps(wr);
+    const __m256 imag = _mm256_setr_ps(-wi, wi, -wi, wi, -wi, wi, -wi, wi);
+    int i = 0;
+
+    for (; i + 8 <= 2 * count; i += 8) {
+        __m256 vb = _mm256_loadu_ps(b + i);
+        __m256 swapped = _mm256_permute_ps(vb, _MM_SHUFFLE(2, 3, 0, 1));
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(vb, real), _mm256_mul_ps(swapped, imag));
+        __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(b + i, _mm256_sub_ps(va, t));
+        _mm256_storeu_ps(a + i, _mm256_add_ps(va, t));
+    }
+
+    _mm256_zeroupper();
+    sse_butterfly_rows(a + i, b + i, wr, wi, count - i / 2);
+}
+
+static const SimdKernels avx2_kernels = {
+    SIMD_LEVEL_AVX2,
+    avx_grayscale,
+    avx_negative,
+    avx_color_matrix,
+    avx_vignette,
+    avx_convolve_rows,
+    avx_accumulate_rows,
+    avx_butterfly_rows,
+    // Пиксель передискретизации занимает три float, ширина AVX2 не дает выигрыша
+    sse_resample_row,
+    // Суммы строк и преобразование BGR8 упираются в память, ширина AVX2 не дает выигрыша
+    sse_sum_rows_u8,
+    sse_sum_rows_u16,
+    sse_bgr8_to_color,
+    sse_color_to_bgr8,
+    sse_bgrx8_to_color,
+    sse_color_to_bgrx8
+};
+
+#endif // SIMD_X86
+
+const SimdKernels* simd_kernels_for(SimdLevel level) {
+    switch (level) {
+        case SIMD_LEVEL_SCALAR:
+            return &scalar_kernels;
+#ifdef SIMD_X86
+        case SIMD_LEVEL_SSE2:
+            return __builtin_cpu_supports("sse2") ? &sse2_kernels : NULL;
+        case SIMD_LEVEL_AVX2:
+            return __builtin_cpu_supports("avx2") ? &avx2_kernels : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+// Выбор уровня по процессору и IMAGE_CRAFT_SIMD (выполняется один раз)
+static const SimdKernels* simd_select(void) {
+    SimdLevel limit = SIMD_LEVEL_AVX2;
+
+    const char* override = getenv("IMAGE_CRAFT_SIMD");
+    if (override) {
+        if (strcmp(override, "scalar") == 0) limit = SIMD_LEVEL_SCALAR;
+        else if (strcmp(override, "sse2") == 0) limit = SIMD_LEVEL_SSE2;
+    }
+
+    for (int level = limit; level > SIMD_LEVEL_SCALAR; level--) {
+        const SimdKernels* kernels = simd_kernels_for((SimdLevel)level);
+        if (kernels) {
+            return kernels;
+        }
+    }
+    return &scalar_kernels;
+}
+
+// Таблица выбирается при первом вызове; ядра запрашиваются на каждую строку,
+// поэтому дальше читается только сохраненный указатель
+static const SimdKernels* simd_selected = NULL;
+
+#ifdef _WIN32
+static INIT_ONCE simd_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK simd_init(PINIT_ONCE once, PVOID param, PVOID* context) {
+    simd_selected = simd_select();
+    return TRUE;
+}
+
+const SimdKernels* simd_kernels(void) {
+    InitOnceExecuteOnce(&simd_once, simd_init, NULL, NULL);
+    return simd_selected;
+}
+#else
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+
+static void simd_init(void) {
+    simd_selected = simd_select();
+}
+
+const SimdKernels* simd_kernels(void) {
+    pthread_once(&simd_once, simd_init);
+    return simd_selected;
+}
+#endif
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SIMD_LEVEL_SSE2: return "sse2";
+        case SIMD_LEVEL_AVX2: return "avx2";
+        default:              return "scalar";
+    }
+}
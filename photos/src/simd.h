@@ -0,0 +1,68 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "image.h"
+#include <stdint.h>
+
+// Набор инструкций, выбранный для векторных ядер
+typedef enum {
+    SIMD_LEVEL_SCALAR = 0,
+    SIMD_LEVEL_SSE2,
+    SIMD_LEVEL_AVX2
+} SimdLevel;
+
+// Параметры виньетки для одной строки
+typedef struct {
+    float center_x;
+    float dy;            // смещение строки от центра кадра
+    float max_distance;
+    float intensity;
+} VignetteRow;
+
+// Ядра поточечных фильтров над массивом Color (результат ограничен [0, 1])
+typedef struct {
+    SimdLevel level;
+    void (*grayscale)(Color* pixels, int count);
+    void (*negative)(Color* pixels, int count);
+    // Аффинное преобразование цвета: out = M * (r, g, b, 1)
+    void (*color_matrix)(Color* pixels, int count, const float matrix[3][4]);
+    void (*vignette)(Color* pixels, int count, const VignetteRow* row);
+    // Вертикальная свертка: out[i] = sum(rows[k][i] * weights[k]) по k = 0..taps-1
+    // для float с индексами [start, end), результат ограничен [0, 1]. Сумма
+    // нескольких векторов по всем строкам копится в регистрах.
+    void (*convolve_rows)(const float* const* rows, const float* weights, int taps,
+                          float* out, int start, int end);
+    // То же без ограничения результата - для промежуточных проходов
+    void (*accumulate_rows)(const float* const* rows, const float* weights, int taps,
+                            float* out, int start, int end);
+    // Бабочка БПФ над парой строк из count комплексных чисел (re, im подряд):
+    // t = b * w, b = a - t, a = a + t
+    void (*butterfly_rows)(float* a, float* b, float wr, float wi, int count);
+    // Горизонтальная передискретизация строки: dst[i] = sum(src[first[i] + k] *
+    // weights[i * taps + k]) по k = 0..taps-1 для count пикселей приемника
+    // (clamp - ограничить результат [0, 1])
+    void (*resample_row)(const Color* src, Color* dst, int count, const int* first,
+                         const float* weights, int taps, bool clamp);
+    // Сумма строк целочисленных каналов: out[i] = sum(rows[k][i]) по k = 0..taps-1
+    // для i < count (16-битных строк - не больше 65537)
+    void (*sum_rows_u8)(const uint8_t* const* rows, int taps, uint32_t* out, int count);
+    void (*sum_rows_u16)(const uint16_t* const* rows, int taps, uint32_t* out, int count);
+    // Преобразование строк 24-битного BMP (порядок BGR) в Color и обратно
+    void (*bgr8_to_color)(const uint8_t* bgr, Color* pixels, int count);
+    void (*color_to_bgr8)(const Color* pixels, uint8_t* bgr, int count);
+    // То же для 32-битного BMP (BGRX); при записи четвертый байт равен 255
+    void (*bgrx8_to_color)(const uint8_t* bgrx, Color* pixels, int count);
+    void (*color_to_bgrx8)(const Color* pixels, uint8_t* bgrx, int count);
+} SimdKernels;
+
+// Ядра для лучшего набора инструкций процессора.
+// Переменная окружения IMAGE_CRAFT_SIMD=scalar|sse2|avx2 ограничивает выбор.
+// Таблица выбирается один раз при первом вызове (потокобезопасно).
+const SimdKernels* simd_kernels(void);
+
+// Ядра для заданного уровня (если процессор его поддерживает, иначе NULL)
+const SimdKernels* simd_kernels_for(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
+
+#endif // SIMD_H
@@ -0,0 +1,122 @@
+#include "stats.h"
+#include "buffer_pool.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+bool stats_format_parse(const char* name, StatsFormat* format) {
+    if (!name || !format) {
+        return false;
+    }
+
+    if (strcmp(name, "text") == 0) {
+        *format = STATS_FORMAT_TEXT;
+    } else if (strcmp(name, "json") == 0) {
+        *format = STATS_FORMAT_JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double stats_wall_time(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+double stats_cpu_time(void) {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    // Интервалы по 100 нс
+    unsigned long long ticks =
+        (((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+        (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime);
+    return ticks * 1e-7;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+void stage_timer_start(StageTimer* timer) {
+    timer->outer_peak = buffer_pool_peak_begin();
+    timer->cpu_start = stats_cpu_time();
+    timer->wall_start = stats_wall_time();
+}
+
+void stage_timer_stop(StageTimer* timer, StageStats* stats, long long pixels) {
+    double wall = stats_wall_time() - timer->wall_start;
+    double cpu = stats_cpu_time() - timer->cpu_start;
+    size_t peak = buffer_pool_peak_end(timer->outer_peak);
+
+    stats->wall_seconds += wall;
+    stats->cpu_seconds += cpu;
+    stats->pixels += pixels;
+    if (peak > stats->peak_bytes) {
+        stats->peak_bytes = peak;
+    }
+    stats->runs++;
+}
+
+double stage_stats_throughput(const StageStats* stats) {
+    return stats->wall_seconds > 0.0 ? stats->pixels / stats->wall_seconds * 1e-6 : 0.0;
+}
+
+void stage_stats_add(StageStats* total, const StageStats* stats) {
+    total->wall_seconds += stats->wall_seconds;
+    total->cpu_seconds += stats->cpu_seconds;
+    total->pixels += stats->pixels;
+    if (stats->peak_bytes > total->peak_bytes) {
+        total->peak_bytes = stats->peak_bytes;
+    }
+    total->runs += stats->runs;
+}
+
+void stage_stats_print_header(FILE* out) {
+    fprintf(out, "  %-28s %10s %10s %10s %10s\n", "stage", "wall ms", "cpu ms", "MP/s", "peak MB");
+}
+
+void stats_print_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* c = text ? text : ""; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+void stage_stats_print(FILE* out, StatsFormat format, const char* name, const StageStats* stats) {
+    if (format == STATS_FORMAT_JSON) {
+        fprintf(out, "{\"name\": ");
+        stats_print_json_string(out, name);
+        fprintf(out, ", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"pixels\": %lld, "
+                     "\"megapixels_per_second\": %.3f, \"peak_bytes\": %llu}",
+                stats->wall_seconds * 1e3, stats->cpu_seconds * 1e3, stats->pixels,
+                stage_stats_throughput(stats), (unsigned long long)stats->peak_bytes);
+    } else if (format == STATS_FORMAT_TEXT) {
+        fprintf(out, "  %-28s %10.2f %10.2f %10.1f %10.1f\n", name,
+                stats->wall_seconds * 1e3, stats->cpu_seconds * 1e3,
+                stage_stats_throughput(stats), stats->peak_bytes / 1048576.0);
+    }
+}
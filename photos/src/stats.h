@@ -0,0 +1,57 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Замеры времени, пропускной способности и памяти этапов обработки
+// (чтение, фильтры пайплайна, запись) для отчета --stats
+
+// Формат отчета
+typedef enum {
+    STATS_FORMAT_NONE = 0,
+    STATS_FORMAT_TEXT,
+    STATS_FORMAT_JSON
+} StatsFormat;
+
+// Разбор имени формата: text или json
+bool stats_format_parse(const char* name, StatsFormat* format);
+
+// Монотонное время и процессорное время процесса (всех потоков), в секундах
+double stats_wall_time(void);
+double stats_cpu_time(void);
+
+// Итоги этапа; повторные замеры одного этапа суммируются
+typedef struct {
+    double wall_seconds;
+    double cpu_seconds;
+    long long pixels;     // обработано пикселей
+    size_t peak_bytes;    // наибольший объем выданных буферов пикселей (buffer_pool)
+    int runs;             // число замеров
+} StageStats;
+
+// Замер в процессе
+typedef struct {
+    double wall_start;
+    double cpu_start;
+    size_t outer_peak;
+} StageTimer;
+
+void stage_timer_start(StageTimer* timer);
+void stage_timer_stop(StageTimer* timer, StageStats* stats, long long pixels);
+
+// Пропускная способность, Мп/с (0, если время не измерено)
+double stage_stats_throughput(const StageStats* stats);
+
+// Объединение итогов этапов (время и пиксели суммируются, пик - наибольший)
+void stage_stats_add(StageStats* total, const StageStats* stats);
+
+// Строка этапа: таблица для STATS_FORMAT_TEXT, объект для STATS_FORMAT_JSON
+void stage_stats_print_header(FILE* out);
+void stage_stats_print(FILE* out, StatsFormat format, const char* name, const StageStats* stats);
+
+// Строка JSON в кавычках с экранированием
+void stats_print_json_string(FILE* out, const char* text);
+
+#endif // STATS_H
@@ -0,0 +1,223 @@
+#include "threadpool.h"
+#include "log.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef CRITICAL_SECTION pool_mutex_t;
+typedef CONDITION_VARIABLE pool_cond_t;
+typedef HANDLE pool_thread_t;
+
+#define pool_mutex_init(m)      InitializeCriticalSection(m)
+#define pool_mutex_destroy(m)   DeleteCriticalSection(m)
+#define pool_mutex_lock(m)      EnterCriticalSection(m)
+#define pool_mutex_unlock(m)    LeaveCriticalSection(m)
+#define pool_cond_init(c)       InitializeConditionVariable(c)
+#define pool_cond_destroy(c)    ((void)(c))
+#define pool_cond_wait(c, m)    SleepConditionVariableCS(c, m, INFINITE)
+#define pool_cond_broadcast(c)  WakeAllConditionVariable(c)
+#define pool_cond_signal(c)     WakeConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t pool_mutex_t;
+typedef pthread_cond_t pool_cond_t;
+typedef pthread_t pool_thread_t;
+
+#define pool_mutex_init(m)      pthread_mutex_init(m, NULL)
+#define pool_mutex_destroy(m)   pthread_mutex_destroy(m)
+#define pool_mutex_lock(m)      pthread_mutex_lock(m)
+#define pool_mutex_unlock(m)    pthread_mutex_unlock(m)
+#define pool_cond_init(c)       pthread_cond_init(c, NULL)
+#define pool_cond_destroy(c)    pthread_cond_destroy(c)
+#define pool_cond_wait(c, m)    pthread_cond_wait(c, m)
+#define pool_cond_broadcast(c)  pthread_cond_broadcast(c)
+#define pool_cond_signal(c)     pthread_cond_signal(c)
+#endif
+
+struct ThreadPool {
+    pool_thread_t* threads;
+    int worker_count;
+
+    pool_mutex_t mutex;
+    pool_cond_t work_cond;   // появился новый пакет задач
+    pool_cond_t done_cond;   // все задачи пакета завершены
+
+    // Текущий пакет задач
+    ThreadTask task;
+    void* context;
+    int task_count;
+    int next_index;
+    int pending;
+    unsigned generation;
+    int shutdown;
+};
+
+// Забирает и выполняет задачи текущего пакета. Вызывается с захваченным мьютексом.
+static void threadpool_drain(ThreadPool* pool) {
+    while (pool->next_index < pool->task_count) {
+        int index = pool->next_index++;
+        ThreadTask task = pool->task;
+        void* context = pool->context;
+
+        pool_mutex_unlock(&pool->mutex);
+        task(context, index);
+        pool_mutex_lock(&pool->mutex);
+
+        if (--pool->pending == 0) {
+            pool_cond_signal(&pool->done_cond);
+        }
+    }
+}
+
+static void threadpool_worker(ThreadPool* pool) {
+    unsigned seen = 0;
+
+    pool_mutex_lock(&pool->mutex);
+    while (1) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pool_cond_wait(&pool->work_cond, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+
+        seen = pool->generation;
+        threadpool_drain(pool);
+    }
+    pool_mutex_unlock(&pool->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI threadpool_entry(LPVOID arg) {
+    threadpool_worker((ThreadPool*)arg);
+    return 0;
+}
+#else
+static void* threadpool_entry(void* arg) {
+    threadpool_worker((ThreadPool*)arg);
+    return NULL;
+}
+#endif
+
+ThreadPool* threadpool_create(int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = threadpool_cpu_count();
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        log_error("Memory allocation failed for thread pool\n");
+        return NULL;
+    }
+
+    // Вызывающий поток тоже выполняет задачи, поэтому рабочих на один меньше
+    int workers = thread_count - 1;
+    if (workers > 0) {
+        pool->threads = (pool_thread_t*)calloc(workers, sizeof(pool_thread_t));
+        if (!pool->threads) {
+            log_error("Memory allocation failed for thread pool\n");
+            free(pool);
+            return NULL;
+        }
+    }
+
+    pool_mutex_init(&pool->mutex);
+    pool_cond_init(&pool->work_cond);
+    pool_cond_init(&pool->done_cond);
+
+    for (int i = 0; i < workers; i++) {
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, threadpool_entry, pool, 0, NULL);
+        int failed = pool->threads[i] == NULL;
+#else
+        int failed = pthread_create(&pool->threads[i], NULL, threadpool_entry, pool) != 0;
+#endif
+        if (failed) {
+            log_warning("Started only %d of %d worker threads\n", i, workers);
+            break;
+        }
+        pool->worker_count++;
+    }
+
+    return pool;
+}
+
+void threadpool_destroy(ThreadPool* pool) {
+    if (!pool) {
+        return;
+    }
+
+    pool_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    pool_cond_broadcast(&pool->work_cond);
+    pool_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->worker_count; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    pool_cond_destroy(&pool->done_cond);
+    pool_cond_destroy(&pool->work_cond);
+    pool_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool);
+}
+
+void threadpool_run(ThreadPool* pool, ThreadTask task, void* context, int task_count) {
+    if (!task || task_count <= 0) {
+        return;
+    }
+
+    // Без пула (или без рабочих потоков) выполняем последовательно
+    if (!pool || pool->worker_count == 0 || task_count == 1) {
+        for (int i = 0; i < task_count; i++) {
+            task(context, i);
+        }
+        return;
+    }
+
+    pool_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->context = context;
+    pool->task_count = task_count;
+    pool->next_index = 0;
+    pool->pending = task_count;
+    pool->generation++;
+    pool_cond_broadcast(&pool->work_cond);
+
+    threadpool_drain(pool);
+
+    while (pool->pending > 0) {
+        pool_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->task_count = 0;
+    pool->next_index = 0;
+    pool_mutex_unlock(&pool->mutex);
+}
+
+int threadpool_get_size(const ThreadPool* pool) {
+    return pool ? pool->worker_count + 1 : 1;
+}
+
+int threadpool_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
@@ -0,0 +1,24 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Задача пула: обработка элемента с номером index
+typedef void (*ThreadTask)(void* context, int index);
+
+// Пул рабочих потоков (постоянные потоки, ожидающие очередной пакет задач)
+typedef struct ThreadPool ThreadPool;
+
+// Создание и уничтожение пула
+ThreadPool* threadpool_create(int thread_count);
+void threadpool_destroy(ThreadPool* pool);
+
+// Выполнение task(context, 0..task_count-1) на всех потоках пула.
+// Вызывающий поток участвует в работе и возвращается после завершения всех задач.
+void threadpool_run(ThreadPool* pool, ThreadTask task, void* context, int task_count);
+
+// Количество потоков (включая вызывающий)
+int threadpool_get_size(const ThreadPool* pool);
+
+// Количество доступных процессорных ядер
+int threadpool_cpu_count(void);
+
+#endif // THREADPOOL_H
@@ -0,0 +1,23 @@
+# Сравнение двух BMP: заголовки должны совпадать, а байты пикселей
+# отличаться не больше чем на tol (по умолчанию 0)
+# Использование: python compare.py a.bmp b.bmp [tol]
+import struct
+import sys
+
+if len(sys.argv) not in (3, 4):
+    print('Использование: python compare.py a.bmp b.bmp [tol]')
+    sys.exit(2)
+
+a = open(sys.argv[1], 'rb').read()
+b = open(sys.argv[2], 'rb').read()
+tol = int(sys.argv[3]) if len(sys.argv) == 4 else 0
+
+if len(a) != len(b) or len(a) < 54:
+    sys.exit(1)
+
+offset = struct.unpack_from('<I', a, 10)[0]
+if a[:offset] != b[:offset]:
+    sys.exit(1)
+
+diff = max((abs(x - y) for x, y in zip(a[offset:], b[offset:])), default=0)
+sys.exit(1 if diff > tol else 0)
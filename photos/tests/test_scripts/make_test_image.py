@@ -0,0 +1,44 @@
+# Создание тестового BMP 64x64 (градиент)
+# Использование: python make_test_image.py путь.bmp
+import struct
+import sys
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'test.bmp'
+
+width = 64
+height = 64
+row_padding = (4 - (width * 3) % 4) % 4
+row_size = width * 3 + row_padding
+image_size = row_size * height
+file_size = 54 + image_size
+
+with open(path, 'wb') as f:
+    # Заголовок файла
+    f.write(b'BM')
+    f.write(struct.pack('<I', file_size))
+    f.write(struct.pack('<I', 0))
+    f.write(struct.pack('<I', 54))
+
+    # Информационный заголовок
+    f.write(struct.pack('<I', 40))
+    f.write(struct.pack('<i', width))
+    f.write(struct.pack('<i', height))
+    f.write(struct.pack('<H', 1))
+    f.write(struct.pack('<H', 24))
+    f.write(struct.pack('<I', 0))
+    f.write(struct.pack('<I', image_size))
+    f.write(struct.pack('<i', 2835))
+    f.write(struct.pack('<i', 2835))
+    f.write(struct.pack('<I', 0))
+    f.write(struct.pack('<I', 0))
+
+    # Данные изображения (градиент)
+    for y in range(height):
+        for x in range(width):
+            r = int(x / width * 255)
+            g = int(y / height * 255)
+            b = int((x + y) / (width + height) * 255)
+            f.write(struct.pack('BBB', b, g, r))
+        f.write(b'\x00' * row_padding)
+
+print('Тестовое изображение создано')
@@ -17,47 +17,7 @@ if not exist "tests\test_images\test.bmp" (
     echo Создание тестового изображения...
 
     REM Создаем простой BMP через Python
-    python -c "
-import struct
-
-width = 64
-height = 64
-row_padding = (4 - (width * 3) % 4) % 4
-row_size = width * 3 + row_padding
-image_size = row_size * height
-file_size = 54 + image_size
-
-with open('tests\\test_images\\test.bmp', 'wb') as f:
-    # Заголовок файла
-    f.write(b'BM')
-    f.write(struct.pack('<I', file_size))
-    f.write(struct.pack('<I', 0))
-    f.write(struct.pack('<I', 54))
-
-    # Информационный заголовок
-    f.write(struct.pack('<I', 40))
-    f.write(struct.pack('<i', width))
-    f.write(struct.pack('<i', height))
-    f.write(struct.pack('<H', 1))
-    f.write(struct.pack('<H', 24))
-    f.write(struct.pack('<I', 0))
-    f.write(struct.pack('<I', image_size))
-    f.write(struct.pack('<i', 2835))
-    f.write(struct.pack('<i', 2835))
-    f.write(struct.pack('<I', 0))
-    f.write(struct.pack('<I', 0))
-
-    # Данные изображения (градиент)
-    for y in range(height):
-        for x in range(width):
-            r = int(x / width * 255)
-            g = int(y / height * 255)
-            b = int((x + y) / (width + height) * 255)
-            f.write(struct.pack('BBB', b, g, r))
-        f.write(b'\x00' * row_padding)
-
-print('Тестовое изображение создано')
-" 2>nul
+    python tests\test_scripts\make_test_image.py tests\test_images\test.bmp 2>nul
 )
 
 echo Запуск тестовых сценариев...
@@ -122,6 +82,162 @@ if %errorlevel% equ 0 (
     echo ❌ Ошибка
 )
 
+REM Тест 7: Многопоточная обработка должна совпадать с последовательной
+echo.
+echo [Тест 7] Многопоточная обработка (-threads)
+image_craft.exe tests\test_images\test.bmp tests\output_serial.bmp -blur 1.5 -med 3 -vignette -threads 1
+image_craft.exe tests\test_images\test.bmp tests\output_threads.bmp -blur 1.5 -med 3 -vignette -threads 4
+fc /b tests\output_serial.bmp tests\output_threads.bmp > nul
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 8: Векторные ядра должны совпадать со скалярными (не более 1 единицы после квантования)
+echo.
+echo [Тест 8] SIMD и скалярные поточечные фильтры
+set IMAGE_CRAFT_SIMD=scalar
+image_craft.exe tests\test_images\test.bmp tests\output_scalar.bmp -gs -neg -sepia -vignette 0.6 -threads 1
+set IMAGE_CRAFT_SIMD=
+image_craft.exe tests\test_images\test.bmp tests\output_simd.bmp -gs -neg -sepia -vignette 0.6 -threads 1
+python tests\test_scripts\compare.py tests\output_scalar.bmp tests\output_simd.bmp 1
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 9: Потоковая обработка должна совпадать с обработкой в памяти
+echo.
+echo [Тест 9] Потоковая обработка (-stream)
+image_craft.exe tests\test_images\test.bmp tests\output_stream.bmp -blur 1.5 -med 3 -vignette -stream
+fc /b tests\output_serial.bmp tests\output_stream.bmp > nul
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 10: Пакетная обработка каталога одним пайплайном
+echo.
+echo [Тест 10] Пакетная обработка (-batch)
+image_craft.exe -batch tests\test_images tests\batch_output -gs -blur 1.0 -threads 2
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 11: Размытие квадратным окном не зависит от числа потоков
+echo.
+echo [Тест 11] Размытие квадратным окном (-box)
+image_craft.exe tests\test_images\test.bmp tests\output_box_1.bmp -box 7 -threads 1
+image_craft.exe tests\test_images\test.bmp tests\output_box.bmp -box 7 -threads 4
+fc /b tests\output_box_1.bmp tests\output_box.bmp > nul
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 12: Тиснение и повышение резкости (свертки 3x3)
+echo.
+echo [Тест 12] Тиснение (-emboss)
+image_craft.exe tests\test_images\test.bmp tests\output_emboss.bmp -emboss -sharp
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 13: Свертка пользовательским ядром
+echo.
+echo [Тест 13] Свертка ядром 5x5 (-conv)
+image_craft.exe tests\test_images\test.bmp tests\output_conv.bmp -conv "1,4,6,4,1;4,16,24,16,4;6,24,36,24,6;4,16,24,16,4;1,4,6,4,1"
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 14: Большое ядро считается через БПФ и не зависит от числа потоков
+echo.
+echo [Тест 14] Свертка ядром 21x21 (-conv, БПФ)
+image_craft.exe tests\test_images\test.bmp tests\output_conv_fft_1.bmp -conv tests\test_kernels\disk21.txt -threads 1
+image_craft.exe tests\test_images\test.bmp tests\output_conv_fft.bmp -conv tests\test_kernels\disk21.txt -threads 4
+fc /b tests\output_conv_fft_1.bmp tests\output_conv_fft.bmp > nul
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 15: Отчет о замерах этапов в формате JSON
+echo.
+echo [Тест 15] Статистика этапов (--stats json)
+image_craft.exe tests\test_images\test.bmp tests\output_stats.bmp -blur 1.5 -gs -neg --stats json
+if %errorlevel% equ 0 (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 16: Тихий режим ничего не выводит в stdout
+echo.
+echo [Тест 16] Тихий режим (-q)
+image_craft.exe tests\test_images\test.bmp tests\output_quiet.bmp -blur 1.5 -gs -q > tests\quiet.txt
+if %errorlevel% neq 0 (
+    echo ❌ Ошибка
+) else (
+    for %%F in (tests\quiet.txt) do if %%~zF equ 0 (echo ✅ Успешно) else (echo ❌ Ошибка)
+)
+del tests\quiet.txt 2>nul
+
+REM Тест 17: Уменьшение ланцош-фильтром в форматах f32 и u8 дает одинаковый результат
+echo.
+echo [Тест 17] Изменение размера (-resize lanczos3)
+image_craft.exe tests\test_images\test.bmp tests\output_resize.bmp -resize 64 48 lanczos3
+image_craft.exe tests\test_images\test.bmp tests\output_resize_u8.bmp -format u8 -resize 64 48 lanczos3
+fc /b tests\output_resize.bmp tests\output_resize_u8.bmp > nul
+if %errorlevel% equ 0 (echo ✅ Успешно) else (echo ❌ Ошибка)
+
+REM Тест 18: Пирамида из 3 уровней за один запуск
+echo.
+echo [Тест 18] Пирамида уровней (-pyramid)
+image_craft.exe tests\test_images\test.bmp tests\output_pyramid.bmp -blur 0.8 -pyramid 3 tests\output_pyramid_%%d.bmp -sharp
+if %errorlevel% neq 0 (
+    echo ❌ Ошибка
+) else if exist tests\output_pyramid_3.bmp (
+    echo ✅ Успешно
+) else (
+    echo ❌ Ошибка
+)
+
+REM Тест 19: Обрезка со смещением (читается только нужная часть файла).
+REM -batch декодирует изображение целиком, результат должен совпасть побайтно
+echo.
+echo [Тест 19] Обрезка области (-crop 64 64 10 10)
+image_craft.exe tests\test_images\test.bmp tests\output_roi.bmp -blur 1 -crop 64 64 10 10 -sharp
+image_craft.exe -batch tests\test_images tests\batch_roi -blur 1 -crop 64 64 10 10 -sharp
+fc /b tests\output_roi.bmp tests\batch_roi\test.bmp > nul
+if %errorlevel% equ 0 (echo ✅ Успешно) else (echo ❌ Ошибка)
+
+REM Тест 20: 32-битный BMP читается обратно без потерь
+echo.
+echo [Тест 20] 32-битный вывод (-bpp 32)
+image_craft.exe tests\test_images\test.bmp tests\output_neg32.bmp -neg -bpp 32
+image_craft.exe tests\output_neg32.bmp tests\output_neg32_24.bmp
+image_craft.exe tests\test_images\test.bmp tests\output_neg24.bmp -neg
+fc /b tests\output_neg32_24.bmp tests\output_neg24.bmp > nul
+if %errorlevel% equ 0 (echo ✅ Успешно) else (echo ❌ Ошибка)
+
+REM Тест 21: Обзор заголовков каталога без чтения пикселей
+echo.
+echo [Тест 21] Обзор BMP (--info)
+image_craft.exe --info tests\test_images -threads 2
+if %errorlevel% equ 0 (echo ✅ Успешно) else (echo ❌ Ошибка)
+
 echo.
 echo ========================================
 echo Тестирование завершено!